@@ -0,0 +1,153 @@
+#include "AssetArchive.h"
+#include "Hash.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	bool isInFile(
+		const MappedFile& file, const uint64_t offset, const uint64_t size
+	);
+	bool isValidEntry(
+		const MappedFile& file,
+		const AssetEntry& entry,
+		const uint32_t stringTableSize
+	);
+}  // namespace
+
+bool AssetArchive::open(const std::filesystem::path& path) {
+	PYX_ENGINE_ASSERT_WARNING(!isOpen());
+
+	std::optional<MappedFile> file{ mapFile(path) };
+	if (!file.has_value()) {
+		return false;
+	}
+
+	AssetArchiveHeader header{};
+	if (file->size >= sizeof(header)) {
+		memcpy(&header, file->data, sizeof(header));
+	}
+	if (header.magic != c_ASSET_ARCHIVE_MAGIC ||
+		header.version != c_ASSET_ARCHIVE_VERSION ||
+		header.tocOffset % alignof(AssetEntry) != 0 ||
+		!isInFile(
+			file.value(),
+			header.tocOffset,
+			(uint64_t)header.entryCount * sizeof(AssetEntry)
+		) ||
+		!isInFile(
+			file.value(), header.stringTableOffset, header.stringTableSize
+		)) {
+		PYX_ENGINE_ERROR(
+			"[Assets] {0} is not a version {1} asset archive",
+			path.string(),
+			c_ASSET_ARCHIVE_VERSION
+		);
+		unmapFile(file.value());
+		return false;
+	}
+
+	std::span<const AssetEntry> entries{
+		(const AssetEntry*)(file->data + header.tocOffset), header.entryCount
+	};
+	for (const auto& entry : entries) {
+		if (!isValidEntry(file.value(), entry, header.stringTableSize)) {
+			PYX_ENGINE_ERROR("[Assets] {0} is corrupt", path.string());
+			unmapFile(file.value());
+			return false;
+		}
+	}
+
+	m_File = file.value();
+	m_Entries = entries;
+	m_Strings = (const char*)(file->data + header.stringTableOffset);
+
+	PYX_ENGINE_INFO(
+		"[Assets] mapped {0} with {1} assets", path.string(), entries.size()
+	);
+
+	return true;
+}
+
+void AssetArchive::close() {
+	unmapFile(m_File);
+	m_File = {};
+	m_Entries = {};
+	m_Strings = nullptr;
+}
+
+const AssetEntry* AssetArchive::find(const std::string_view name) const {
+	uint64_t hash{ hashBytes(name.data(), name.size()) };
+
+	auto entry{ std::ranges::lower_bound(
+		m_Entries, hash, {}, &AssetEntry::nameHash
+	) };
+	// the cooker rejects colliding names, the name check guards against
+	// looking up one that was never cooked
+	if (entry == m_Entries.end() || entry->nameHash != hash ||
+		getName(*entry) != name) {
+		return nullptr;
+	}
+
+	return &*entry;
+}
+
+std::string_view AssetArchive::getName(const AssetEntry& entry) const {
+	return std::string_view{ m_Strings + entry.nameOffset, entry.nameLength };
+}
+
+std::span<const uint8_t> AssetArchive::getPayload(const AssetEntry& entry
+) const {
+	return std::span<const uint8_t>{ m_File.data + entry.offset, entry.size };
+}
+
+std::span<const uint8_t> AssetArchive::getMeshVertices(const AssetEntry& entry
+) const {
+	PYX_ENGINE_ASSERT_WARNING(entry.type == AssetType::mesh);
+
+	return getPayload(entry).subspan(0, entry.mesh.vertexBytes);
+}
+
+std::span<const uint8_t> AssetArchive::getMeshIndices(const AssetEntry& entry
+) const {
+	PYX_ENGINE_ASSERT_WARNING(entry.type == AssetType::mesh);
+
+	return getPayload(entry).subspan(
+		entry.mesh.indexOffset, entry.mesh.indexBytes
+	);
+}
+
+namespace {
+	bool isInFile(
+		const MappedFile& file, const uint64_t offset, const uint64_t size
+	) {
+		return offset <= file.size && size <= file.size - offset;
+	}
+
+	bool isValidEntry(
+		const MappedFile& file,
+		const AssetEntry& entry,
+		const uint32_t stringTableSize
+	) {
+		if (entry.offset % c_ASSET_PAYLOAD_ALIGNMENT != 0 ||
+			!isInFile(file, entry.offset, entry.size) ||
+			(uint64_t)entry.nameOffset + entry.nameLength > stringTableSize) {
+			return false;
+		}
+
+		switch (entry.type) {
+			case AssetType::mesh:
+				return entry.mesh.vertexBytes <= entry.size &&
+					entry.mesh.indexOffset <= entry.size &&
+					entry.mesh.indexBytes <=
+					entry.size - entry.mesh.indexOffset;
+			case AssetType::texture:
+				return entry.texture.mipCount > 0;
+			case AssetType::shader:
+				return entry.size % sizeof(uint32_t) == 0;
+		}
+
+		return false;
+	}
+}  // namespace
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vulkan/vulkan.h>
+
+#include "FileMapping.h"
+
+// "PYXA"
+constexpr uint32_t c_ASSET_ARCHIVE_MAGIC{ 0x41585950 };
+constexpr uint32_t c_ASSET_ARCHIVE_VERSION{ 2 };
+// every payload starts at a multiple of this from the start of the file.
+// mappings are page aligned, so payloads can be copied into upload memory
+// with any copy alignment and spir-v can be handed to vulkan in place
+constexpr uint64_t c_ASSET_PAYLOAD_ALIGNMENT{ 256 };
+
+enum class AssetType : uint32_t {
+	mesh,
+	texture,
+	shader,
+};
+
+// AssetEntry::flags
+// mesh streams are encoded with encodeVertexStream and encodeIndexStream
+constexpr uint32_t c_ASSET_FLAG_COMPRESSED{ 1 << 0 };
+
+// the payload holds the vertices, followed by the indices at indexOffset.
+// the byte counts are of the streams as stored, which are smaller than the
+// decoded mesh when it is compressed
+struct MeshAssetInfo {
+	uint32_t vertexCount;
+	uint32_t vertexStride;
+	uint32_t indexCount;
+	VkIndexType indexType;
+	// dequantization of the packed positions
+	float positionScale[3];
+	float positionOffset[3];
+	uint64_t vertexBytes;
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+};
+
+// the payload holds every mip, largest first and tightly packed
+struct TextureAssetInfo {
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	VkFormat format;
+};
+
+// the file starts with the header, the table of contents sits at tocOffset
+// sorted by nameHash. everything is little endian and read in place.
+struct AssetArchiveHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t stringTableSize;
+	uint64_t tocOffset;
+	uint64_t stringTableOffset;
+};
+
+struct AssetEntry {
+	// hashBytes of the name
+	uint64_t nameHash;
+	uint32_t nameOffset;
+	uint32_t nameLength;
+	AssetType type;
+	uint32_t flags;
+	uint64_t offset;
+	uint64_t size;
+	union {
+		MeshAssetInfo mesh;
+		TextureAssetInfo texture;
+	};
+};
+
+static_assert(sizeof(AssetArchiveHeader) == 32);
+static_assert(sizeof(AssetEntry) == 104);
+
+// a cooked archive, mapped for as long as it is open. lookups and payload
+// access read the mapping directly and never allocate, payload spans stay
+// valid until close.
+class AssetArchive {
+   public:
+	// false if the file is missing, truncated or from another version
+	bool open(const std::filesystem::path& path);
+	void close();
+
+	bool isOpen() const { return m_File.data != nullptr; }
+
+	// null if there is no asset with that name
+	const AssetEntry* find(const std::string_view name) const;
+	std::span<const AssetEntry> getEntries() const { return m_Entries; }
+	std::string_view getName(const AssetEntry& entry) const;
+
+	std::span<const uint8_t> getPayload(const AssetEntry& entry) const;
+	std::span<const uint8_t> getMeshVertices(const AssetEntry& entry) const;
+	std::span<const uint8_t> getMeshIndices(const AssetEntry& entry) const;
+
+   private:
+	MappedFile m_File{};
+	std::span<const AssetEntry> m_Entries;
+	const char* m_Strings{};
+};
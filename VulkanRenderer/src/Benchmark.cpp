@@ -0,0 +1,206 @@
+#include "Benchmark.h"
+#include "GpuProfiler.h"
+#include "Logger.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace {
+	// frames rendered at most while waiting for loading to finish
+	constexpr uint32_t c_MAX_LOADING_FRAMES{ 100000 };
+
+	struct FrameSamples {
+		std::vector<double> cpuMs;
+		std::vector<double> submitMs;
+		std::vector<double> fenceWaitMs;
+		std::vector<double> gpuMs;
+	};
+
+	struct ScopeSamples {
+		const char* name;
+		std::vector<double> milliseconds;
+		uint64_t vertexInvocations;
+		uint64_t fragmentInvocations;
+	};
+
+	// adds the scopes of the frame the renderer last read back
+	void addScopeSamples(std::vector<ScopeSamples>& scopes);
+	// { "mean": ..., "p50": ..., ... } or null without samples
+	void writeSummary(std::ofstream& out, std::vector<double>& samples);
+	// nearest rank, samples has to be sorted
+	double getPercentile(
+		const std::vector<double>& samples, const double percentile
+	);
+}  // namespace
+
+bool runBenchmark(const BenchmarkDesc& desc) {
+	using Clock = std::chrono::steady_clock;
+
+	// assets load in the background, measuring before they are resident
+	// would mix empty frames in with full ones
+	uint32_t loadingFrames{};
+	while (!VulkanRenderer::isLoadingIdle() &&
+		   loadingFrames < c_MAX_LOADING_FRAMES) {
+		VulkanRenderer::renderFrame();
+		loadingFrames++;
+	}
+	if (loadingFrames == c_MAX_LOADING_FRAMES) {
+		PYX_ENGINE_WARNING(
+			"[Bench] loading still busy after {0} frames, measuring anyway",
+			loadingFrames
+		);
+	}
+	VulkanRenderer::renderFrames(desc.warmupFrames);
+
+	FrameSamples samples{};
+	std::vector<ScopeSamples> scopes;
+	samples.cpuMs.reserve(desc.frameCount);
+	samples.submitMs.reserve(desc.frameCount);
+	samples.fenceWaitMs.reserve(desc.frameCount);
+	samples.gpuMs.reserve(desc.frameCount);
+
+	Clock::time_point start{ Clock::now() };
+	double elapsedSeconds{};
+	while (desc.seconds > 0. ? elapsedSeconds < desc.seconds
+							 : samples.cpuMs.size() < desc.frameCount) {
+		Clock::time_point frameStart{ Clock::now() };
+		VulkanRenderer::renderFrame();
+		Clock::time_point frameEnd{ Clock::now() };
+
+		VulkanRenderer::FrameTimings timings{
+			VulkanRenderer::getFrameTimings()
+		};
+		samples.cpuMs.emplace_back(
+			std::chrono::duration<double, std::milli>(frameEnd - frameStart)
+				.count()
+		);
+		samples.submitMs.emplace_back(timings.submitMs);
+		samples.fenceWaitMs.emplace_back(timings.fenceWaitMs);
+		// the first frames only see timestamps from before the warm-up
+		// finished, devices without timestamps never report any
+		if (timings.gpuMs > 0.) {
+			samples.gpuMs.emplace_back(timings.gpuMs);
+			addScopeSamples(scopes);
+		}
+
+		elapsedSeconds =
+			std::chrono::duration<double>(frameEnd - start).count();
+	}
+	// the frames still in flight count towards the time they took
+	VulkanRenderer::renderFrames(0);
+	elapsedSeconds =
+		std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::ofstream out(desc.outputPath, std::ios::trunc);
+	if (!out.is_open()) {
+		PYX_ENGINE_ERROR(
+			"[Bench] could not open {0}", desc.outputPath.string()
+		);
+		return false;
+	}
+
+	size_t frameCount{ samples.cpuMs.size() };
+	out << "{\n";
+	out << "\t\"loadingFrames\": " << loadingFrames << ",\n";
+	out << "\t\"warmupFrames\": " << desc.warmupFrames << ",\n";
+	out << "\t\"frames\": " << frameCount << ",\n";
+	out << "\t\"seconds\": " << elapsedSeconds << ",\n";
+	out << "\t\"fps\": " << (double)frameCount / elapsedSeconds << ",\n";
+	out << "\t\"cpuMs\": ";
+	writeSummary(out, samples.cpuMs);
+	out << ",\n\t\"submitMs\": ";
+	writeSummary(out, samples.submitMs);
+	out << ",\n\t\"fenceWaitMs\": ";
+	writeSummary(out, samples.fenceWaitMs);
+	out << ",\n\t\"gpuMs\": ";
+	writeSummary(out, samples.gpuMs);
+	// invocations are means per frame, 0 for scopes without statistics
+	out << ",\n\t\"gpuScopes\": {";
+	for (size_t i{}; i < scopes.size(); i++) {
+		ScopeSamples& scope{ scopes[i] };
+		double scopeFrames{ (double)scope.milliseconds.size() };
+		out << (i == 0 ? "\n" : ",\n") << "\t\t\"" << scope.name
+			<< "\": { \"ms\": ";
+		writeSummary(out, scope.milliseconds);
+		out << ", \"vertexInvocations\": "
+			<< (double)scope.vertexInvocations / scopeFrames
+			<< ", \"fragmentInvocations\": "
+			<< (double)scope.fragmentInvocations / scopeFrames << " }";
+	}
+	out << (scopes.empty() ? "}" : "\n\t}") << "\n}\n";
+
+	if (!out.good()) {
+		PYX_ENGINE_ERROR(
+			"[Bench] could not write {0}", desc.outputPath.string()
+		);
+		return false;
+	}
+
+	std::sort(samples.cpuMs.begin(), samples.cpuMs.end());
+	PYX_ENGINE_INFO(
+		"[Bench] {0} frames in {1}s, p50 {2}ms p99 {3}ms, wrote {4}",
+		frameCount,
+		elapsedSeconds,
+		getPercentile(samples.cpuMs, 50.),
+		getPercentile(samples.cpuMs, 99.),
+		desc.outputPath.string()
+	);
+
+	return true;
+}
+
+namespace {
+	void addScopeSamples(std::vector<ScopeSamples>& scopes) {
+		for (const auto& result : VulkanRenderer::getGpuScopeResults()) {
+			auto scope{ std::ranges::find_if(
+				scopes,
+				[&](const ScopeSamples& scope) {
+					return std::string_view{ scope.name } == result.name;
+				}
+			) };
+			if (scope == scopes.end()) {
+				scopes.emplace_back(ScopeSamples{ .name = result.name });
+				scope = scopes.end() - 1;
+			}
+
+			scope->milliseconds.emplace_back(result.milliseconds);
+			scope->vertexInvocations += result.vertexInvocations;
+			scope->fragmentInvocations += result.fragmentInvocations;
+		}
+	}
+
+	void writeSummary(std::ofstream& out, std::vector<double>& samples) {
+		if (samples.empty()) {
+			out << "null";
+			return;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		double mean{ std::accumulate(samples.begin(), samples.end(), 0.) /
+					 (double)samples.size() };
+		out << "{ \"mean\": " << mean
+			<< ", \"p50\": " << getPercentile(samples, 50.)
+			<< ", \"p95\": " << getPercentile(samples, 95.)
+			<< ", \"p99\": " << getPercentile(samples, 99.)
+			<< ", \"max\": " << samples.back() << " }";
+	}
+
+	double getPercentile(
+		const std::vector<double>& samples, const double percentile
+	) {
+		if (samples.empty()) {
+			return 0.;
+		}
+
+		size_t rank{ (size_t)std::ceil(
+			percentile / 100. * (double)samples.size()
+		) };
+		return samples[std::clamp(rank, (size_t)1, samples.size()) - 1];
+	}
+}  // namespace
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+
+struct BenchmarkDesc {
+	// rendered once loading went idle, before measuring
+	uint32_t warmupFrames;
+	uint32_t frameCount;
+	// measures for this long instead of frameCount frames when not 0
+	double seconds;
+	std::filesystem::path outputPath;
+};
+
+// renders with an initialised renderer and writes mean, p50, p95, p99 and max
+// of the cpu frame time, submit, fence wait, gpu time and the time of every
+// gpu profiler scope as json. false if the report could not be written
+bool runBenchmark(const BenchmarkDesc& desc);
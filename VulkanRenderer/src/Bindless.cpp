@@ -0,0 +1,279 @@
+#include "Bindless.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace {
+	constexpr uint32_t c_MAX_SAMPLED_IMAGES{ 1 << 16 };
+	constexpr uint32_t c_MAX_STORAGE_BUFFERS{ 1 << 16 };
+	constexpr uint32_t c_MAX_SAMPLERS{ 1 << 10 };
+}  // namespace
+
+void BindlessHeap::init(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const uint32_t framesInFlight
+) {
+	m_Device = device;
+	m_FramesInFlight = framesInFlight;
+
+	VkPhysicalDeviceVulkan12Properties vulkan12Props{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+	};
+	VkPhysicalDeviceProperties2 props{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		.pNext = &vulkan12Props,
+	};
+	vkGetPhysicalDeviceProperties2(pDevice, &props);
+
+	m_Pools[(size_t)BindlessType::sampledImage].capacity = std::min({
+		c_MAX_SAMPLED_IMAGES,
+		vulkan12Props.maxDescriptorSetUpdateAfterBindSampledImages,
+		vulkan12Props.maxPerStageDescriptorUpdateAfterBindSampledImages,
+	});
+	m_Pools[(size_t)BindlessType::storageBuffer].capacity = std::min({
+		c_MAX_STORAGE_BUFFERS,
+		vulkan12Props.maxDescriptorSetUpdateAfterBindStorageBuffers,
+		vulkan12Props.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+	});
+	m_Pools[(size_t)BindlessType::sampler].capacity = std::min({
+		c_MAX_SAMPLERS,
+		vulkan12Props.maxDescriptorSetUpdateAfterBindSamplers,
+		vulkan12Props.maxPerStageDescriptorUpdateAfterBindSamplers,
+	});
+
+	std::array<VkDescriptorSetLayoutBinding, (size_t)BindlessType::nTypes>
+		bindings{};
+	std::array<VkDescriptorBindingFlags, (size_t)BindlessType::nTypes>
+		bindingFlags{};
+	std::array<VkDescriptorPoolSize, (size_t)BindlessType::nTypes> poolSizes{};
+	for (uint32_t i{}; i < (uint32_t)BindlessType::nTypes; i++) {
+		VkDescriptorType type{ getDescriptorType((BindlessType)i) };
+		bindings[i] = VkDescriptorSetLayoutBinding{
+			.binding = i,
+			.descriptorType = type,
+			.descriptorCount = m_Pools[i].capacity,
+			.stageFlags = VK_SHADER_STAGE_ALL,
+		};
+		// partially bound lets most of the array stay unwritten, unused while
+		// pending lets new slots be written while frames using the set are
+		// still executing
+		bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		poolSizes[i] = VkDescriptorPoolSize{
+			.type = type,
+			.descriptorCount = m_Pools[i].capacity,
+		};
+	}
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{
+		.sType =
+			VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.bindingCount = (uint32_t)bindingFlags.size(),
+		.pBindingFlags = bindingFlags.data(),
+	};
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &bindingFlagsCreateInfo,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		.bindingCount = (uint32_t)bindings.size(),
+		.pBindings = bindings.data(),
+	};
+	VK_CHECK(vkCreateDescriptorSetLayout(
+		device, &setLayoutCreateInfo, nullptr, &m_SetLayout
+	));
+
+	VkDescriptorPoolCreateInfo poolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets = 1,
+		.poolSizeCount = (uint32_t)poolSizes.size(),
+		.pPoolSizes = poolSizes.data(),
+	};
+	VK_CHECK(vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &m_Pool)
+	);
+
+	VkDescriptorSetAllocateInfo setAllocInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = m_Pool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &m_SetLayout,
+	};
+	VK_CHECK(vkAllocateDescriptorSets(device, &setAllocInfo, &m_Set));
+
+	PYX_ENGINE_INFO(
+		"[Bindless] heap holds {0} images, {1} storage buffers, {2} samplers",
+		m_Pools[(size_t)BindlessType::sampledImage].capacity,
+		m_Pools[(size_t)BindlessType::storageBuffer].capacity,
+		m_Pools[(size_t)BindlessType::sampler].capacity
+	);
+}
+
+void BindlessHeap::shutdown() {
+	vkDestroyDescriptorPool(m_Device, m_Pool, nullptr);
+	vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, nullptr);
+	m_Pool = VK_NULL_HANDLE;
+	m_SetLayout = VK_NULL_HANDLE;
+	m_Set = VK_NULL_HANDLE;
+}
+
+BindlessIndex BindlessHeap::addSampledImage(
+	const VkImageView view, const VkImageLayout layout
+) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	BindlessIndex index{ allocateIndex(BindlessType::sampledImage) };
+	if (index != c_INVALID_BINDLESS_INDEX) {
+		m_PendingWrites.emplace_back(PendingWrite{
+			.type = BindlessType::sampledImage,
+			.index = index,
+			.image = { .imageView = view, .imageLayout = layout },
+		});
+	}
+
+	return index;
+}
+
+BindlessIndex BindlessHeap::addStorageBuffer(
+	const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize range
+) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	BindlessIndex index{ allocateIndex(BindlessType::storageBuffer) };
+	if (index != c_INVALID_BINDLESS_INDEX) {
+		m_PendingWrites.emplace_back(PendingWrite{
+			.type = BindlessType::storageBuffer,
+			.index = index,
+			.buffer = { .buffer = buffer, .offset = offset, .range = range },
+		});
+	}
+
+	return index;
+}
+
+BindlessIndex BindlessHeap::addSampler(const VkSampler sampler) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	BindlessIndex index{ allocateIndex(BindlessType::sampler) };
+	if (index != c_INVALID_BINDLESS_INDEX) {
+		m_PendingWrites.emplace_back(PendingWrite{
+			.type = BindlessType::sampler,
+			.index = index,
+			.image = { .sampler = sampler },
+		});
+	}
+
+	return index;
+}
+
+void BindlessHeap::remove(const BindlessType type, const BindlessIndex index) {
+	if (index == c_INVALID_BINDLESS_INDEX) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	// a write still queued for the slot would land after it is reused
+	std::erase_if(m_PendingWrites, [=](const PendingWrite& write) {
+		return write.type == type && write.index == index;
+	});
+	m_Pools[(size_t)type].retired.emplace_back(
+		RetiredIndex{ .index = index, .frame = m_Frame }
+	);
+}
+
+void BindlessHeap::update() {
+	std::vector<PendingWrite> pendingWrites;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Frame++;
+		for (auto& pool : m_Pools) {
+			std::erase_if(pool.retired, [&](const RetiredIndex& retired) {
+				if (retired.frame + m_FramesInFlight > m_Frame) {
+					return false;
+				}
+				pool.freeIndices.emplace_back(retired.index);
+				return true;
+			});
+		}
+		pendingWrites.swap(m_PendingWrites);
+	}
+
+	if (pendingWrites.empty()) {
+		return;
+	}
+
+	std::vector<VkWriteDescriptorSet> writes;
+	writes.reserve(pendingWrites.size());
+	for (const auto& write : pendingWrites) {
+		bool isBuffer{ write.type == BindlessType::storageBuffer };
+		writes.emplace_back(VkWriteDescriptorSet{
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.dstSet = m_Set,
+			.dstBinding = (uint32_t)write.type,
+			.dstArrayElement = write.index,
+			.descriptorCount = 1,
+			.descriptorType = getDescriptorType(write.type),
+			.pImageInfo = isBuffer ? nullptr : &write.image,
+			.pBufferInfo = isBuffer ? &write.buffer : nullptr,
+		});
+	}
+
+	vkUpdateDescriptorSets(
+		m_Device, (uint32_t)writes.size(), writes.data(), 0, nullptr
+	);
+}
+
+void BindlessHeap::bind(
+	const VkCommandBuffer cmdBuffer,
+	const VkPipelineLayout layout,
+	const VkPipelineBindPoint bindPoint
+) const {
+	vkCmdBindDescriptorSets(
+		cmdBuffer, bindPoint, layout, 0, 1, &m_Set, 0, nullptr
+	);
+}
+
+std::vector<ReflectedBinding> BindlessHeap::getBindings() const {
+	std::vector<ReflectedBinding> bindings;
+	for (uint32_t i{}; i < (uint32_t)BindlessType::nTypes; i++) {
+		bindings.emplace_back(ReflectedBinding{
+			.set = 0,
+			.binding = i,
+			.type = getDescriptorType((BindlessType)i),
+			.count = m_Pools[i].capacity,
+			.stages = VK_SHADER_STAGE_ALL,
+		});
+	}
+
+	return bindings;
+}
+
+BindlessIndex BindlessHeap::allocateIndex(const BindlessType type) {
+	IndexPool& pool{ m_Pools[(size_t)type] };
+	if (!pool.freeIndices.empty()) {
+		BindlessIndex index{ pool.freeIndices.back() };
+		pool.freeIndices.pop_back();
+		return index;
+	}
+
+	if (pool.next == pool.capacity) {
+		PYX_ENGINE_ERROR(
+			"[Bindless] out of slots for descriptor type {0}", (int)type
+		);
+		return c_INVALID_BINDLESS_INDEX;
+	}
+
+	return pool.next++;
+}
+
+VkDescriptorType BindlessHeap::getDescriptorType(const BindlessType type) {
+	switch (type) {
+		case BindlessType::sampledImage:
+			return VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		case BindlessType::storageBuffer:
+			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		case BindlessType::sampler:
+			return VK_DESCRIPTOR_TYPE_SAMPLER;
+		default:
+			return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+	}
+}
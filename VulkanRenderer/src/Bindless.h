@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "ShaderReflection.h"
+
+using BindlessIndex = uint32_t;
+constexpr BindlessIndex c_INVALID_BINDLESS_INDEX{ UINT32_MAX };
+
+// binding number of each array in the heap set
+enum class BindlessType : uint8_t {
+	sampledImage,
+	storageBuffer,
+	sampler,
+	nTypes
+};
+
+// one update after bind descriptor set holding every sampled image, storage
+// buffer and sampler. it is bound once per command buffer at set 0 and draws
+// select their resources with indices passed in push constants. indices stay
+// stable until removed and are only reused once the frames that could still
+// read them have finished.
+class BindlessHeap {
+   public:
+	void init(
+		const VkPhysicalDevice pDevice,
+		const VkDevice device,
+		const uint32_t framesInFlight
+	);
+	void shutdown();
+
+	// safe from any thread, the descriptor is written by the next update()
+	BindlessIndex
+		addSampledImage(const VkImageView view, const VkImageLayout layout);
+	BindlessIndex addStorageBuffer(
+		const VkBuffer buffer, const VkDeviceSize offset, const VkDeviceSize range
+	);
+	BindlessIndex addSampler(const VkSampler sampler);
+	void remove(const BindlessType type, const BindlessIndex index);
+
+	// writes queued descriptors and recycles retired indices, call once per
+	// frame on the render thread before recording
+	void update();
+	void bind(
+		const VkCommandBuffer cmdBuffer,
+		const VkPipelineLayout layout,
+		const VkPipelineBindPoint bindPoint
+	) const;
+
+	VkDescriptorSetLayout getSetLayout() const { return m_SetLayout; }
+	// the bindings shaders have to declare at set 0
+	std::vector<ReflectedBinding> getBindings() const;
+
+   private:
+	struct PendingWrite {
+		BindlessType type;
+		BindlessIndex index;
+		VkDescriptorImageInfo image;
+		VkDescriptorBufferInfo buffer;
+	};
+
+	struct RetiredIndex {
+		BindlessIndex index;
+		uint64_t frame;
+	};
+
+	struct IndexPool {
+		uint32_t capacity;
+		uint32_t next;
+		std::vector<BindlessIndex> freeIndices;
+		std::vector<RetiredIndex> retired;
+	};
+
+	BindlessIndex allocateIndex(const BindlessType type);
+	static VkDescriptorType getDescriptorType(const BindlessType type);
+
+	VkDevice m_Device{};
+	VkDescriptorPool m_Pool{};
+	VkDescriptorSetLayout m_SetLayout{};
+	VkDescriptorSet m_Set{};
+	uint32_t m_FramesInFlight{};
+	uint64_t m_Frame{};
+
+	std::mutex m_Mutex;
+	std::array<IndexPool, (size_t)BindlessType::nTypes> m_Pools{};
+	std::vector<PendingWrite> m_PendingWrites;
+};
@@ -1,4 +1,5 @@
 #include "Commands.h"
+#include "Logger.h"
 #include <iostream>
 #include <vulkan/vulkan_core.h>
 
@@ -55,18 +56,101 @@ bool endTransientCommand(
 	return res;
 }
 
-void copyBuffer(
+void FrameCommandPools::init(
 	const VkDevice device,
-	const uint32_t transferQueueIndex,
-	const VkQueue transferQueue,
-	const VkBuffer srcBuffer,
-	const VkBuffer dstBuffer,
-	const VkDeviceSize size
+	const uint32_t queueFamilyIndex,
+	const uint32_t threadCount,
+	const uint32_t framesInFlight
 ) {
-	ImmCommandInfo cmdInfo{ beginTransientCommand(device, transferQueueIndex) };
+	m_Device = device;
+	m_ThreadCount = threadCount;
 
-	VkBufferCopy bufCpy{ .size = size };
-	vkCmdCopyBuffer(cmdInfo.cmdBuffer, srcBuffer, dstBuffer, 1, &bufCpy);
+	// buffers only live for a frame, and are never reset on their own
+	VkCommandPoolCreateInfo cmdPoolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = queueFamilyIndex,
+	};
+
+	m_Pools.resize((size_t)threadCount * framesInFlight);
+	for (auto& threadCommands : m_Pools) {
+		VK_CHECK(vkCreateCommandPool(
+			device, &cmdPoolCreateInfo, nullptr, &threadCommands.pool
+		));
+	}
+}
+
+void FrameCommandPools::shutdown() {
+	// destroying a pool frees its buffers
+	for (const auto& threadCommands : m_Pools) {
+		vkDestroyCommandPool(m_Device, threadCommands.pool, nullptr);
+	}
+	m_Pools.clear();
+}
+
+void FrameCommandPools::beginFrame(const uint32_t frameIndex) {
+	m_FrameIndex = frameIndex;
+
+	for (uint32_t thread{}; thread < m_ThreadCount; thread++) {
+		ThreadCommands& threadCommands{ getThreadCommands(thread) };
+		if (threadCommands.usedPrimaries == 0 &&
+			threadCommands.usedSecondaries == 0) {
+			continue;
+		}
+		VK_CHECK(vkResetCommandPool(m_Device, threadCommands.pool, 0));
+		threadCommands.usedPrimaries = 0;
+		threadCommands.usedSecondaries = 0;
+	}
+}
+
+VkCommandBuffer FrameCommandPools::getPrimary(const uint32_t threadIndex) {
+	ThreadCommands& threadCommands{ getThreadCommands(threadIndex) };
+
+	return getBuffer(
+		threadCommands.pool,
+		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		threadCommands.primaries,
+		threadCommands.usedPrimaries
+	);
+}
+
+VkCommandBuffer FrameCommandPools::getSecondary(const uint32_t threadIndex) {
+	ThreadCommands& threadCommands{ getThreadCommands(threadIndex) };
+
+	return getBuffer(
+		threadCommands.pool,
+		VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+		threadCommands.secondaries,
+		threadCommands.usedSecondaries
+	);
+}
+
+FrameCommandPools::ThreadCommands&
+	FrameCommandPools::getThreadCommands(const uint32_t threadIndex) {
+	PYX_ENGINE_ASSERT_WARNING(threadIndex < m_ThreadCount);
+
+	return m_Pools[(size_t)m_FrameIndex * m_ThreadCount + threadIndex];
+}
+
+VkCommandBuffer FrameCommandPools::getBuffer(
+	const VkCommandPool pool,
+	const VkCommandBufferLevel level,
+	std::vector<VkCommandBuffer>& buffers,
+	uint32_t& used
+) {
+	if (used == buffers.size()) {
+		VkCommandBufferAllocateInfo cmdBufferAllocInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = pool,
+			.level = level,
+			.commandBufferCount = 1,
+		};
+		VkCommandBuffer cmdBuffer{};
+		VK_CHECK(
+			vkAllocateCommandBuffers(m_Device, &cmdBufferAllocInfo, &cmdBuffer)
+		);
+		buffers.emplace_back(cmdBuffer);
+	}
 
-	endTransientCommand(device, transferQueue, cmdInfo);
+	return buffers[used++];
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdint.h>
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <functional>
@@ -16,11 +17,49 @@ bool endTransientCommand(
 	const VkDevice device, const VkQueue queue, ImmCommandInfo& cmdInfo
 );
 
-void copyBuffer(
-	const VkDevice device,
-	const uint32_t transferQueueIndex,
-	const VkQueue transferQueue,
-	const VkBuffer srcBuffer,
-	const VkBuffer dstBuffer,
-	const VkDeviceSize size
-);
+// a command pool per thread for every frame in flight. buffers are allocated
+// as they are asked for and kept, each pool is reset as a whole with
+// vkResetCommandPool when its frame comes round again instead of resetting
+// buffers one by one. threads only touch their own pools, so recording needs
+// no locking
+class FrameCommandPools {
+   public:
+	void init(
+		const VkDevice device,
+		const uint32_t queueFamilyIndex,
+		const uint32_t threadCount,
+		const uint32_t framesInFlight
+	);
+	void shutdown();
+
+	// resets the pools of frameIndex, the frame's fence has to have
+	// signalled
+	void beginFrame(const uint32_t frameIndex);
+
+	// not begun, valid until the current frame comes round again
+	VkCommandBuffer getPrimary(const uint32_t threadIndex);
+	VkCommandBuffer getSecondary(const uint32_t threadIndex);
+
+   private:
+	struct ThreadCommands {
+		VkCommandPool pool;
+		std::vector<VkCommandBuffer> primaries;
+		std::vector<VkCommandBuffer> secondaries;
+		uint32_t usedPrimaries;
+		uint32_t usedSecondaries;
+	};
+
+	ThreadCommands& getThreadCommands(const uint32_t threadIndex);
+	VkCommandBuffer getBuffer(
+		const VkCommandPool pool,
+		const VkCommandBufferLevel level,
+		std::vector<VkCommandBuffer>& buffers,
+		uint32_t& used
+	);
+
+	VkDevice m_Device{};
+	uint32_t m_ThreadCount{};
+	uint32_t m_FrameIndex{};
+	// frame major, threadCount pools per frame
+	std::vector<ThreadCommands> m_Pools;
+};
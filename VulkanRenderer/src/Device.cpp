@@ -2,7 +2,9 @@
 
 #include "stdint.h"
 #include "Logger.h"
+#include "Trace.h"
 #include <vulkan/vulkan_core.h>
+#include <cstring>
 #include <iostream>
 #include <set>
 
@@ -11,10 +13,16 @@
 namespace {
 	struct PhysicalDeviceCapabilities {
 		VkPhysicalDeviceType deviceType;
+		uint32_t apiVersion;
 		bool graphicsSupport;
 		bool surfaceSupport;
+		// every descriptor indexing feature the bindless heap enables
+		bool bindlessSupport;
+		// 64 bit integers and scalar layouts for vertex pulling
+		bool vertexPullingSupport;
 	};
 
+	// surfaceSupport stays false without a surface
 	PhysicalDeviceCapabilities queryPhysicalDeviceCapabilities(
 		const VkPhysicalDevice pDevice, const VkSurfaceKHR surface
 	);
@@ -37,6 +45,25 @@ VkPhysicalDevice findSuitablePhysicalDevice(
 		PhysicalDeviceCapabilities pCapabilities{
 			queryPhysicalDeviceCapabilities(pDeviceTest, surface)
 		};
+		// device creation asks for 1.3 features, cpu implementations like
+		// lavapipe are only ever picked when they pass this
+		if (pCapabilities.apiVersion < VK_API_VERSION_1_3) {
+			continue;
+		}
+		// createLogicalDevice enables these unconditionally, a device without
+		// them would fail vkCreateDevice instead of losing out here
+		if (!pCapabilities.bindlessSupport ||
+			!pCapabilities.vertexPullingSupport) {
+			continue;
+		}
+		// the renderer looks up a graphics queue either way, and a present
+		// queue when there is a window
+		if (!pCapabilities.graphicsSupport) {
+			continue;
+		}
+		if (surface != VK_NULL_HANDLE && !pCapabilities.surfaceSupport) {
+			continue;
+		}
 
 		uint32_t score{};
 		switch (pCapabilities.deviceType) {
@@ -54,19 +81,26 @@ VkPhysicalDevice findSuitablePhysicalDevice(
 			}
 		}
 
-		if (pCapabilities.surfaceSupport) {
-			score += 5000;
-		}
-		if (pCapabilities.graphicsSupport) {
-			score += 5000;
-		}
-
 		if (score >= heighestScore) {
 			pDevice = pDeviceTest;
 			heighestScore = score;
 		}
 	}
 
+	if (pDevice == VK_NULL_HANDLE) {
+		PYX_ENGINE_ERROR(
+			"no physical device supports vulkan 1.3 and the required features"
+		);
+		return pDevice;
+	}
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(pDevice, &props);
+	PYX_ENGINE_INFO(
+		"using physical device: {0} (type {1})",
+		props.deviceName,
+		(int)props.deviceType
+	);
+
 	return pDevice;
 }
 
@@ -75,15 +109,29 @@ VkDevice createLogicalDevice(
 	const VkPhysicalDevice pDevice,
 	const VkSurfaceKHR surface
 ) {
+	PYX_TRACE_FUNCTION();
+
 	std::vector<const char*> requiredDeviceExtensions{
-		VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 		VK_KHR_MAINTENANCE1_EXTENSION_NAME,
 		VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
 		VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
 	};
+	// headless devices may not offer it at all
+	if (surface != VK_NULL_HANDLE) {
+		requiredDeviceExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+	// real heap budgets for texture streaming, vma estimates them without it
+	if (isDeviceExtensionSupported(
+			pDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+		)) {
+		requiredDeviceExtensions.emplace_back(
+			VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
+		);
+	}
 
 	VkPhysicalDeviceVulkan13Features vulkan13Features{
 		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+		.pipelineCreationCacheControl = VK_TRUE,
 		.synchronization2 = VK_TRUE,
 		.dynamicRendering = VK_TRUE,
 	};
@@ -91,15 +139,37 @@ VkDevice createLogicalDevice(
 		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
 		.pNext = &vulkan13Features,
 		.descriptorIndexing = VK_TRUE,
+		// the individual descriptor indexing features the bindless heap needs,
+		// findSuitablePhysicalDevice only picks devices that have them all
+		.shaderSampledImageArrayNonUniformIndexing = VK_TRUE,
+		.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE,
+		.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+		.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+		.descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+		.descriptorBindingPartiallyBound = VK_TRUE,
+		.runtimeDescriptorArray = VK_TRUE,
+		.scalarBlockLayout = VK_TRUE,
+		.timelineSemaphore = VK_TRUE,
 		.bufferDeviceAddress = VK_TRUE,
-
 	};
 	VkPhysicalDeviceVulkan11Features vulkan11Features{
 		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
 		.pNext = &vulkan12Features
 	};
+	VkPhysicalDeviceFeatures supportedFeatures{};
+	vkGetPhysicalDeviceFeatures(pDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures defaultFeatures{
 		.samplerAnisotropy = VK_TRUE,
+		// cooked textures, the texture manager rejects them without it
+		.textureCompressionBC = supportedFeatures.textureCompressionBC,
+		// shader invocation counts in the gpu profiler, inherited by the
+		// secondaries a pass executes
+		.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery,
+		// 64 bit buffer addresses in vertex pulling shaders, checked by
+		// findSuitablePhysicalDevice
+		.shaderInt64 = VK_TRUE,
+		.inheritedQueries = supportedFeatures.inheritedQueries,
 	};
 
 	VkPhysicalDeviceFeatures2 requiredFeatures{
@@ -141,6 +211,48 @@ VkDevice createLogicalDevice(
 	return device;
 }
 
+bool isDeviceExtensionSupported(
+	const VkPhysicalDevice pDevice, const char* extension
+) {
+	uint32_t extensionCount{};
+	VK_CHECK(vkEnumerateDeviceExtensionProperties(
+		pDevice, nullptr, &extensionCount, nullptr
+	));
+
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	VK_CHECK(vkEnumerateDeviceExtensionProperties(
+		pDevice, nullptr, &extensionCount, extensions.data()
+	));
+
+	for (const auto& properties : extensions) {
+		if (std::strcmp(properties.extensionName, extension) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint32_t getTimestampValidBits(
+	const VkPhysicalDevice pDevice, const uint32_t queueFamilyIndex
+) {
+	uint32_t queueFamilyPropsCount{};
+	vkGetPhysicalDeviceQueueFamilyProperties(
+		pDevice, &queueFamilyPropsCount, nullptr
+	);
+
+	std::vector<VkQueueFamilyProperties> queueFamilyProps(queueFamilyPropsCount
+	);
+	vkGetPhysicalDeviceQueueFamilyProperties(
+		pDevice, &queueFamilyPropsCount, queueFamilyProps.data()
+	);
+
+	if (queueFamilyIndex >= queueFamilyPropsCount) {
+		return 0;
+	}
+	return queueFamilyProps[queueFamilyIndex].timestampValidBits;
+}
+
 std::unordered_map<QueueFamily, uint32_t> getDeviceQueueIndices(
 	const VkPhysicalDevice pDevice, const VkSurfaceKHR surface
 ) {
@@ -172,10 +284,13 @@ std::unordered_map<QueueFamily, uint32_t> getDeviceQueueIndices(
 				continue;
 			}
 
+			// nothing is presented without a surface
 			VkBool32 presentationSupport{};
-			vkGetPhysicalDeviceSurfaceSupportKHR(
-				pDevice, i, surface, &presentationSupport
-			);
+			if (surface != VK_NULL_HANDLE) {
+				vkGetPhysicalDeviceSurfaceSupportKHR(
+					pDevice, i, surface, &presentationSupport
+				);
+			}
 			if (presentationSupport && !presentationQueueFound) {
 				queueFamilyToIndex[QueueFamily::presentation] = i;
 				presentationQueueFound = true;
@@ -196,6 +311,22 @@ std::unordered_map<QueueFamily, uint32_t> getDeviceQueueIndices(
 		}
 	}
 
+	// a transfer only family maps to the dma engines, which copy alongside
+	// graphics work instead of competing with it
+	for (uint32_t i{}; i < queueFamilyProps.size(); i++) {
+		VkQueueFlags queueFlags{ queueFamilyProps[i].queueFlags };
+		if (queueFlags & VK_QUEUE_TRANSFER_BIT &&
+			!(queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+			queueFamilyToIndex[QueueFamily::transfer] = i;
+			transferQueueFound = true;
+			break;
+		}
+	}
+	if (!transferQueueFound && graphicsQueueFound) {
+		queueFamilyToIndex[QueueFamily::transfer] =
+			queueFamilyToIndex[QueueFamily::graphics];
+	}
+
 	return queueFamilyToIndex;
 }
 
@@ -204,9 +335,31 @@ namespace {
 		const VkPhysicalDevice pDevice, const VkSurfaceKHR surface
 	) {
 		VkPhysicalDeviceProperties props{};
-		VkPhysicalDeviceFeatures feats{};
 		vkGetPhysicalDeviceProperties(pDevice, &props);
-		vkGetPhysicalDeviceFeatures(pDevice, &feats);
+
+		// the 1.2 feature struct is only valid to query from 1.2 on
+		VkPhysicalDeviceVulkan12Features vulkan12Features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+		};
+		VkPhysicalDeviceFeatures2 feats{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vulkan12Features,
+		};
+		if (props.apiVersion >= VK_API_VERSION_1_2) {
+			vkGetPhysicalDeviceFeatures2(pDevice, &feats);
+		}
+		bool bindlessSupported{
+			vulkan12Features.descriptorIndexing &&
+			vulkan12Features.shaderSampledImageArrayNonUniformIndexing &&
+			vulkan12Features.shaderStorageBufferArrayNonUniformIndexing &&
+			vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+			vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+			vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+			vulkan12Features.descriptorBindingPartiallyBound &&
+			vulkan12Features.runtimeDescriptorArray
+		};
+		bool vertexPullingSupported{ feats.features.shaderInt64 &&
+									 vulkan12Features.scalarBlockLayout };
 
 		uint32_t queueFamilyPropCount{};
 		vkGetPhysicalDeviceQueueFamilyProperties(
@@ -222,9 +375,11 @@ namespace {
 		bool graphicsSupported{ false };
 		for (uint32_t i{}; i < queueFamilys.size(); i++) {
 			VkBool32 queueSupportsSurface{ false };
-			vkGetPhysicalDeviceSurfaceSupportKHR(
-				pDevice, i, surface, &queueSupportsSurface
-			);
+			if (surface != VK_NULL_HANDLE) {
+				vkGetPhysicalDeviceSurfaceSupportKHR(
+					pDevice, i, surface, &queueSupportsSurface
+				);
+			}
 
 			surfaceSupported |= queueSupportsSurface != 0;
 
@@ -235,11 +390,14 @@ namespace {
 				break;
 			}
 		}
-		PhysicalDeviceCapabilities capabilities{ .deviceType = props.deviceType,
-												 .graphicsSupport =
-													 graphicsSupported,
-												 .surfaceSupport =
-													 surfaceSupported };
+		PhysicalDeviceCapabilities capabilities{
+			.deviceType = props.deviceType,
+			.apiVersion = props.apiVersion,
+			.graphicsSupport = graphicsSupported,
+			.surfaceSupport = surfaceSupported,
+			.bindlessSupport = bindlessSupported,
+			.vertexPullingSupport = vertexPullingSupported,
+		};
 		return capabilities;
 	}
 }  // namespace
@@ -17,9 +17,18 @@ struct LogicalDeviceInfo {
 	uint32_t queueFamiliesIndices[(size_t)QueueFamily::nQueueFamilies];
 };
 
+// surface can be VK_NULL_HANDLE for headless rendering, devices are then
+// picked by type and graphics support alone. null if none supports 1.3
 VkPhysicalDevice findSuitablePhysicalDevice(
 	const VkInstance instance, const VkSurfaceKHR surface
 );
+bool isDeviceExtensionSupported(
+	const VkPhysicalDevice pDevice, const char* extension
+);
+// 0 when the family cannot write timestamps
+uint32_t getTimestampValidBits(
+	const VkPhysicalDevice pDevice, const uint32_t queueFamilyIndex
+);
 std::unordered_map<QueueFamily, uint32_t> getDeviceQueueIndices(
 	const VkPhysicalDevice pDevice, const VkSurfaceKHR surface
 );
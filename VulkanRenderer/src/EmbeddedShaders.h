@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <string_view>
+
+// empty unless the build embeds shaders (PYX_EMBED_SHADERS)
+std::span<const uint32_t> findEmbeddedShader(const std::string_view name);
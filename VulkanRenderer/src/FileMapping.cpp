@@ -0,0 +1,105 @@
+#include "FileMapping.h"
+
+#ifdef PYX_PLATFORM_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#ifdef PYX_PLATFORM_WINDOWS
+std::optional<MappedFile> mapFile(const std::filesystem::path& path) {
+	HANDLE file{ CreateFileW(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr
+	) };
+	if (file == INVALID_HANDLE_VALUE) {
+		return {};
+	}
+
+	LARGE_INTEGER fileSize{};
+	GetFileSizeEx(file, &fileSize);
+	if (fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return MappedFile{};
+	}
+
+	HANDLE mapping{
+		CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr)
+	};
+	CloseHandle(file);
+	if (mapping == nullptr) {
+		return {};
+	}
+
+	void* data{ MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) };
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		return {};
+	}
+
+	MappedFile mappedFile{
+		.data = (const uint8_t*)data,
+		.size = (size_t)fileSize.QuadPart,
+		.platformHandle = mapping,
+	};
+
+	return mappedFile;
+}
+
+void unmapFile(const MappedFile& file) {
+	if (file.data == nullptr) {
+		return;
+	}
+	UnmapViewOfFile(file.data);
+	CloseHandle((HANDLE)file.platformHandle);
+}
+#else
+std::optional<MappedFile> mapFile(const std::filesystem::path& path) {
+	int fd{ open(path.c_str(), O_RDONLY) };
+	if (fd < 0) {
+		return {};
+	}
+
+	struct stat fileStat {};
+	if (fstat(fd, &fileStat) != 0) {
+		close(fd);
+		return {};
+	}
+	if (fileStat.st_size == 0) {
+		close(fd);
+		return MappedFile{};
+	}
+
+	void* data{
+		mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0)
+	};
+	// the mapping keeps its own reference to the file
+	close(fd);
+	if (data == MAP_FAILED) {
+		return {};
+	}
+
+	MappedFile mappedFile{
+		.data = (const uint8_t*)data,
+		.size = (size_t)fileStat.st_size,
+	};
+
+	return mappedFile;
+}
+
+void unmapFile(const MappedFile& file) {
+	if (file.data == nullptr) {
+		return;
+	}
+	munmap((void*)file.data, file.size);
+}
+#endif
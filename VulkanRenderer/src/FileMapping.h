@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+#include <optional>
+
+// read only view of a whole file
+struct MappedFile {
+	const uint8_t* data;
+	size_t size;
+
+	void* platformHandle;
+};
+
+std::optional<MappedFile> mapFile(const std::filesystem::path& path);
+void unmapFile(const MappedFile& file);
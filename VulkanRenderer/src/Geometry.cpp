@@ -0,0 +1,414 @@
+#include "Geometry.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace {
+	// allocators work in units of this many bytes, enough alignment for any
+	// vertex attribute and both index types
+	constexpr VkDeviceSize c_GEOMETRY_UNIT{ 16 };
+	constexpr VkDeviceSize c_UPLOAD_CHUNK_SIZE{ 1024 * 1024 };
+
+	// uploads are also read by defragment copies on the graphics queue
+	constexpr VkPipelineStageFlags2 c_GEOMETRY_STAGES{
+		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_COPY_BIT
+	};
+	constexpr VkAccessFlags2 c_GEOMETRY_ACCESS{
+		VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT |
+		VK_ACCESS_2_TRANSFER_READ_BIT
+	};
+
+	uint32_t toUnits(const VkDeviceSize bytes);
+	uint32_t getIndexSize(const VkIndexType indexType);
+}  // namespace
+
+void GeometryBuffer::init(
+	const VmaAllocator allocator,
+	const VkDevice device,
+	const VkDeviceSize vertexCapacity,
+	const VkDeviceSize indexCapacity,
+	const uint32_t maxMeshes,
+	const uint32_t framesInFlight
+) {
+	m_Allocator = allocator;
+	m_Device = device;
+	m_VertexCapacity = vertexCapacity;
+	m_IndexCapacity = indexCapacity;
+	m_MaxMeshes = maxMeshes;
+	m_FramesInFlight = framesInFlight;
+
+	m_VertexBuffer = createVertexBuffer();
+	m_IndexBuffer = createIndexBuffer();
+	m_VertexBufferAddress = getBufferDeviceAddress(device, m_VertexBuffer);
+	m_IndexBufferAddress = getBufferDeviceAddress(device, m_IndexBuffer);
+
+	m_VertexAllocator.init(toUnits(vertexCapacity), maxMeshes);
+	m_IndexAllocator.init(toUnits(indexCapacity), maxMeshes);
+}
+
+void GeometryBuffer::shutdown() {
+	for (const auto& retired : m_RetiredBuffers) {
+		destroyBuffer(m_Allocator, retired.buffer);
+	}
+	destroyBuffer(m_Allocator, m_VertexBuffer);
+	destroyBuffer(m_Allocator, m_IndexBuffer);
+
+	m_RetiredBuffers.clear();
+	m_RetiredMeshes.clear();
+	m_PendingUploads.clear();
+	m_Meshes.clear();
+	m_FreeMeshes.clear();
+}
+
+MeshHandle GeometryBuffer::addMesh(
+	std::vector<uint8_t> vertexData,
+	const uint32_t vertexStride,
+	std::vector<uint8_t> indexData,
+	const VkIndexType indexType
+) {
+	MeshHandle mesh{ addMesh(
+		std::span<const uint8_t>{ vertexData },
+		vertexStride,
+		std::span<const uint8_t>{ indexData },
+		indexType
+	) };
+	// moving keeps the storage the pending spans point at
+	if (mesh != c_INVALID_MESH) {
+		m_PendingUploads.back().ownedVertexData = std::move(vertexData);
+		m_PendingUploads.back().ownedIndexData = std::move(indexData);
+	}
+
+	return mesh;
+}
+
+MeshHandle GeometryBuffer::addMesh(
+	const std::span<const uint8_t> vertexData,
+	const uint32_t vertexStride,
+	const std::span<const uint8_t> indexData,
+	const VkIndexType indexType
+) {
+	PYX_ENGINE_ASSERT_WARNING(!vertexData.empty() && !indexData.empty());
+
+	OffsetAllocation vertexAllocation{
+		m_VertexAllocator.allocate(toUnits(vertexData.size()))
+	};
+	OffsetAllocation indexAllocation{
+		m_IndexAllocator.allocate(toUnits(indexData.size()))
+	};
+	if (vertexAllocation.offset == c_OFFSET_ALLOCATOR_NO_SPACE ||
+		indexAllocation.offset == c_OFFSET_ALLOCATOR_NO_SPACE) {
+		m_VertexAllocator.free(vertexAllocation);
+		m_IndexAllocator.free(indexAllocation);
+
+		// enough space in total means it is fragmented
+		bool fragmented{
+			m_VertexAllocator.getFreeStorage() >= toUnits(vertexData.size()) &&
+			m_IndexAllocator.getFreeStorage() >= toUnits(indexData.size())
+		};
+		PYX_ENGINE_ERROR(
+			"[Geometry] no space for a mesh of {0} + {1} bytes{2}",
+			vertexData.size(),
+			indexData.size(),
+			fragmented ? ", defragmenting" : ""
+		);
+		if (fragmented) {
+			requestDefragment();
+		}
+		return c_INVALID_MESH;
+	}
+
+	MeshEntry entry{
+		.vertexAllocation = vertexAllocation,
+		.indexAllocation = indexAllocation,
+		.vertexBytes = (uint32_t)vertexData.size(),
+		.indexBytes = (uint32_t)indexData.size(),
+		.vertexStride = vertexStride,
+		.indexType = indexType,
+		.alive = true,
+		.ready = false,
+	};
+
+	MeshHandle mesh{};
+	if (!m_FreeMeshes.empty()) {
+		mesh = m_FreeMeshes.back();
+		m_FreeMeshes.pop_back();
+		m_Meshes[mesh] = entry;
+	} else {
+		mesh = (MeshHandle)m_Meshes.size();
+		m_Meshes.emplace_back(entry);
+	}
+
+	m_PendingUploads.emplace_back(PendingUpload{
+		.mesh = mesh,
+		.vertexData = vertexData,
+		.indexData = indexData,
+	});
+
+	return mesh;
+}
+
+void GeometryBuffer::removeMesh(const MeshHandle mesh) {
+	MeshEntry& entry{ m_Meshes[mesh] };
+	PYX_ENGINE_ASSERT_WARNING(entry.alive);
+
+	std::erase_if(m_PendingUploads, [=](const PendingUpload& upload) {
+		return upload.mesh == mesh;
+	});
+	m_RetiredMeshes.emplace_back(RetiredMesh{
+		.vertexAllocation = entry.vertexAllocation,
+		.indexAllocation = entry.indexAllocation,
+		.frame = m_Frame,
+	});
+
+	entry.alive = false;
+	m_FreeMeshes.emplace_back(mesh);
+}
+
+bool GeometryBuffer::isMeshReady(const MeshHandle mesh) const {
+	return m_Meshes[mesh].alive && m_Meshes[mesh].ready;
+}
+
+MeshDrawInfo GeometryBuffer::getMesh(const MeshHandle mesh) const {
+	const MeshEntry& entry{ m_Meshes[mesh] };
+	VkDeviceSize vertexOffset{ entry.vertexAllocation.offset *
+							   c_GEOMETRY_UNIT };
+	VkDeviceSize indexOffset{ entry.indexAllocation.offset * c_GEOMETRY_UNIT };
+	uint32_t indexSize{ getIndexSize(entry.indexType) };
+
+	return MeshDrawInfo{
+		.vertexAddress = m_VertexBufferAddress + vertexOffset,
+		.indexAddress = m_IndexBufferAddress + indexOffset,
+		.firstIndex = (uint32_t)(indexOffset / indexSize),
+		.indexCount = entry.indexBytes / indexSize,
+		.vertexCount = entry.vertexBytes / entry.vertexStride,
+		.indexType = entry.indexType,
+	};
+}
+
+void GeometryBuffer::update(UploadRing& ring, TransferEngine& transfer) {
+	m_Frame++;
+
+	std::erase_if(m_RetiredMeshes, [&](const RetiredMesh& retired) {
+		if (retired.frame + m_FramesInFlight > m_Frame) {
+			return false;
+		}
+		m_VertexAllocator.free(retired.vertexAllocation);
+		m_IndexAllocator.free(retired.indexAllocation);
+		return true;
+	});
+	std::erase_if(m_RetiredBuffers, [&](const RetiredBuffer& retired) {
+		if (retired.frame + m_FramesInFlight > m_Frame) {
+			return false;
+		}
+		destroyBuffer(m_Allocator, retired.buffer);
+		return true;
+	});
+
+	// oldest first, a mesh is only ready once all of its data is in flight
+	size_t completed{};
+	for (auto& upload : m_PendingUploads) {
+		MeshEntry& entry{ m_Meshes[upload.mesh] };
+		if (!streamUpload(
+				ring,
+				transfer,
+				upload.vertexData,
+				upload.vertexProgress,
+				m_VertexBuffer.handle,
+				entry.vertexAllocation.offset * c_GEOMETRY_UNIT
+			) ||
+			!streamUpload(
+				ring,
+				transfer,
+				upload.indexData,
+				upload.indexProgress,
+				m_IndexBuffer.handle,
+				entry.indexAllocation.offset * c_GEOMETRY_UNIT
+			)) {
+			break;
+		}
+
+		entry.ready = true;
+		completed++;
+	}
+	m_PendingUploads.erase(
+		m_PendingUploads.begin(), m_PendingUploads.begin() + completed
+	);
+}
+
+void GeometryBuffer::recordDefragment(const VkCommandBuffer cmdBuffer) {
+	if (!m_DefragmentRequested) {
+		return;
+	}
+	m_DefragmentRequested = false;
+
+	OffsetAllocator vertexAllocator;
+	OffsetAllocator indexAllocator;
+	vertexAllocator.init(toUnits(m_VertexCapacity), m_MaxMeshes);
+	indexAllocator.init(toUnits(m_IndexCapacity), m_MaxMeshes);
+
+	// packing in the current order leaves no holes
+	std::vector<MeshHandle> meshes;
+	for (MeshHandle mesh{}; mesh < m_Meshes.size(); mesh++) {
+		if (m_Meshes[mesh].alive) {
+			meshes.emplace_back(mesh);
+		}
+	}
+	std::ranges::sort(meshes, [&](const MeshHandle a, const MeshHandle b) {
+		return m_Meshes[a].vertexAllocation.offset <
+			m_Meshes[b].vertexAllocation.offset;
+	});
+
+	std::vector<VkBufferCopy> vertexCopies;
+	std::vector<VkBufferCopy> indexCopies;
+	for (const auto mesh : meshes) {
+		MeshEntry& entry{ m_Meshes[mesh] };
+		OffsetAllocation vertexAllocation{
+			vertexAllocator.allocate(toUnits(entry.vertexBytes))
+		};
+		OffsetAllocation indexAllocation{
+			indexAllocator.allocate(toUnits(entry.indexBytes))
+		};
+
+		vertexCopies.emplace_back(VkBufferCopy{
+			.srcOffset = entry.vertexAllocation.offset * c_GEOMETRY_UNIT,
+			.dstOffset = vertexAllocation.offset * c_GEOMETRY_UNIT,
+			.size = entry.vertexBytes,
+		});
+		indexCopies.emplace_back(VkBufferCopy{
+			.srcOffset = entry.indexAllocation.offset * c_GEOMETRY_UNIT,
+			.dstOffset = indexAllocation.offset * c_GEOMETRY_UNIT,
+			.size = entry.indexBytes,
+		});
+
+		entry.vertexAllocation = vertexAllocation;
+		entry.indexAllocation = indexAllocation;
+	}
+
+	BufferInfo vertexBuffer{ createVertexBuffer() };
+	BufferInfo indexBuffer{ createIndexBuffer() };
+	if (!vertexCopies.empty()) {
+		vkCmdCopyBuffer(
+			cmdBuffer,
+			m_VertexBuffer.handle,
+			vertexBuffer.handle,
+			(uint32_t)vertexCopies.size(),
+			vertexCopies.data()
+		);
+		vkCmdCopyBuffer(
+			cmdBuffer,
+			m_IndexBuffer.handle,
+			indexBuffer.handle,
+			(uint32_t)indexCopies.size(),
+			indexCopies.data()
+		);
+	}
+
+	VkMemoryBarrier2 copyBarrier{
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = c_GEOMETRY_STAGES,
+		.dstAccessMask = c_GEOMETRY_ACCESS,
+	};
+	VkDependencyInfo dependencyInfo{
+		.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.memoryBarrierCount = 1,
+		.pMemoryBarriers = &copyBarrier,
+	};
+	vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+	PYX_ENGINE_INFO(
+		"[Geometry] defragmented {0} meshes, largest free vertex region {1} "
+		"-> {2} bytes",
+		meshes.size(),
+		m_VertexAllocator.getLargestFreeRegion() * c_GEOMETRY_UNIT,
+		vertexAllocator.getLargestFreeRegion() * c_GEOMETRY_UNIT
+	);
+
+	// earlier frames may still read the old buffers, ranges retired in them
+	// go with them
+	m_RetiredBuffers.emplace_back(
+		RetiredBuffer{ .buffer = m_VertexBuffer, .frame = m_Frame }
+	);
+	m_RetiredBuffers.emplace_back(
+		RetiredBuffer{ .buffer = m_IndexBuffer, .frame = m_Frame }
+	);
+	m_RetiredMeshes.clear();
+
+	m_VertexBuffer = vertexBuffer;
+	m_IndexBuffer = indexBuffer;
+	m_VertexBufferAddress = getBufferDeviceAddress(m_Device, vertexBuffer);
+	m_IndexBufferAddress = getBufferDeviceAddress(m_Device, indexBuffer);
+	m_VertexAllocator = std::move(vertexAllocator);
+	m_IndexAllocator = std::move(indexAllocator);
+}
+
+BufferInfo GeometryBuffer::createVertexBuffer() const {
+	return createBuffer(
+		m_Allocator,
+		m_VertexCapacity,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+	);
+}
+
+BufferInfo GeometryBuffer::createIndexBuffer() const {
+	return createBuffer(
+		m_Allocator,
+		m_IndexCapacity,
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+			VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT |
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+	);
+}
+
+bool GeometryBuffer::streamUpload(
+	UploadRing& ring,
+	TransferEngine& transfer,
+	const std::span<const uint8_t> data,
+	size_t& progress,
+	const VkBuffer dstBuffer,
+	const VkDeviceSize dstOffset
+) {
+	while (progress < data.size()) {
+		VkDeviceSize chunkSize{
+			std::min<VkDeviceSize>(data.size() - progress, c_UPLOAD_CHUNK_SIZE)
+		};
+		std::optional<UploadAllocation> upload{
+			writeUpload(ring, data.data() + progress, chunkSize, 4)
+		};
+		if (!upload.has_value()) {
+			return false;
+		}
+
+		enqueueBufferCopy(
+			transfer,
+			upload->buffer,
+			dstBuffer,
+			VkBufferCopy{
+				.srcOffset = upload->offset,
+				.dstOffset = dstOffset + progress,
+				.size = chunkSize,
+			},
+			c_GEOMETRY_STAGES,
+			c_GEOMETRY_ACCESS
+		);
+		progress += chunkSize;
+	}
+
+	return true;
+}
+
+namespace {
+	uint32_t toUnits(const VkDeviceSize bytes) {
+		return (uint32_t)((bytes + c_GEOMETRY_UNIT - 1) / c_GEOMETRY_UNIT);
+	}
+
+	uint32_t getIndexSize(const VkIndexType indexType) {
+		return indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4;
+	}
+}  // namespace
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "Memory.h"
+#include "OffsetAllocator.h"
+#include "Transfer.h"
+#include "UploadRing.h"
+
+using MeshHandle = uint32_t;
+constexpr MeshHandle c_INVALID_MESH{ UINT32_MAX };
+
+struct MeshDrawInfo {
+	// first vertex of the mesh, pushed to the vertex pulling shaders
+	VkDeviceAddress vertexAddress;
+	VkDeviceAddress indexAddress;
+	// in indices of indexType from the start of the index buffer
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	uint32_t vertexCount;
+	VkIndexType indexType;
+};
+
+// every mesh lives in one shared vertex buffer and one shared index buffer,
+// suballocated with an OffsetAllocator. meshes are handles that stay valid
+// across defragmentation, their addresses and offsets do not, so query them
+// every frame. mesh data is streamed through the upload ring over as many
+// frames as it takes.
+class GeometryBuffer {
+   public:
+	void init(
+		const VmaAllocator allocator,
+		const VkDevice device,
+		const VkDeviceSize vertexCapacity,
+		const VkDeviceSize indexCapacity,
+		const uint32_t maxMeshes,
+		const uint32_t framesInFlight
+	);
+	void shutdown();
+
+	// indexed meshes only. c_INVALID_MESH when either buffer is out of space
+	MeshHandle addMesh(
+		std::vector<uint8_t> vertexData,
+		const uint32_t vertexStride,
+		std::vector<uint8_t> indexData,
+		const VkIndexType indexType
+	);
+	// same as above without taking ownership, the data has to stay alive
+	// until the mesh is ready. used for payloads in mapped archives
+	MeshHandle addMesh(
+		const std::span<const uint8_t> vertexData,
+		const uint32_t vertexStride,
+		const std::span<const uint8_t> indexData,
+		const VkIndexType indexType
+	);
+	// the space is reused once the frames in flight are done with it
+	void removeMesh(const MeshHandle mesh);
+	// all of its data is part of a submitted transfer
+	bool isMeshReady(const MeshHandle mesh) const;
+	// every added mesh is part of a submitted transfer
+	bool isIdle() const { return m_PendingUploads.empty(); }
+	MeshDrawInfo getMesh(const MeshHandle mesh) const;
+
+	// streams pending mesh data, call once per frame after beginUploadRegion
+	// and before submitTransfers
+	void update(UploadRing& ring, TransferEngine& transfer);
+
+	void requestDefragment() { m_DefragmentRequested = true; }
+	// compacts both buffers into new ones if requested, call on the
+	// graphics queue after recordTransferAcquires. the old buffers stay
+	// alive until the frames in flight are done with them
+	void recordDefragment(const VkCommandBuffer cmdBuffer);
+
+	VkBuffer getIndexBuffer() const { return m_IndexBuffer.handle; }
+
+   private:
+	struct MeshEntry {
+		OffsetAllocation vertexAllocation;
+		OffsetAllocation indexAllocation;
+		uint32_t vertexBytes;
+		uint32_t indexBytes;
+		uint32_t vertexStride;
+		VkIndexType indexType;
+		bool alive;
+		bool ready;
+	};
+
+	struct PendingUpload {
+		MeshHandle mesh;
+		std::span<const uint8_t> vertexData;
+		std::span<const uint8_t> indexData;
+		// set when the caller handed over its data
+		std::vector<uint8_t> ownedVertexData;
+		std::vector<uint8_t> ownedIndexData;
+		size_t vertexProgress;
+		size_t indexProgress;
+	};
+
+	struct RetiredMesh {
+		OffsetAllocation vertexAllocation;
+		OffsetAllocation indexAllocation;
+		uint64_t frame;
+	};
+
+	struct RetiredBuffer {
+		BufferInfo buffer;
+		uint64_t frame;
+	};
+
+	BufferInfo createVertexBuffer() const;
+	BufferInfo createIndexBuffer() const;
+	// false once the upload region is full
+	bool streamUpload(
+		UploadRing& ring,
+		TransferEngine& transfer,
+		const std::span<const uint8_t> data,
+		size_t& progress,
+		const VkBuffer dstBuffer,
+		const VkDeviceSize dstOffset
+	);
+
+	VmaAllocator m_Allocator{};
+	VkDevice m_Device{};
+	VkDeviceSize m_VertexCapacity{};
+	VkDeviceSize m_IndexCapacity{};
+	uint32_t m_MaxMeshes{};
+	uint32_t m_FramesInFlight{};
+	uint64_t m_Frame{};
+
+	BufferInfo m_VertexBuffer{};
+	BufferInfo m_IndexBuffer{};
+	VkDeviceAddress m_VertexBufferAddress{};
+	VkDeviceAddress m_IndexBufferAddress{};
+	OffsetAllocator m_VertexAllocator;
+	OffsetAllocator m_IndexAllocator;
+
+	std::vector<MeshEntry> m_Meshes;
+	std::vector<MeshHandle> m_FreeMeshes;
+	std::vector<PendingUpload> m_PendingUploads;
+	std::vector<RetiredMesh> m_RetiredMeshes;
+	std::vector<RetiredBuffer> m_RetiredBuffers;
+
+	bool m_DefragmentRequested{};
+};
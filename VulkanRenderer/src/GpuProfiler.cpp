@@ -0,0 +1,232 @@
+#include "GpuProfiler.h"
+#include "Device.h"
+#include "Logger.h"
+
+namespace {
+	constexpr uint32_t c_MAX_SCOPES{ 64 };
+	// results come back in bit order, vertex invocations first
+	constexpr VkQueryPipelineStatisticFlags c_STATISTICS{
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+	};
+	constexpr uint32_t c_STATISTICS_PER_QUERY{ 2 };
+}  // namespace
+
+void GpuProfiler::init(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const uint32_t queueFamilyIndex,
+	const uint32_t framesInFlight,
+	const bool pipelineStatistics
+) {
+	m_Device = device;
+
+	uint32_t validBits{ getTimestampValidBits(pDevice, queueFamilyIndex) };
+	if (validBits == 0) {
+		PYX_ENGINE_INFO("[GpuProfiler] no timestamps on this queue family");
+		return;
+	}
+	m_TimestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(pDevice, &props);
+	m_TimestampPeriod = props.limits.timestampPeriod;
+	m_StatisticsFlags = pipelineStatistics ? c_STATISTICS : 0;
+
+	VkQueryPoolCreateInfo timestampPoolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = c_MAX_SCOPES * 2,
+	};
+	VkQueryPoolCreateInfo statisticsPoolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+		.queryCount = c_MAX_SCOPES,
+		.pipelineStatistics = m_StatisticsFlags,
+	};
+
+	m_Frames.resize(framesInFlight);
+	for (auto& frame : m_Frames) {
+		VK_CHECK(vkCreateQueryPool(
+			device, &timestampPoolCreateInfo, nullptr, &frame.timestamps
+		));
+		if (m_StatisticsFlags != 0) {
+			VK_CHECK(vkCreateQueryPool(
+				device, &statisticsPoolCreateInfo, nullptr, &frame.statistics
+			));
+		}
+		frame.scopes.reserve(c_MAX_SCOPES);
+	}
+	m_Results.reserve(c_MAX_SCOPES);
+}
+
+void GpuProfiler::shutdown() {
+	for (const auto& frame : m_Frames) {
+		vkDestroyQueryPool(m_Device, frame.timestamps, nullptr);
+		vkDestroyQueryPool(m_Device, frame.statistics, nullptr);
+	}
+	m_Frames.clear();
+}
+
+void GpuProfiler::beginFrame(
+	const VkCommandBuffer cmdBuffer, const uint32_t frameIndex
+) {
+	m_FrameIndex = frameIndex;
+	if (m_Frames.empty()) {
+		return;
+	}
+
+	FrameQueries& frame{ m_Frames[frameIndex] };
+	if (!frame.scopes.empty()) {
+		readResults(frame);
+	}
+	frame.scopes.clear();
+	frame.statisticsCount = 0;
+
+	vkCmdResetQueryPool(cmdBuffer, frame.timestamps, 0, c_MAX_SCOPES * 2);
+	if (frame.statistics != VK_NULL_HANDLE) {
+		vkCmdResetQueryPool(cmdBuffer, frame.statistics, 0, c_MAX_SCOPES);
+	}
+}
+
+uint32_t GpuProfiler::beginScope(
+	const VkCommandBuffer cmdBuffer, const char* name, const bool statistics
+) {
+	if (m_Frames.empty()) {
+		return UINT32_MAX;
+	}
+	FrameQueries& frame{ m_Frames[m_FrameIndex] };
+	if (frame.scopes.size() >= c_MAX_SCOPES) {
+		PYX_ENGINE_WARNING(
+			"[GpuProfiler] more than {0} scopes, {1} is not timed",
+			c_MAX_SCOPES,
+			name
+		);
+		return UINT32_MAX;
+	}
+
+	uint32_t scope{ (uint32_t)frame.scopes.size() };
+	frame.scopes.emplace_back(Scope{
+		.name = name,
+		.statisticsQuery = UINT32_MAX,
+	});
+
+	vkCmdWriteTimestamp2(
+		cmdBuffer,
+		VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+		frame.timestamps,
+		scope * 2
+	);
+	if (statistics && frame.statistics != VK_NULL_HANDLE) {
+		PYX_ENGINE_ASSERT_WARNING(!m_StatisticsOpen);
+
+		frame.scopes.back().statisticsQuery = frame.statisticsCount++;
+		vkCmdBeginQuery(
+			cmdBuffer,
+			frame.statistics,
+			frame.scopes.back().statisticsQuery,
+			0
+		);
+		m_StatisticsOpen = true;
+	}
+
+	return scope;
+}
+
+void GpuProfiler::endScope(
+	const VkCommandBuffer cmdBuffer, const uint32_t scope
+) {
+	if (scope == UINT32_MAX) {
+		return;
+	}
+	FrameQueries& frame{ m_Frames[m_FrameIndex] };
+
+	if (uint32_t query{ frame.scopes[scope].statisticsQuery };
+		query != UINT32_MAX) {
+		vkCmdEndQuery(cmdBuffer, frame.statistics, query);
+		m_StatisticsOpen = false;
+	}
+	vkCmdWriteTimestamp2(
+		cmdBuffer,
+		VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		frame.timestamps,
+		scope * 2 + 1
+	);
+}
+
+VkQueryPipelineStatisticFlags GpuProfiler::getInheritedStatistics() const {
+	return m_StatisticsOpen ? m_StatisticsFlags : 0;
+}
+
+void GpuProfiler::readResults(FrameQueries& frame) {
+	uint32_t scopeCount{ (uint32_t)frame.scopes.size() };
+
+	// the frame's fence has signalled, every query is available
+	std::vector<uint64_t> ticks((size_t)scopeCount * 2);
+	VkResult res{ vkGetQueryPoolResults(
+		m_Device,
+		frame.timestamps,
+		0,
+		scopeCount * 2,
+		ticks.size() * sizeof(uint64_t),
+		ticks.data(),
+		sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT
+	) };
+	if (res != VK_SUCCESS) {
+		return;
+	}
+
+	std::vector<uint64_t> statistics(
+		(size_t)frame.statisticsCount * c_STATISTICS_PER_QUERY
+	);
+	if (frame.statisticsCount != 0) {
+		res = vkGetQueryPoolResults(
+			m_Device,
+			frame.statistics,
+			0,
+			frame.statisticsCount,
+			statistics.size() * sizeof(uint64_t),
+			statistics.data(),
+			c_STATISTICS_PER_QUERY * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT
+		);
+		if (res != VK_SUCCESS) {
+			statistics.assign(statistics.size(), 0);
+		}
+	}
+
+	m_Results.clear();
+	for (uint32_t i{}; i < scopeCount; i++) {
+		const Scope& scope{ frame.scopes[i] };
+		// masked so a counter wrapping between the pair still subtracts
+		uint64_t elapsed{ (ticks[i * 2 + 1] - ticks[i * 2]) & m_TimestampMask
+		};
+
+		GpuScopeResult result{
+			.name = scope.name,
+			.milliseconds = (double)elapsed * m_TimestampPeriod / 1e6,
+		};
+		if (scope.statisticsQuery != UINT32_MAX) {
+			size_t first{ (size_t)scope.statisticsQuery *
+						  c_STATISTICS_PER_QUERY };
+			result.vertexInvocations = statistics[first];
+			result.fragmentInvocations = statistics[first + 1];
+		}
+		m_Results.emplace_back(result);
+	}
+}
+
+GpuScope::GpuScope(
+	GpuProfiler& profiler,
+	const VkCommandBuffer cmdBuffer,
+	const char* name,
+	const bool statistics
+)
+	: m_Profiler{ profiler }
+	, m_CmdBuffer{ cmdBuffer }
+	, m_Scope{ profiler.beginScope(cmdBuffer, name, statistics) } {}
+
+GpuScope::~GpuScope() {
+	m_Profiler.endScope(m_CmdBuffer, m_Scope);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct GpuScopeResult {
+	const char* name;
+	double milliseconds;
+	// 0 for scopes without pipeline statistics
+	uint64_t vertexInvocations;
+	uint64_t fragmentInvocations;
+};
+
+// named gpu scopes timed with timestamp pairs, optionally counting shader
+// invocations with pipeline statistics queries. every frame in flight has
+// its own query pools, a frame's results are read back when its slot comes
+// round again and its fence has signalled, so reading never stalls
+class GpuProfiler {
+   public:
+	// pipelineStatistics needs the pipelineStatisticsQuery and
+	// inheritedQueries features enabled on the device
+	void init(
+		const VkPhysicalDevice pDevice,
+		const VkDevice device,
+		const uint32_t queueFamilyIndex,
+		const uint32_t framesInFlight,
+		const bool pipelineStatistics
+	);
+	void shutdown();
+
+	// reads the results of the slot's last frame and resets its queries.
+	// call right after beginning the frame's first command buffer, once the
+	// frame's fence has signalled
+	void beginFrame(const VkCommandBuffer cmdBuffer, const uint32_t frameIndex);
+
+	// name has to outlive the frame's results, string literals do. only one
+	// scope with statistics can be open at a time. outside render passes, or
+	// begun and ended in the same subpass
+	uint32_t beginScope(
+		const VkCommandBuffer cmdBuffer,
+		const char* name,
+		const bool statistics = false
+	);
+	void endScope(const VkCommandBuffer cmdBuffer, const uint32_t scope);
+
+	// secondaries executed inside an open statistics scope have to inherit
+	// these through VkCommandBufferInheritanceInfo::pipelineStatistics
+	VkQueryPipelineStatisticFlags getInheritedStatistics() const;
+
+	// of the last frame that was read back, in the order scopes were begun
+	const std::vector<GpuScopeResult>& getResults() const { return m_Results; }
+
+   private:
+	struct Scope {
+		const char* name;
+		// UINT32_MAX without statistics
+		uint32_t statisticsQuery;
+	};
+
+	struct FrameQueries {
+		VkQueryPool timestamps;
+		VkQueryPool statistics;
+		std::vector<Scope> scopes;
+		uint32_t statisticsCount;
+	};
+
+	void readResults(FrameQueries& frame);
+
+	VkDevice m_Device{};
+	// nanoseconds per tick
+	double m_TimestampPeriod{};
+	uint64_t m_TimestampMask{};
+	VkQueryPipelineStatisticFlags m_StatisticsFlags{};
+	bool m_StatisticsOpen{};
+	uint32_t m_FrameIndex{};
+
+	std::vector<FrameQueries> m_Frames;
+	std::vector<GpuScopeResult> m_Results;
+};
+
+// a scope for as long as it lives
+class GpuScope {
+   public:
+	GpuScope(
+		GpuProfiler& profiler,
+		const VkCommandBuffer cmdBuffer,
+		const char* name,
+		const bool statistics = false
+	);
+	~GpuScope();
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+
+   private:
+	GpuProfiler& m_Profiler;
+	VkCommandBuffer m_CmdBuffer;
+	uint32_t m_Scope;
+};
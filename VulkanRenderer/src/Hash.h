@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <cstring>
+#include <stddef.h>
+
+// non cryptographic 64 bit content hash, eight bytes per step
+inline uint64_t hashBytes(const void* data, const size_t size) {
+	constexpr uint64_t c_PRIME0{ 0x9e3779b97f4a7c15 };
+	constexpr uint64_t c_PRIME1{ 0xbf58476d1ce4e5b9 };
+
+	const uint8_t* bytes{ (const uint8_t*)data };
+	uint64_t hash{ size * c_PRIME0 };
+
+	size_t i{};
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word{};
+		memcpy(&word, bytes + i, 8);
+		word *= c_PRIME1;
+		word ^= word >> 31;
+		hash = (hash ^ word) * c_PRIME0;
+	}
+
+	uint64_t tail{};
+	memcpy(&tail, bytes + i, size - i);
+	hash = (hash ^ tail * c_PRIME1) * c_PRIME0;
+
+	hash ^= hash >> 32;
+	hash *= c_PRIME1;
+	hash ^= hash >> 29;
+
+	return hash;
+}
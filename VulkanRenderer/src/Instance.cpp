@@ -3,19 +3,63 @@
 #include "Logger.h"
 #include "Extensions.h"
 #include "Layers.h"
+#include "Trace.h"
 
+#include <array>
+#include <atomic>
 #include <vector>
-#include <string>
 #include <vulkan/vulkan_core.h>
 
 namespace {
+	// validation and performance messages past this many repeats are only
+	// counted, every c_REPEAT_REPORT_INTERVAL-th one reports the count
+	constexpr uint32_t c_MAX_REPEATS{ 4 };
+	constexpr uint32_t c_REPEAT_REPORT_INTERVAL{ 1024 };
+	// ids are hashes, the rare ids sharing a counter share the limit
+	constexpr uint32_t c_REPEAT_COUNTERS{ 1024 };
+	std::array<std::atomic<uint32_t>, c_REPEAT_COUNTERS> s_RepeatCounts{};
+
 	VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
 		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
 		VkDebugUtilsMessageTypeFlagsEXT messageType,
 		const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
 		void* pUserData
 	) {
-		std::string msgIntro{ "[Validation Layer]" };
+		// called from whichever thread made the call, the counters are
+		// atomic so recording threads do not serialize here. errors are
+		// never held back, every one of them is a real failure
+		constexpr VkDebugUtilsMessageTypeFlagsEXT limitedTypes{
+			VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+			VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT
+		};
+		if ((messageType & limitedTypes) != 0 &&
+			messageSeverity < VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) {
+			uint32_t counter{ (uint32_t)pCallbackData->messageIdNumber %
+							  c_REPEAT_COUNTERS };
+			uint32_t count{ s_RepeatCounts[counter].fetch_add(
+								1, std::memory_order_relaxed
+							) +
+							1 };
+			const char* idName{ pCallbackData->pMessageIdName != nullptr
+									? pCallbackData->pMessageIdName
+									: "message" };
+			if (count == c_MAX_REPEATS + 1) {
+				PYX_ENGINE_WARNING(
+					"[Validation Layer] {0} repeats, further ones are counted",
+					idName
+				);
+			}
+			if (count > c_MAX_REPEATS) {
+				if (count % c_REPEAT_REPORT_INTERVAL == 0) {
+					PYX_ENGINE_WARNING(
+						"[Validation Layer] {0} seen {1} times", idName, count
+					);
+				}
+				return VK_FALSE;
+			}
+		}
+
+		constexpr const char* msgIntro{ "[Validation Layer]" };
 		switch (messageSeverity) {
 			case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
 				PYX_ENGINE_INFO("{0} {1}", msgIntro, pCallbackData->pMessage);
@@ -40,7 +84,11 @@ namespace {
 
 	constexpr VkDebugUtilsMessengerCreateInfoEXT c_DebugMessengerInfo{
 		.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT,
-		.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+		// verbose messages are not even produced when trace logs compile out
+		.messageSeverity =
+			(PYX_LOG_LEVEL <= SPDLOG_LEVEL_TRACE
+				 ? VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT
+				 : 0u) |
 			VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
 			VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT,
 		.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
@@ -52,10 +100,12 @@ namespace {
 }  // namespace
 
 InstanceObjects createInstance(SDL_Window* window) {
+	PYX_TRACE_FUNCTION();
+
 	std::vector<const char*> requiredExtensions{
 		VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME
 	};
-	{
+	if (window != nullptr) {
 		std::optional<std::vector<const char*>> surfaceExtensions{
 			getRequiredSurfaceExtensions(window)
 		};
@@ -10,6 +10,7 @@ struct InstanceObjects {
 	VkDebugUtilsMessengerEXT debugMessenger;
 };
 
+// without a window no surface extensions are enabled, for rendering headless
 InstanceObjects createInstance(SDL_Window* window);
 
 void deleteInstance(
@@ -0,0 +1,204 @@
+#include "LayoutCache.h"
+#include "Logger.h"
+#include "Hash.h"
+
+#include <algorithm>
+
+void LayoutCache::init(const VkDevice device) { m_Device = device; }
+
+void LayoutCache::setGlobalSetLayout(
+	const VkDescriptorSetLayout layout,
+	const std::vector<ReflectedBinding>& bindings
+) {
+	PYX_ENGINE_ASSERT_WARNING(m_PipelineLayouts.empty());
+	m_GlobalSetLayout = layout;
+	m_GlobalBindings = bindings;
+}
+
+void LayoutCache::shutdown() {
+	for (const auto& entry : m_PipelineLayouts) {
+		vkDestroyPipelineLayout(m_Device, entry.second, nullptr);
+	}
+	for (const auto& entry : m_SetLayouts) {
+		vkDestroyDescriptorSetLayout(m_Device, entry.second, nullptr);
+	}
+	m_PipelineLayouts.clear();
+	m_SetLayouts.clear();
+}
+
+VkDescriptorSetLayout
+	LayoutCache::getSetLayout(const std::vector<ReflectedBinding>& bindings) {
+	auto existing{ m_SetLayouts.find(bindings) };
+	if (existing != m_SetLayouts.end()) {
+		return existing->second;
+	}
+
+	std::vector<VkDescriptorSetLayoutBinding> layoutBindings;
+	layoutBindings.reserve(bindings.size());
+	for (const auto& binding : bindings) {
+		if (binding.count == 0) {
+			PYX_ENGINE_ERROR(
+				"[Layouts] set {0} binding {1} is runtime sized and needs a "
+				"layout with an explicit descriptor count",
+				binding.set,
+				binding.binding
+			);
+			return VK_NULL_HANDLE;
+		}
+		layoutBindings.emplace_back(VkDescriptorSetLayoutBinding{
+			.binding = binding.binding,
+			.descriptorType = binding.type,
+			.descriptorCount = binding.count,
+			.stageFlags = binding.stages,
+		});
+	}
+
+	VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = (uint32_t)layoutBindings.size(),
+		.pBindings = layoutBindings.data(),
+	};
+
+	VkDescriptorSetLayout setLayout{};
+	VK_CHECK(vkCreateDescriptorSetLayout(
+		m_Device, &setLayoutCreateInfo, nullptr, &setLayout
+	));
+	m_SetLayouts[bindings] = setLayout;
+
+	return setLayout;
+}
+
+VkPipelineLayout LayoutCache::getPipelineLayout(
+	const std::vector<const ShaderReflection*>& stages
+) {
+	std::optional<std::vector<ReflectedBinding>> bindings{
+		mergeShaderBindings(stages)
+	};
+	if (!bindings.has_value()) {
+		return VK_NULL_HANDLE;
+	}
+
+	for (const auto* stage : stages) {
+		if (stage->pushConstantSize > c_MAX_PUSH_CONSTANT_SIZE) {
+			PYX_ENGINE_ERROR(
+				"[Layouts] {0} bytes of push constants, at most {1} fit",
+				stage->pushConstantSize,
+				c_MAX_PUSH_CONSTANT_SIZE
+			);
+			return VK_NULL_HANDLE;
+		}
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts;
+	if (m_GlobalSetLayout != VK_NULL_HANDLE) {
+		setLayouts.emplace_back(m_GlobalSetLayout);
+	}
+
+	// merged bindings are sorted by set, sets without bindings get an empty
+	// layout so the indices line up
+	auto setBegin{ bindings->begin() };
+	while (setBegin != bindings->end()) {
+		uint32_t set{ setBegin->set };
+		auto setEnd{ std::find_if(
+			setBegin,
+			bindings->end(),
+			[set](const ReflectedBinding& binding) {
+				return binding.set != set;
+			}
+		) };
+
+		if (set == 0 && m_GlobalSetLayout != VK_NULL_HANDLE) {
+			for (auto binding{ setBegin }; binding != setEnd; binding++) {
+				if (!matchesGlobalSet(*binding)) {
+					return VK_NULL_HANDLE;
+				}
+			}
+			setBegin = setEnd;
+			continue;
+		}
+
+		while (setLayouts.size() < set) {
+			setLayouts.emplace_back(getSetLayout({}));
+		}
+		VkDescriptorSetLayout setLayout{
+			getSetLayout(std::vector<ReflectedBinding>(setBegin, setEnd))
+		};
+		if (setLayout == VK_NULL_HANDLE) {
+			return VK_NULL_HANDLE;
+		}
+		setLayouts.emplace_back(setLayout);
+
+		setBegin = setEnd;
+	}
+
+	auto existing{ m_PipelineLayouts.find(setLayouts) };
+	if (existing != m_PipelineLayouts.end()) {
+		return existing->second;
+	}
+
+	VkPushConstantRange pushConstantRange{
+		.stageFlags = VK_SHADER_STAGE_ALL,
+		.offset = 0,
+		.size = c_MAX_PUSH_CONSTANT_SIZE,
+	};
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.setLayoutCount = (uint32_t)setLayouts.size(),
+		.pSetLayouts = setLayouts.data(),
+		.pushConstantRangeCount = 1,
+		.pPushConstantRanges = &pushConstantRange,
+	};
+
+	VkPipelineLayout pipelineLayout{};
+	VK_CHECK(vkCreatePipelineLayout(
+		m_Device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout
+	));
+	m_PipelineLayouts[setLayouts] = pipelineLayout;
+
+	return pipelineLayout;
+}
+
+bool LayoutCache::matchesGlobalSet(const ReflectedBinding& binding) const {
+	auto global{ std::ranges::find_if(
+		m_GlobalBindings,
+		[&](const ReflectedBinding& other) {
+			return other.binding == binding.binding;
+		}
+	) };
+
+	// runtime sized arrays take whatever the global set provides
+	if (global == m_GlobalBindings.end() || global->type != binding.type ||
+		global->count < binding.count) {
+		PYX_ENGINE_ERROR(
+			"[Layouts] set 0 binding {0} does not match the global set",
+			binding.binding
+		);
+		return false;
+	}
+
+	return true;
+}
+
+size_t LayoutCache::SetLayoutKeyHash::operator()(
+	const std::vector<ReflectedBinding>& key
+) const {
+	uint64_t hash{ 0 };
+	for (const auto& binding : key) {
+		uint32_t fields[]{
+			binding.binding,
+			(uint32_t)binding.type,
+			binding.count,
+			binding.stages,
+		};
+		hash = hash * 31 + hashBytes(fields, sizeof(fields));
+	}
+
+	return hash;
+}
+
+size_t LayoutCache::PipelineLayoutKeyHash::operator()(
+	const std::vector<VkDescriptorSetLayout>& key
+) const {
+	return hashBytes(key.data(), key.size() * sizeof(VkDescriptorSetLayout));
+}
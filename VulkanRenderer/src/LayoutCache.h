@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "ShaderReflection.h"
+
+// the guaranteed minimum of maxPushConstantsSize. every pipeline layout gets
+// the same range so bound sets stay valid when switching pipelines
+constexpr uint32_t c_MAX_PUSH_CONSTANT_SIZE{ 128 };
+
+// descriptor set and pipeline layouts built from shader reflection. equal
+// layouts resolve to the same handle so pipelines sharing an interface stay
+// layout compatible and bound descriptor sets survive pipeline switches.
+class LayoutCache {
+   public:
+	void init(const VkDevice device);
+	void shutdown();
+
+	// placed at set 0 of every pipeline layout, reflected set 0 bindings are
+	// checked against it instead of getting their own layout. the layout is
+	// owned by the caller
+	void setGlobalSetLayout(
+		const VkDescriptorSetLayout layout,
+		const std::vector<ReflectedBinding>& bindings
+	);
+
+	// bindings of a single set
+	VkDescriptorSetLayout
+		getSetLayout(const std::vector<ReflectedBinding>& bindings);
+	// null when the stages disagree about a binding or do not fit the global
+	// set and push constant range
+	VkPipelineLayout
+		getPipelineLayout(const std::vector<const ShaderReflection*>& stages);
+
+   private:
+	struct SetLayoutKeyHash {
+		size_t operator()(const std::vector<ReflectedBinding>& key) const;
+	};
+
+	struct PipelineLayoutKeyHash {
+		size_t operator()(const std::vector<VkDescriptorSetLayout>& key) const;
+	};
+
+	bool matchesGlobalSet(const ReflectedBinding& binding) const;
+
+	VkDevice m_Device{};
+	VkDescriptorSetLayout m_GlobalSetLayout{};
+	std::vector<ReflectedBinding> m_GlobalBindings;
+	std::unordered_map<
+		std::vector<ReflectedBinding>,
+		VkDescriptorSetLayout,
+		SetLayoutKeyHash>
+		m_SetLayouts;
+	std::unordered_map<
+		std::vector<VkDescriptorSetLayout>,
+		VkPipelineLayout,
+		PipelineLayoutKeyHash>
+		m_PipelineLayouts;
+};
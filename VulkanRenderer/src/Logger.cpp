@@ -4,22 +4,255 @@
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include "assert.h"
 
 namespace {
+	// a power of two, about 512 KiB of messages
+	constexpr uint64_t c_QUEUE_SIZE{ 512 };
+	// waking the writer for every message costs a syscall, it looks for new
+	// ones this often and is only woken for errors or a filling queue
+	constexpr std::chrono::milliseconds c_WRITE_INTERVAL{ 2 };
+
+	struct QueuedMessage {
+		// the position this slot is written at next when it equals the
+		// enqueue position, readable when it is one past it
+		std::atomic<uint64_t> sequence;
+		spdlog::log_clock::time_point time;
+		spdlog::level::level_enum level;
+		uint32_t length;
+		char text[Logger::c_MAX_MESSAGE_LENGTH];
+	};
+
+	// bounded multi producer queue with a single consumer at a time, the
+	// writer thread or a thread draining it on a fatal path
+	struct LogQueue {
+		std::array<QueuedMessage, c_QUEUE_SIZE> messages;
+		std::atomic<uint64_t> enqueuePos;
+		// only written by the consumer, producers read it to see the queue
+		// fill
+		std::atomic<uint64_t> dequeuePos;
+		// held by the consumer
+		std::mutex printMutex;
+
+		std::atomic<uint32_t> dropped;
+		std::mutex wakeMutex;
+		std::condition_variable wake;
+		bool stopping;
+		std::thread writer;
+	};
+
+	// the ones a crashing process raises, all of them are portable
+	constexpr int c_CRASH_SIGNALS[]{ SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+
 	std::shared_ptr<spdlog::logger> s_EngineLogger{ nullptr };
-};
+	LogQueue* s_Queue{ nullptr };
+	std::atomic<bool> s_Running{ false };
+	std::terminate_handler s_PreviousTerminate{ nullptr };
+
+	// the position written, UINT64_MAX when the queue is full
+	uint64_t pushMessage(
+		const spdlog::level::level_enum level, const std::string_view message
+	);
+	// the caller holds printMutex
+	bool printMessage();
+	// prints everything queued and flushes the console. a crashing thread
+	// does not wait, the writer may never let go of the queue
+	void drainQueue(const bool wait);
+	void writerLoop();
+	void onTerminate();
+	void onCrashSignal(const int signal);
+}  // namespace
 
 void Logger::init() {
 	spdlog::set_level(spdlog::level::trace);
 	spdlog::set_pattern("[%H:%M:%S %z] [%n] [%^---%l---%$] %v");
 
 	s_EngineLogger = spdlog::stdout_color_mt("PyxEngine");
-	s_EngineLogger->enable_backtrace(32);
+	// the writer flushes after errors so they are not left in the buffer
+	s_EngineLogger->flush_on(spdlog::level::err);
+
+	s_Queue = new LogQueue{};
+	for (uint64_t i{}; i < c_QUEUE_SIZE; i++) {
+		s_Queue->messages[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	s_Queue->writer = std::thread(writerLoop);
+	s_Running.store(true, std::memory_order_release);
+
+	// the last messages before a crash are the ones that explain it
+	s_PreviousTerminate = std::set_terminate(onTerminate);
+	for (int signal : c_CRASH_SIGNALS) {
+		std::signal(signal, onCrashSignal);
+	}
 }
-std::shared_ptr<spdlog::logger> Logger::getLogger() {
+
+void Logger::shutdown() {
+	if (!s_Running.exchange(false)) {
+		return;
+	}
+	std::set_terminate(s_PreviousTerminate);
+	for (int signal : c_CRASH_SIGNALS) {
+		std::signal(signal, SIG_DFL);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_Queue->wakeMutex);
+		s_Queue->stopping = true;
+	}
+	s_Queue->wake.notify_one();
+	s_Queue->writer.join();
+
+	// whatever was pushed while the writer stopped
+	drainQueue(true);
+
+	delete s_Queue;
+	s_Queue = nullptr;
+}
+
+spdlog::logger& Logger::getLogger() {
 	assert(s_EngineLogger != nullptr);
 
-	return s_EngineLogger;
+	return *s_EngineLogger;
+}
+
+void Logger::write(
+	const spdlog::level::level_enum level, std::string_view message
+) {
+	if (!s_Running.load(std::memory_order_acquire)) {
+		getLogger().log(level, message);
+		return;
+	}
+
+	uint64_t pos{ pushMessage(level, message) };
+	if (pos == UINT64_MAX) {
+		s_Queue->dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	// a wakeup missed while the writer is busy only delays it an interval
+	if (level >= spdlog::level::err ||
+		pos - s_Queue->dequeuePos.load(std::memory_order_relaxed) >=
+			c_QUEUE_SIZE / 2) {
+		s_Queue->wake.notify_one();
+	}
 }
+
+namespace {
+	uint64_t pushMessage(
+		const spdlog::level::level_enum level, const std::string_view message
+	) {
+		uint64_t pos{ s_Queue->enqueuePos.load(std::memory_order_relaxed) };
+		QueuedMessage* slot{};
+		while (true) {
+			slot = &s_Queue->messages[pos & (c_QUEUE_SIZE - 1)];
+			int64_t lag{
+				(int64_t)slot->sequence.load(std::memory_order_acquire) -
+				(int64_t)pos
+			};
+			if (lag == 0) {
+				if (s_Queue->enqueuePos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed
+					)) {
+					break;
+				}
+			} else if (lag < 0) {
+				// the writer has not printed the slot from a lap ago yet
+				return UINT64_MAX;
+			} else {
+				pos = s_Queue->enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->time = spdlog::log_clock::now();
+		slot->level = level;
+		slot->length = (uint32_t)message.size();
+		std::memcpy(slot->text, message.data(), message.size());
+		slot->sequence.store(pos + 1, std::memory_order_release);
+
+		return pos;
+	}
+
+	bool printMessage() {
+		uint64_t pos{ s_Queue->dequeuePos.load(std::memory_order_relaxed) };
+		QueuedMessage& slot{ s_Queue->messages[pos & (c_QUEUE_SIZE - 1)] };
+		if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+			return false;
+		}
+
+		s_EngineLogger->log(
+			slot.time,
+			spdlog::source_loc{},
+			slot.level,
+			std::string_view{ slot.text, slot.length }
+		);
+		slot.sequence.store(pos + c_QUEUE_SIZE, std::memory_order_release);
+		s_Queue->dequeuePos.store(pos + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	void drainQueue(const bool wait) {
+		std::unique_lock<std::mutex> lock(s_Queue->printMutex, std::defer_lock);
+		if (wait) {
+			lock.lock();
+		} else if (!lock.try_lock()) {
+			return;
+		}
+
+		while (printMessage()) {
+		}
+		s_EngineLogger->flush();
+	}
+
+	void writerLoop() {
+		while (true) {
+			{
+				std::lock_guard<std::mutex> lock(s_Queue->printMutex);
+				while (printMessage()) {
+				}
+			}
+			if (uint32_t dropped{ s_Queue->dropped.exchange(0) };
+				dropped != 0) {
+				s_EngineLogger->warn(
+					"[Logger] queue full, dropped {0} messages", dropped
+				);
+			}
+
+			std::unique_lock<std::mutex> lock(s_Queue->wakeMutex);
+			if (s_Queue->stopping) {
+				return;
+			}
+			s_Queue->wake.wait_for(lock, c_WRITE_INTERVAL);
+		}
+	}
+
+	void onTerminate() {
+		if (s_Running.load(std::memory_order_acquire)) {
+			drainQueue(false);
+		}
+
+		if (s_PreviousTerminate != nullptr) {
+			s_PreviousTerminate();
+		}
+		std::abort();
+	}
+
+	void onCrashSignal(const int signal) {
+		// not async signal safe, but the process is going down either way
+		if (s_Running.load(std::memory_order_acquire)) {
+			drainQueue(false);
+		}
+
+		// the default action produces the core dump and exit status
+		std::signal(signal, SIG_DFL);
+		std::raise(signal);
+	}
+}  // namespace
@@ -1,19 +1,71 @@
 #pragma once
 #include <spdlog/spdlog.h>
 
+#include <string_view>
+
+// levels below the configured one compile out, arguments included
+#if defined(LOG_LEVEL_TRACE)
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_TRACE
+#elif defined(LOG_LEVEL_DEBUG)
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_DEBUG
+#elif defined(LOG_LEVEL_INFO)
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_INFO
+#elif defined(LOG_LEVEL_WARNING)
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_WARN
+#elif defined(LOG_LEVEL_ERROR)
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_ERROR
+#else
+	#define PYX_LOG_LEVEL SPDLOG_LEVEL_INFO
+#endif
+
+// messages are formatted on the calling thread into a lock-free queue and
+// printed by a writer thread, so logging never waits on the console. the
+// queue is drained on shutdown, std::terminate and crash signals, so the
+// last messages before a crash still reach the console
 namespace Logger {
+	// longer messages are cut
+	constexpr size_t c_MAX_MESSAGE_LENGTH{ 1024 };
+
 	void init();
+	// prints what is still queued and stops the writer thread, later
+	// messages are printed synchronously
+	void shutdown();
+
+	// the logger the writer thread prints through, synchronous
+	spdlog::logger& getLogger();
 
-	std::shared_ptr<spdlog::logger> getLogger();
+	// dropped rather than waited for when the queue is full
+	void write(const spdlog::level::level_enum level, std::string_view message);
+
+	template <typename... Args>
+	void log(
+		const spdlog::level::level_enum level,
+		spdlog::format_string_t<Args...> format,
+		Args&&... args
+	) {
+		char message[c_MAX_MESSAGE_LENGTH];
+		auto result{ spdlog::fmt_lib::format_to_n(
+			message, sizeof(message), format, std::forward<Args>(args)...
+		) };
+		write(level, std::string_view{ message, result.out });
+	}
 }  // namespace Logger
 
-#define PYX_ENGINE_ERROR(...)                \
-	Logger::getLogger()->error(__VA_ARGS__); \
-	Logger::getLogger()->dump_backtrace()
-#define PYX_ENGINE_WARNING(...) Logger::getLogger()->warn(__VA_ARGS__)
-#define PYX_ENGINE_INFO(...) Logger::getLogger()->info(__VA_ARGS__)
-#define PYX_ENGINE_TRACE(...) Logger::getLogger()->trace(__VA_ARGS__)
-#define PYX_ENGINE_DEBUG(...) Logger::getLogger()->debug(__VA_ARGS__)
+#define PYX_ENGINE_LOG(logLevel, ...)                \
+	do {                                             \
+		if constexpr (logLevel >= PYX_LOG_LEVEL) {   \
+			Logger::log(                             \
+				(spdlog::level::level_enum)logLevel, \
+				__VA_ARGS__                          \
+			);                                       \
+		}                                            \
+	} while (0)
+
+#define PYX_ENGINE_ERROR(...) PYX_ENGINE_LOG(SPDLOG_LEVEL_ERROR, __VA_ARGS__)
+#define PYX_ENGINE_WARNING(...) PYX_ENGINE_LOG(SPDLOG_LEVEL_WARN, __VA_ARGS__)
+#define PYX_ENGINE_INFO(...) PYX_ENGINE_LOG(SPDLOG_LEVEL_INFO, __VA_ARGS__)
+#define PYX_ENGINE_TRACE(...) PYX_ENGINE_LOG(SPDLOG_LEVEL_TRACE, __VA_ARGS__)
+#define PYX_ENGINE_DEBUG(...) PYX_ENGINE_LOG(SPDLOG_LEVEL_DEBUG, __VA_ARGS__)
 
 #define PYX_ENGINE_ASSERT_ERROR(x)                       \
 	{                                                    \
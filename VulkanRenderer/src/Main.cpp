@@ -1,12 +1,67 @@
 #include "Renderer.h"
+#include "Benchmark.h"
+#include "Trace.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_vulkan.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
 
 constexpr int c_WINDOW_WIDTH{ 1920 / 2 };
 constexpr int c_WINDOW_HEIGHT{ 1080 / 2 };
+constexpr std::array<std::string_view, 5> c_IMAGE_EXTENSIONS{
+	".png", ".jpg", ".jpeg", ".tga", ".bmp"
+};
+constexpr uint32_t c_BENCH_WARMUP_FRAMES{ 100 };
+constexpr uint32_t c_BENCH_FRAMES{ 1000 };
+constexpr const char* c_BENCH_OUTPUT_PATH{ "benchmark.json" };
+constexpr const char* c_TRACE_OUTPUT_PATH{ "trace.json" };
+
+namespace {
+	// textures by extension, meshes otherwise
+	void loadAssets(const int firstArg, const int argc, char* argv[]);
+	// --warmup <frames>, --frames <frames>, --seconds <seconds> and
+	// --out <path> from firstArg on, returns the first argument after them
+	int parseBenchmarkArgs(
+		const int firstArg, const int argc, char* argv[], BenchmarkDesc& desc
+	);
+}  // namespace
 
 int main(int argc, char* argv[]) {
+	// --headless <frames> renders that many frames offscreen, without a
+	// window, then exits
+	if (argc > 2 && std::string_view{ argv[1] } == "--headless") {
+		VulkanRenderer::init(nullptr, c_WINDOW_WIDTH, c_WINDOW_HEIGHT);
+		loadAssets(3, argc, argv);
+		VulkanRenderer::renderFrames(
+			(uint32_t)std::strtoul(argv[2], nullptr, 10)
+		);
+		VulkanRenderer::cleanup();
+
+		return 0;
+	}
+
+	// --bench [options] renders headless, so it runs on software devices
+	// too, and writes frame time percentiles as json
+	if (argc > 1 && std::string_view{ argv[1] } == "--bench") {
+		BenchmarkDesc desc{
+			.warmupFrames = c_BENCH_WARMUP_FRAMES,
+			.frameCount = c_BENCH_FRAMES,
+			.outputPath = c_BENCH_OUTPUT_PATH,
+		};
+		int firstAsset{ parseBenchmarkArgs(2, argc, argv, desc) };
+
+		VulkanRenderer::init(nullptr, c_WINDOW_WIDTH, c_WINDOW_HEIGHT);
+		loadAssets(firstAsset, argc, argv);
+		bool written{ runBenchmark(desc) };
+		VulkanRenderer::cleanup();
+
+		return written ? 0 : 1;
+	}
+
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
 		SPDLOG_ERROR("couldnt initialize SDL2: {0}", SDL_GetError());
 	}
@@ -20,6 +75,7 @@ int main(int argc, char* argv[]) {
 	) };
 
 	VulkanRenderer::init(window);
+	loadAssets(1, argc, argv);
 
 	SDL_Event event{};
 	bool running{ true };
@@ -30,6 +86,14 @@ int main(int argc, char* argv[]) {
 					if (event.key.keysym.scancode == SDL_SCANCODE_TAB) {
 						running = false;
 					}
+					// starts a cpu trace, the next press writes it
+					if (event.key.keysym.scancode == SDL_SCANCODE_F12) {
+						if (Trace::isCapturing()) {
+							Trace::endCapture(c_TRACE_OUTPUT_PATH);
+						} else {
+							Trace::beginCapture();
+						}
+					}
 					break;
 			}
 		}
@@ -43,3 +107,41 @@ int main(int argc, char* argv[]) {
 
 	return 0;
 }
+
+namespace {
+	void loadAssets(const int firstArg, const int argc, char* argv[]) {
+		for (int i{ firstArg }; i < argc; i++) {
+			std::filesystem::path path{ argv[i] };
+			if (std::ranges::find(
+					c_IMAGE_EXTENSIONS, path.extension().string()
+				) != c_IMAGE_EXTENSIONS.end()) {
+				VulkanRenderer::loadTexture(argv[i]);
+			} else {
+				VulkanRenderer::loadMesh(argv[i]);
+			}
+		}
+	}
+
+	int parseBenchmarkArgs(
+		const int firstArg, const int argc, char* argv[], BenchmarkDesc& desc
+	) {
+		int i{ firstArg };
+		for (; i + 1 < argc; i += 2) {
+			std::string_view option{ argv[i] };
+			const char* value{ argv[i + 1] };
+			if (option == "--warmup") {
+				desc.warmupFrames = (uint32_t)std::strtoul(value, nullptr, 10);
+			} else if (option == "--frames") {
+				desc.frameCount = (uint32_t)std::strtoul(value, nullptr, 10);
+			} else if (option == "--seconds") {
+				desc.seconds = std::strtod(value, nullptr);
+			} else if (option == "--out") {
+				desc.outputPath = value;
+			} else {
+				break;
+			}
+		}
+
+		return i;
+	}
+}  // namespace
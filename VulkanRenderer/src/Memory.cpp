@@ -1,25 +1,52 @@
 #include "Memory.h"
+#include "Logger.h"
+
 #include <vulkan/vulkan_core.h>
-#include <iostream>
+#include <array>
+#include <string>
 
 namespace {
-	uint32_t findMemoryTypeIndex(
-		uint32_t disiredProperties,
-		const VkMemoryType requiredMemTypes[],
-		uint32_t memTypeCount,
-		uint32_t allowedMemTypes
-	);
-	VkMemoryAllocateInfo getMemoryAllocInfo(
-		const VkPhysicalDevice pDevice,
-		const VkDevice device,
-		const VkBuffer buffer,
-		const VkMemoryPropertyFlags memoryProps
-	);
+	// blocks are carved into sub-allocations, so each memory type only
+	// touches vkAllocateMemory once per block instead of once per buffer
+	constexpr VkDeviceSize c_MEMORY_BLOCK_SIZE{ 64 * 1024 * 1024 };
+
+	void logStatistics(const char* name, const VmaStatistics& stats);
 }  // namespace
 
-BufferInfo createBuffer(
+VmaAllocator createAllocator(
+	const VkInstance instance,
 	const VkPhysicalDevice pDevice,
 	const VkDevice device,
+	const bool memoryBudget
+) {
+	VmaAllocatorCreateFlags flags{
+		VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT
+	};
+	if (memoryBudget) {
+		flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+	}
+
+	VmaAllocatorCreateInfo allocatorCreateInfo{
+		.flags = flags,
+		.physicalDevice = pDevice,
+		.device = device,
+		.preferredLargeHeapBlockSize = c_MEMORY_BLOCK_SIZE,
+		.instance = instance,
+		.vulkanApiVersion = VK_API_VERSION_1_3,
+	};
+
+	VmaAllocator allocator{};
+	VK_CHECK(vmaCreateAllocator(&allocatorCreateInfo, &allocator));
+
+	return allocator;
+}
+
+void destroyAllocator(VmaAllocator allocator) {
+	vmaDestroyAllocator(allocator);
+}
+
+BufferInfo createBuffer(
+	const VmaAllocator allocator,
 	const size_t size,
 	const VkBufferUsageFlags usage,
 	const VkMemoryPropertyFlags memProps
@@ -30,79 +57,208 @@ BufferInfo createBuffer(
 		.usage = usage,
 		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 	};
+
+	VmaAllocationCreateInfo allocCreateInfo{
+		.usage = VMA_MEMORY_USAGE_UNKNOWN,
+		.requiredFlags = memProps,
+	};
+
 	VkBuffer bufferHandle{};
-	vkCreateBuffer(device, &bufferCreateInfo, nullptr, &bufferHandle);
+	VmaAllocation allocation{};
+	VkResult res{ vmaCreateBuffer(
+		allocator,
+		&bufferCreateInfo,
+		&allocCreateInfo,
+		&bufferHandle,
+		&allocation,
+		nullptr
+	) };
+	if (res != VK_SUCCESS) {
+		PYX_ENGINE_ERROR("could not allocate buffer: {0}", (int)res);
+	}
+
+	BufferInfo buffer{ .handle = bufferHandle, .allocation = allocation };
+
+	return buffer;
+}
 
-	VkMemoryAllocateInfo memAllocInfo{
-		getMemoryAllocInfo(pDevice, device, bufferHandle, memProps)
+MappedBufferInfo createMappedBuffer(
+	const VmaAllocator allocator,
+	const size_t size,
+	const VkBufferUsageFlags usage,
+	const VkMemoryPropertyFlags preferredMemProps
+) {
+	VkBufferCreateInfo bufferCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.size = size,
+		.usage = usage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 	};
-	VkDeviceMemory bufferMemory{};
-	VkResult res{
-		vkAllocateMemory(device, &memAllocInfo, nullptr, &bufferMemory)
+
+	VmaAllocationCreateInfo allocCreateInfo{
+		.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT |
+			VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+		.usage = VMA_MEMORY_USAGE_UNKNOWN,
+		.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+		.preferredFlags = preferredMemProps,
 	};
+
+	VkBuffer bufferHandle{};
+	VmaAllocation allocation{};
+	VmaAllocationInfo allocationInfo{};
+	VkResult res{ vmaCreateBuffer(
+		allocator,
+		&bufferCreateInfo,
+		&allocCreateInfo,
+		&bufferHandle,
+		&allocation,
+		&allocationInfo
+	) };
 	if (res != VK_SUCCESS) {
-		std::cout << "could not allocate vertex buffer" << std::endl;
+		PYX_ENGINE_ERROR("could not allocate mapped buffer: {0}", (int)res);
+		return {};
 	}
 
-	vkBindBufferMemory(device, bufferHandle, bufferMemory, 0);
+	VkMemoryPropertyFlags memProps{};
+	vmaGetAllocationMemoryProperties(allocator, allocation, &memProps);
 
-	BufferInfo buffer{ .handle = bufferHandle, .memory = bufferMemory };
+	MappedBufferInfo mappedBuffer{
+		.buffer = { .handle = bufferHandle, .allocation = allocation },
+		.data = allocationInfo.pMappedData,
+		.memProps = memProps,
+	};
 
-	return buffer;
+	return mappedBuffer;
 }
 
-void destroyBuffer(const VkDevice device, BufferInfo buffer) {
-	vkFreeMemory(device, buffer.memory, nullptr);
-	vkDestroyBuffer(device, buffer.handle, nullptr);
+void destroyBuffer(const VmaAllocator allocator, BufferInfo buffer) {
+	vmaDestroyBuffer(allocator, buffer.handle, buffer.allocation);
 }
 
-namespace {
-	uint32_t findMemoryTypeIndex(
-		uint32_t disiredProperties,
-		const VkMemoryType requiredMemTypes[],
-		uint32_t memTypeCount,
-		uint32_t allowedMemTypes
-	) {
-		uint32_t memTypeIndex{};
-		for (uint32_t i{}; i < memTypeCount; i++) {
-			VkMemoryType memType{ requiredMemTypes[i] };
-
-			if ((allowedMemTypes & (1 << i)) &&
-				(memType.propertyFlags & disiredProperties) ==
-					disiredProperties) {
-				memTypeIndex = i;
-				break;
-			}
+ImageInfo createImage(
+	const VmaAllocator allocator,
+	const VkExtent2D extent,
+	const VkFormat format,
+	const uint32_t mipLevels,
+	const VkImageUsageFlags usage
+) {
+	VkImageCreateInfo imageCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.imageType = VK_IMAGE_TYPE_2D,
+		.format = format,
+		.extent = { extent.width, extent.height, 1 },
+		.mipLevels = mipLevels,
+		.arrayLayers = 1,
+		.samples = VK_SAMPLE_COUNT_1_BIT,
+		.tiling = VK_IMAGE_TILING_OPTIMAL,
+		.usage = usage,
+		.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+	};
+
+	VmaAllocationCreateInfo allocCreateInfo{
+		.usage = VMA_MEMORY_USAGE_UNKNOWN,
+		.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+	};
+
+	VkImage imageHandle{};
+	VmaAllocation allocation{};
+	VkResult res{ vmaCreateImage(
+		allocator,
+		&imageCreateInfo,
+		&allocCreateInfo,
+		&imageHandle,
+		&allocation,
+		nullptr
+	) };
+	if (res != VK_SUCCESS) {
+		PYX_ENGINE_ERROR("could not allocate image: {0}", (int)res);
+		return {};
+	}
+
+	ImageInfo image{ .handle = imageHandle, .allocation = allocation };
+
+	return image;
+}
+
+void destroyImage(const VmaAllocator allocator, ImageInfo image) {
+	vmaDestroyImage(allocator, image.handle, image.allocation);
+}
+
+VkDeviceAddress
+	getBufferDeviceAddress(const VkDevice device, const BufferInfo buffer) {
+	VkBufferDeviceAddressInfo addressInfo{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+		.buffer = buffer.handle,
+	};
+
+	return vkGetBufferDeviceAddress(device, &addressInfo);
+}
+
+MemoryStats getMemoryStats(const VmaAllocator allocator) {
+	VmaTotalStatistics totalStats{};
+	vmaCalculateStatistics(allocator, &totalStats);
+
+	const VmaStatistics& stats{ totalStats.total.statistics };
+	MemoryStats memoryStats{
+		.blockCount = stats.blockCount,
+		.allocationCount = stats.allocationCount,
+		.blockBytes = stats.blockBytes,
+		.allocationBytes = stats.allocationBytes,
+	};
+
+	return memoryStats;
+}
+
+MemoryBudget getDeviceLocalBudget(const VmaAllocator allocator) {
+	const VkPhysicalDeviceMemoryProperties* memProps{};
+	vmaGetMemoryProperties(allocator, &memProps);
+
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+	vmaGetHeapBudgets(allocator, budgets.data());
+
+	MemoryBudget memoryBudget{};
+	for (uint32_t i{}; i < memProps->memoryHeapCount; i++) {
+		if ((memProps->memoryHeaps[i].flags &
+			 VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0) {
+			continue;
 		}
+		memoryBudget.usage += budgets[i].usage;
+		memoryBudget.budget += budgets[i].budget;
+	}
+
+	return memoryBudget;
+}
+
+void logMemoryStats(const VmaAllocator allocator) {
+	const VkPhysicalDeviceMemoryProperties* memProps{};
+	vmaGetMemoryProperties(allocator, &memProps);
+
+	VmaTotalStatistics totalStats{};
+	vmaCalculateStatistics(allocator, &totalStats);
 
-		return memTypeIndex;
+	for (uint32_t i{}; i < memProps->memoryTypeCount; i++) {
+		const VmaStatistics& stats{ totalStats.memoryType[i].statistics };
+		if (stats.blockCount == 0) {
+			continue;
+		}
+
+		std::string name{ "memory type " + std::to_string(i) };
+		logStatistics(name.c_str(), stats);
 	}
+	logStatistics("total", totalStats.total.statistics);
+}
 
-	VkMemoryAllocateInfo getMemoryAllocInfo(
-		const VkPhysicalDevice pDevice,
-		const VkDevice device,
-		const VkBuffer buffer,
-		const VkMemoryPropertyFlags memoryProps
-	) {
-		VkMemoryRequirements memRequirements{};
-		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-		VkPhysicalDeviceMemoryProperties memProps{};
-		vkGetPhysicalDeviceMemoryProperties(pDevice, &memProps);
-
-		uint32_t memTypeIndex{ findMemoryTypeIndex(
-			memoryProps,
-			memProps.memoryTypes,
-			memProps.memoryTypeCount,
-			memRequirements.memoryTypeBits
-		) };
-
-		VkMemoryAllocateInfo memAllocInfo{
-			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-			.allocationSize = memRequirements.size,
-			.memoryTypeIndex = memTypeIndex,
-		};
-
-		return memAllocInfo;
+namespace {
+	void logStatistics(const char* name, const VmaStatistics& stats) {
+		PYX_ENGINE_INFO(
+			"[Memory] {0}: {1} blocks ({2} bytes), {3} allocations ({4} "
+			"bytes)",
+			name,
+			stats.blockCount,
+			stats.blockBytes,
+			stats.allocationCount,
+			stats.allocationBytes
+		);
 	}
 }  // namespace
@@ -2,26 +2,79 @@
 
 #include <stdint.h>
 #include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
 
 struct BufferInfo {
 	VkBuffer handle;
-	VkDeviceMemory memory;
+	VmaAllocation allocation;
 };
 
-BufferInfo createBuffer(
+struct ImageInfo {
+	VkImage handle;
+	VmaAllocation allocation;
+};
+
+struct MappedBufferInfo {
+	BufferInfo buffer;
+	void* data;
+	VkMemoryPropertyFlags memProps;
+};
+
+struct MemoryStats {
+	uint32_t blockCount;
+	uint32_t allocationCount;
+	VkDeviceSize blockBytes;
+	VkDeviceSize allocationBytes;
+};
+
+struct MemoryBudget {
+	VkDeviceSize usage;
+	VkDeviceSize budget;
+};
+
+// memoryBudget when the device was created with VK_EXT_memory_budget
+VmaAllocator createAllocator(
+	const VkInstance instance,
 	const VkPhysicalDevice pDevice,
 	const VkDevice device,
+	const bool memoryBudget
+);
+void destroyAllocator(VmaAllocator allocator);
+
+BufferInfo createBuffer(
+	const VmaAllocator allocator,
 	const size_t size,
 	const VkBufferUsageFlags usage,
 	const VkMemoryPropertyFlags memProps
 );
 
-void destroyBuffer(const VkDevice device, BufferInfo buffer);
-void copyBuffer(
-	const VkDevice device,
-	const uint32_t transferQueueIndex,
-	const VkQueue transferQueue,
-	const VkBuffer srcBuffer,
-	const VkBuffer dstBuffer,
-	const VkDeviceSize size
+// persistently mapped, prefers preferredMemProps but only requires the
+// memory to be host visible
+MappedBufferInfo createMappedBuffer(
+	const VmaAllocator allocator,
+	const size_t size,
+	const VkBufferUsageFlags usage,
+	const VkMemoryPropertyFlags preferredMemProps
 );
+
+void destroyBuffer(const VmaAllocator allocator, BufferInfo buffer);
+
+// 2d, optimal tiling, device local
+ImageInfo createImage(
+	const VmaAllocator allocator,
+	const VkExtent2D extent,
+	const VkFormat format,
+	const uint32_t mipLevels,
+	const VkImageUsageFlags usage
+);
+void destroyImage(const VmaAllocator allocator, ImageInfo image);
+
+// the buffer needs VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+VkDeviceAddress
+	getBufferDeviceAddress(const VkDevice device, const BufferInfo buffer);
+
+MemoryStats getMemoryStats(const VmaAllocator allocator);
+// summed over the device local heaps. the numbers come from the driver with
+// VK_EXT_memory_budget, otherwise vma estimates them from its own allocations
+MemoryBudget getDeviceLocalBudget(const VmaAllocator allocator);
+void logMemoryStats(const VmaAllocator allocator);
@@ -0,0 +1,663 @@
+#include "MeshCodec.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define PYX_CODEC_X86
+	#include <immintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define PYX_TARGET_AVX2 __attribute__((target("avx2")))
+		#define PYX_FORCE_INLINE inline __attribute__((always_inline))
+	#else
+		#include <intrin.h>
+		#define PYX_TARGET_AVX2
+		#define PYX_FORCE_INLINE __forceinline
+	#endif
+#endif
+
+namespace {
+	// bits per byte for each two bit width code of the vertex stream
+	constexpr uint32_t c_VERTEX_WIDTHS[4]{ 0, 2, 4, 8 };
+	// unpacking reads eight bytes at a time and may read this far past the
+	// end of a packed index group
+	constexpr uint32_t c_UNPACK_OVERREAD{ 8 };
+	constexpr uint32_t c_MAX_INDEX_WIDTH{ 32 };
+
+	// data holds exactly the bytes of the group's channels
+	using DecodeVertexGroupFn = void (*)(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	);
+	using DecodeIndexGroupFn = void (*)(
+		const uint32_t* values,
+		uint32_t& previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const VkIndexType indexType
+	);
+
+	uint8_t zigzag8(const uint8_t delta);
+	uint8_t unzigzag8(const uint8_t value);
+	uint32_t zigzag32(const uint32_t delta);
+	uint32_t unzigzag32(const uint32_t value);
+
+	uint32_t getVertexHeaderSize(const uint32_t stride);
+	uint32_t getVertexWidth(const uint8_t* header, const uint32_t channel);
+	// one group of values, least significant bits first
+	void packBits(
+		const uint32_t* values, const uint32_t width, std::vector<uint8_t>& out
+	);
+
+	// one unrolled unpack per width, the shifts are constants
+	template <uint32_t Width>
+	void unpackBits(const uint8_t* data, uint32_t* values) {
+		constexpr uint64_t c_MASK{ (1ull << Width) - 1 };
+		for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i++) {
+			uint64_t word{};
+			memcpy(&word, data + i * Width / 8, sizeof(word));
+			values[i] = (uint32_t)((word >> (i * Width % 8)) & c_MASK);
+		}
+	}
+
+	using UnpackBitsFn = void (*)(const uint8_t* data, uint32_t* values);
+
+	template <size_t... Widths>
+	constexpr std::array<UnpackBitsFn, sizeof...(Widths)> makeUnpackBitsTable(
+		std::index_sequence<Widths...>
+	) {
+		return { &unpackBits<Widths>... };
+	}
+
+	constexpr std::array<UnpackBitsFn, c_MAX_INDEX_WIDTH + 1> c_UNPACK_BITS{
+		makeUnpackBitsTable(std::make_index_sequence<c_MAX_INDEX_WIDTH + 1>{})
+	};
+
+	void decodeVertexGroupScalar(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	);
+	void decodeIndexGroupScalar(
+		const uint32_t* values,
+		uint32_t& previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const VkIndexType indexType
+	);
+
+#ifdef PYX_CODEC_X86
+	// inlined so the avx2 path gets vex encoded copies instead of paying for
+	// switching between sse and avx code
+	PYX_FORCE_INLINE __m128i
+	unpackVertexDeltas(const uint8_t* data, const uint32_t width);
+	PYX_FORCE_INLINE __m128i
+	decodeVertexChannel(const __m128i values, const uint8_t previous);
+	// transposes the channels back into vertices
+	PYX_FORCE_INLINE void storeVertexGroup(
+		const __m128i* channels,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	);
+
+	void decodeVertexGroupSse2(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	);
+	PYX_TARGET_AVX2 void decodeVertexGroupAvx2(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	);
+	void decodeIndexGroupSse2(
+		const uint32_t* values,
+		uint32_t& previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const VkIndexType indexType
+	);
+
+	bool supportsAvx2();
+#endif
+}  // namespace
+
+MeshCodecPath getBestMeshCodecPath() {
+#ifdef PYX_CODEC_X86
+	static const MeshCodecPath s_BestPath{
+		supportsAvx2() ? MeshCodecPath::avx2 : MeshCodecPath::sse2
+	};
+	return s_BestPath;
+#else
+	return MeshCodecPath::scalar;
+#endif
+}
+
+std::vector<uint8_t> encodeVertexStream(
+	const std::span<const uint8_t> vertices, const uint32_t stride
+) {
+	PYX_ENGINE_ASSERT_WARNING(
+		stride % 4 == 0 && stride > 0 && stride <= c_MESH_CODEC_MAX_STRIDE
+	);
+	PYX_ENGINE_ASSERT_WARNING(vertices.size() % stride == 0);
+
+	uint32_t vertexCount{ (uint32_t)(vertices.size() / stride) };
+	uint32_t headerSize{ getVertexHeaderSize(stride) };
+
+	std::vector<uint8_t> encoded;
+	encoded.reserve(vertices.size() + vertices.size() / 16);
+
+	uint8_t previous[c_MESH_CODEC_MAX_STRIDE]{};
+	for (uint32_t first{}; first < vertexCount;
+		 first += c_MESH_CODEC_GROUP_SIZE) {
+		size_t header{ encoded.size() };
+		encoded.resize(encoded.size() + headerSize);
+
+		for (uint32_t channel{}; channel < stride; channel++) {
+			// a partial group repeats its last vertex, which encodes to zero
+			uint32_t values[c_MESH_CODEC_GROUP_SIZE]{};
+			uint32_t maxValue{};
+			for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i++) {
+				uint32_t vertex{ std::min(first + i, vertexCount - 1) };
+				uint8_t value{ vertices[vertex * stride + channel] };
+
+				values[i] = zigzag8((uint8_t)(value - previous[channel]));
+				maxValue = std::max(maxValue, values[i]);
+				previous[channel] = value;
+			}
+
+			uint32_t code{};
+			while (code < 3 && maxValue >= (1u << c_VERTEX_WIDTHS[code])) {
+				code++;
+			}
+			encoded[header + channel / 4] |= code << (channel % 4 * 2);
+			packBits(values, c_VERTEX_WIDTHS[code], encoded);
+		}
+	}
+
+	return encoded;
+}
+
+bool decodeVertexStream(
+	void* dst,
+	const uint32_t vertexCount,
+	const uint32_t stride,
+	const std::span<const uint8_t> encoded,
+	const MeshCodecPath path
+) {
+	if (stride % 4 != 0 || stride == 0 || stride > c_MESH_CODEC_MAX_STRIDE) {
+		return false;
+	}
+
+	DecodeVertexGroupFn decodeGroup{ decodeVertexGroupScalar };
+#ifdef PYX_CODEC_X86
+	if (path == MeshCodecPath::sse2) {
+		decodeGroup = decodeVertexGroupSse2;
+	} else if (path == MeshCodecPath::avx2) {
+		decodeGroup = decodeVertexGroupAvx2;
+	}
+#endif
+
+	uint32_t headerSize{ getVertexHeaderSize(stride) };
+	const uint8_t* data{ encoded.data() };
+	const uint8_t* end{ encoded.data() + encoded.size() };
+
+	uint8_t previous[c_MESH_CODEC_MAX_STRIDE]{};
+	for (uint32_t first{}; first < vertexCount;
+		 first += c_MESH_CODEC_GROUP_SIZE) {
+		if ((size_t)(end - data) < headerSize) {
+			return false;
+		}
+		const uint8_t* header{ data };
+		data += headerSize;
+
+		size_t groupSize{};
+		for (uint32_t channel{}; channel < stride; channel++) {
+			groupSize += 2 * getVertexWidth(header, channel);
+		}
+		if ((size_t)(end - data) < groupSize) {
+			return false;
+		}
+
+		decodeGroup(
+			header,
+			data,
+			previous,
+			(uint8_t*)dst + (size_t)first * stride,
+			std::min(c_MESH_CODEC_GROUP_SIZE, vertexCount - first),
+			stride
+		);
+		data += groupSize;
+	}
+
+	return data == end;
+}
+
+std::vector<uint8_t> encodeIndexStream(const std::span<const uint32_t> indices
+) {
+	std::vector<uint8_t> encoded;
+	encoded.reserve(indices.size());
+
+	uint32_t previous{};
+	for (size_t first{}; first < indices.size();
+		 first += c_MESH_CODEC_GROUP_SIZE) {
+		uint32_t values[c_MESH_CODEC_GROUP_SIZE]{};
+		uint32_t maxValue{};
+		for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i++) {
+			uint32_t index{ indices[std::min(first + i, indices.size() - 1)] };
+
+			values[i] = zigzag32(index - previous);
+			maxValue = std::max(maxValue, values[i]);
+			previous = index;
+		}
+
+		uint32_t width{ (uint32_t)std::bit_width(maxValue) };
+		encoded.emplace_back((uint8_t)width);
+		packBits(values, width, encoded);
+	}
+
+	return encoded;
+}
+
+bool decodeIndexStream(
+	void* dst,
+	const uint32_t indexCount,
+	const VkIndexType indexType,
+	const std::span<const uint8_t> encoded,
+	const MeshCodecPath path
+) {
+	DecodeIndexGroupFn decodeGroup{ decodeIndexGroupScalar };
+#ifdef PYX_CODEC_X86
+	// eight indices do not fill a lane more than four do
+	if (path != MeshCodecPath::scalar) {
+		decodeGroup = decodeIndexGroupSse2;
+	}
+#endif
+
+	uint32_t indexSize{ indexType == VK_INDEX_TYPE_UINT16 ? 2u : 4u };
+	const uint8_t* data{ encoded.data() };
+	const uint8_t* end{ encoded.data() + encoded.size() };
+
+	uint32_t previous{};
+	for (uint32_t first{}; first < indexCount;
+		 first += c_MESH_CODEC_GROUP_SIZE) {
+		if (data == end || *data > c_MAX_INDEX_WIDTH) {
+			return false;
+		}
+		uint32_t width{ *data };
+		size_t groupSize{ 1 + width * 2 };
+		if ((size_t)(end - data) < groupSize) {
+			return false;
+		}
+
+		// only the last groups of the stream need a padded copy
+		uint32_t values[c_MESH_CODEC_GROUP_SIZE];
+		if ((size_t)(end - data) >= groupSize + c_UNPACK_OVERREAD) {
+			c_UNPACK_BITS[width](data + 1, values);
+		} else {
+			uint8_t packed[c_MAX_INDEX_WIDTH * 2 + c_UNPACK_OVERREAD]{};
+			memcpy(packed, data + 1, width * 2);
+			c_UNPACK_BITS[width](packed, values);
+		}
+		data += groupSize;
+
+		decodeGroup(
+			values,
+			previous,
+			(uint8_t*)dst + (size_t)first * indexSize,
+			std::min(c_MESH_CODEC_GROUP_SIZE, indexCount - first),
+			indexType
+		);
+	}
+
+	return data == end;
+}
+
+namespace {
+	uint8_t zigzag8(const uint8_t delta) {
+		return (uint8_t)((delta << 1) ^ (uint8_t)((int8_t)delta >> 7));
+	}
+
+	uint8_t unzigzag8(const uint8_t value) {
+		return (uint8_t)((value >> 1) ^ (uint8_t)(-(value & 1)));
+	}
+
+	uint32_t zigzag32(const uint32_t delta) {
+		return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+	}
+
+	uint32_t unzigzag32(const uint32_t value) {
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	uint32_t getVertexHeaderSize(const uint32_t stride) {
+		return (stride + 3) / 4;
+	}
+
+	uint32_t getVertexWidth(const uint8_t* header, const uint32_t channel) {
+		return c_VERTEX_WIDTHS[(header[channel / 4] >> (channel % 4 * 2)) & 3];
+	}
+
+	void packBits(
+		const uint32_t* values, const uint32_t width, std::vector<uint8_t>& out
+	) {
+		uint64_t bits{};
+		uint32_t bitCount{};
+		for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i++) {
+			bits |= (uint64_t)values[i] << bitCount;
+			bitCount += width;
+			while (bitCount >= 8) {
+				out.emplace_back((uint8_t)bits);
+				bits >>= 8;
+				bitCount -= 8;
+			}
+		}
+	}
+
+	void decodeVertexGroupScalar(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	) {
+		for (uint32_t channel{}; channel < stride; channel++) {
+			uint32_t width{ getVertexWidth(header, channel) };
+			uint32_t mask{ (1u << width) - 1 };
+
+			uint8_t value{ previous[channel] };
+			for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i++) {
+				uint32_t bit{ i * width };
+				uint8_t packed{ (uint8_t)(
+					width == 0 ? 0 : (data[bit / 8] >> (bit % 8)) & mask
+				) };
+				value += unzigzag8(packed);
+				if (i < count) {
+					dst[i * stride + channel] = value;
+				}
+			}
+
+			previous[channel] = value;
+			data += 2 * width;
+		}
+	}
+
+	void decodeIndexGroupScalar(
+		const uint32_t* values,
+		uint32_t& previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const VkIndexType indexType
+	) {
+		for (uint32_t i{}; i < count; i++) {
+			previous += unzigzag32(values[i]);
+			if (indexType == VK_INDEX_TYPE_UINT16) {
+				uint16_t index{ (uint16_t)previous };
+				memcpy(dst + i * sizeof(index), &index, sizeof(index));
+			} else {
+				memcpy(dst + i * sizeof(previous), &previous, sizeof(previous));
+			}
+		}
+	}
+
+#ifdef PYX_CODEC_X86
+	PYX_FORCE_INLINE __m128i
+	unpackVertexDeltas(const uint8_t* data, const uint32_t width) {
+		switch (width) {
+			case 2: {
+				// four values per byte, split into one register per position
+				// in the byte and interleaved back into order
+				uint32_t word{};
+				memcpy(&word, data, sizeof(word));
+				__m128i bytes{ _mm_cvtsi32_si128((int)word) };
+				__m128i mask{ _mm_set1_epi8(0x03) };
+
+				__m128i bits0{ _mm_and_si128(bytes, mask) };
+				__m128i bits2{ _mm_and_si128(_mm_srli_epi16(bytes, 2), mask) };
+				__m128i bits4{ _mm_and_si128(_mm_srli_epi16(bytes, 4), mask) };
+				__m128i bits6{ _mm_and_si128(_mm_srli_epi16(bytes, 6), mask) };
+
+				return _mm_unpacklo_epi16(
+					_mm_unpacklo_epi8(bits0, bits2),
+					_mm_unpacklo_epi8(bits4, bits6)
+				);
+			}
+			case 4: {
+				__m128i bytes{ _mm_loadl_epi64((const __m128i*)data) };
+				__m128i mask{ _mm_set1_epi8(0x0f) };
+
+				return _mm_unpacklo_epi8(
+					_mm_and_si128(bytes, mask),
+					_mm_and_si128(_mm_srli_epi16(bytes, 4), mask)
+				);
+			}
+			case 8:
+				return _mm_loadu_si128((const __m128i*)data);
+		}
+
+		return _mm_setzero_si128();
+	}
+
+	PYX_FORCE_INLINE __m128i
+	decodeVertexChannel(const __m128i values, const uint8_t previous) {
+		__m128i deltas{ _mm_xor_si128(
+			_mm_and_si128(_mm_srli_epi16(values, 1), _mm_set1_epi8(0x7f)),
+			_mm_sub_epi8(
+				_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi8(1))
+			)
+		) };
+
+		// inclusive prefix sum over the sixteen vertices
+		deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 1));
+		deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 2));
+		deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 4));
+		deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 8));
+
+		return _mm_add_epi8(deltas, _mm_set1_epi8((char)previous));
+	}
+
+	PYX_FORCE_INLINE void storeVertexGroup(
+		const __m128i* channels,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	) {
+		for (uint32_t channel{}; channel < stride; channel += 4) {
+			__m128i low01{
+				_mm_unpacklo_epi8(channels[channel], channels[channel + 1])
+			};
+			__m128i high01{
+				_mm_unpackhi_epi8(channels[channel], channels[channel + 1])
+			};
+			__m128i low23{
+				_mm_unpacklo_epi8(channels[channel + 2], channels[channel + 3])
+			};
+			__m128i high23{
+				_mm_unpackhi_epi8(channels[channel + 2], channels[channel + 3])
+			};
+
+			// four bytes of every vertex of the group
+			alignas(16) uint32_t words[c_MESH_CODEC_GROUP_SIZE];
+			_mm_store_si128((__m128i*)words, _mm_unpacklo_epi16(low01, low23));
+			_mm_store_si128(
+				(__m128i*)(words + 4), _mm_unpackhi_epi16(low01, low23)
+			);
+			_mm_store_si128(
+				(__m128i*)(words + 8), _mm_unpacklo_epi16(high01, high23)
+			);
+			_mm_store_si128(
+				(__m128i*)(words + 12), _mm_unpackhi_epi16(high01, high23)
+			);
+
+			for (uint32_t i{}; i < count; i++) {
+				memcpy(dst + i * stride + channel, &words[i], sizeof(words[i]));
+			}
+		}
+	}
+
+	void decodeVertexGroupSse2(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	) {
+		__m128i channels[c_MESH_CODEC_MAX_STRIDE];
+		for (uint32_t channel{}; channel < stride; channel++) {
+			uint32_t width{ getVertexWidth(header, channel) };
+			channels[channel] = decodeVertexChannel(
+				unpackVertexDeltas(data, width), previous[channel]
+			);
+			previous[channel] =
+				(uint8_t)_mm_cvtsi128_si32(_mm_srli_si128(channels[channel], 15));
+			data += 2 * width;
+		}
+
+		storeVertexGroup(channels, dst, count, stride);
+	}
+
+	// two channels per register, the byte shifts of avx2 stay within their
+	// lane which keeps the prefix sums apart
+	PYX_TARGET_AVX2 void decodeVertexGroupAvx2(
+		const uint8_t* header,
+		const uint8_t* data,
+		uint8_t* previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const uint32_t stride
+	) {
+		__m128i channels[c_MESH_CODEC_MAX_STRIDE];
+		for (uint32_t channel{}; channel < stride; channel += 2) {
+			uint32_t width0{ getVertexWidth(header, channel) };
+			uint32_t width1{ getVertexWidth(header, channel + 1) };
+			__m256i values{ _mm256_set_m128i(
+				unpackVertexDeltas(data + 2 * width0, width1),
+				unpackVertexDeltas(data, width0)
+			) };
+			data += 2 * (width0 + width1);
+
+			__m256i deltas{ _mm256_xor_si256(
+				_mm256_and_si256(
+					_mm256_srli_epi16(values, 1), _mm256_set1_epi8(0x7f)
+				),
+				_mm256_sub_epi8(
+					_mm256_setzero_si256(),
+					_mm256_and_si256(values, _mm256_set1_epi8(1))
+				)
+			) };
+			deltas = _mm256_add_epi8(deltas, _mm256_slli_si256(deltas, 1));
+			deltas = _mm256_add_epi8(deltas, _mm256_slli_si256(deltas, 2));
+			deltas = _mm256_add_epi8(deltas, _mm256_slli_si256(deltas, 4));
+			deltas = _mm256_add_epi8(deltas, _mm256_slli_si256(deltas, 8));
+			deltas = _mm256_add_epi8(
+				deltas,
+				_mm256_set_m128i(
+					_mm_set1_epi8((char)previous[channel + 1]),
+					_mm_set1_epi8((char)previous[channel])
+				)
+			);
+
+			channels[channel] = _mm256_castsi256_si128(deltas);
+			channels[channel + 1] = _mm256_extracti128_si256(deltas, 1);
+			previous[channel] = (uint8_t)_mm256_extract_epi8(deltas, 15);
+			previous[channel + 1] = (uint8_t)_mm256_extract_epi8(deltas, 31);
+		}
+
+		storeVertexGroup(channels, dst, count, stride);
+	}
+
+	void decodeIndexGroupSse2(
+		const uint32_t* values,
+		uint32_t& previous,
+		uint8_t* dst,
+		const uint32_t count,
+		const VkIndexType indexType
+	) {
+		alignas(16) uint32_t indices[c_MESH_CODEC_GROUP_SIZE];
+
+		__m128i carry{ _mm_set1_epi32((int)previous) };
+		for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i += 4) {
+			__m128i packed{ _mm_loadu_si128((const __m128i*)(values + i)) };
+			__m128i deltas{ _mm_xor_si128(
+				_mm_srli_epi32(packed, 1),
+				_mm_sub_epi32(
+					_mm_setzero_si128(), _mm_and_si128(packed, _mm_set1_epi32(1))
+				)
+			) };
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+			deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+			deltas = _mm_add_epi32(deltas, carry);
+
+			_mm_store_si128((__m128i*)(indices + i), deltas);
+			carry = _mm_shuffle_epi32(deltas, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+		// a partial group repeats its last index
+		previous = indices[c_MESH_CODEC_GROUP_SIZE - 1];
+
+		if (indexType == VK_INDEX_TYPE_UINT16) {
+			// packs saturates signed, so narrow around the middle of the
+			// range
+			alignas(16) uint16_t narrow[c_MESH_CODEC_GROUP_SIZE];
+			__m128i bias{ _mm_set1_epi32(0x8000) };
+			__m128i signBit{ _mm_set1_epi16((short)0x8000) };
+			for (uint32_t i{}; i < c_MESH_CODEC_GROUP_SIZE; i += 8) {
+				__m128i low{ _mm_sub_epi32(
+					_mm_load_si128((const __m128i*)(indices + i)), bias
+				) };
+				__m128i high{ _mm_sub_epi32(
+					_mm_load_si128((const __m128i*)(indices + i + 4)), bias
+				) };
+				_mm_store_si128(
+					(__m128i*)(narrow + i),
+					_mm_xor_si128(_mm_packs_epi32(low, high), signBit)
+				);
+			}
+			if (count == c_MESH_CODEC_GROUP_SIZE) {
+				memcpy(dst, narrow, sizeof(narrow));
+			} else {
+				memcpy(dst, narrow, count * sizeof(uint16_t));
+			}
+		} else if (count == c_MESH_CODEC_GROUP_SIZE) {
+			memcpy(dst, indices, sizeof(indices));
+		} else {
+			memcpy(dst, indices, count * sizeof(uint32_t));
+		}
+	}
+
+	bool supportsAvx2() {
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_cpu_supports("avx2");
+#else
+		int info[4]{};
+		__cpuid(info, 1);
+		// the os saves ymm registers
+		bool osxsave{ (info[2] & (1 << 27)) != 0 };
+		if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#endif
+	}
+#endif
+}  // namespace
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// streams are split into groups of this many vertices or indices
+constexpr uint32_t c_MESH_CODEC_GROUP_SIZE{ 16 };
+constexpr uint32_t c_MESH_CODEC_MAX_STRIDE{ 64 };
+
+enum class MeshCodecPath {
+	scalar,
+	sse2,
+	avx2,
+};
+
+// the fastest path this cpu supports
+MeshCodecPath getBestMeshCodecPath();
+
+// every byte of a vertex is delta encoded against the same byte of the
+// previous vertex and zigzagged, then each byte of a group is bit packed
+// with the smallest of 0, 2, 4 or 8 bits that fits the whole group. the
+// stride has to be a multiple of 4 and at most c_MESH_CODEC_MAX_STRIDE.
+std::vector<uint8_t> encodeVertexStream(
+	const std::span<const uint8_t> vertices, const uint32_t stride
+);
+// dst receives vertexCount * stride bytes and may be mapped memory, it is
+// only written. false if encoded does not hold exactly that many vertices
+bool decodeVertexStream(
+	void* dst,
+	const uint32_t vertexCount,
+	const uint32_t stride,
+	const std::span<const uint8_t> encoded,
+	const MeshCodecPath path = getBestMeshCodecPath()
+);
+
+// indices are delta encoded against the previous index and zigzagged, each
+// group is bit packed with the width of its largest delta. vertex cache
+// optimized meshes mostly need 2 to 6 bits per index
+std::vector<uint8_t> encodeIndexStream(const std::span<const uint32_t> indices
+);
+// dst receives indexCount indices of indexType
+bool decodeIndexStream(
+	void* dst,
+	const uint32_t indexCount,
+	const VkIndexType indexType,
+	const std::span<const uint8_t> encoded,
+	const MeshCodecPath path = getBestMeshCodecPath()
+);
@@ -0,0 +1,389 @@
+#include "MeshImport.h"
+#include "Logger.h"
+#include "MeshCodec.h"
+#include "ThreadPool.h"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <tiny_obj_loader.h>
+
+namespace {
+	// bounds the work of a single job and keeps every part indexable
+	constexpr size_t c_MAX_TRIANGLES_PER_MESH{ 1 << 20 };
+
+	struct MeshPart {
+		size_t shape;
+		size_t firstTriangle;
+		size_t triangleCount;
+	};
+
+	struct ImportJob {
+		tinyobj::ObjReader reader;
+		MeshImportResult result;
+		ThreadPool::JobCounter parts;
+		std::chrono::steady_clock::time_point buildStart;
+	};
+
+	// open addressing map from the OBJ attribute indices a vertex is made of
+	// to the output vertex it became. texcoords are not part of the key since
+	// makeVertex does not emit them
+	class VertexDedupMap {
+	   public:
+		explicit VertexDedupMap(const size_t maxVertices);
+
+		// inserts value if the indices are new, returns the stored value
+		uint32_t findOrInsert(
+			const tinyobj::index_t& index, const uint32_t value
+		);
+
+	   private:
+		struct Slot {
+			int32_t vertexIndex;
+			int32_t normalIndex;
+			uint32_t value;
+		};
+
+		static constexpr uint32_t c_EMPTY{ UINT32_MAX };
+
+		std::vector<Slot> m_Slots;
+		size_t m_Mask;
+	};
+
+	std::vector<MeshPart> splitShapes(const std::vector<tinyobj::shape_t>& shapes
+	);
+	void buildMesh(
+		const tinyobj::attrib_t& attrib,
+		const tinyobj::shape_t& shape,
+		const MeshPart& part,
+		ImportedMesh& mesh
+	);
+	Vertex makeVertex(
+		const tinyobj::attrib_t& attrib, const tinyobj::index_t& index
+	);
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start);
+}  // namespace
+
+void MeshImporter::shutdown() {
+	std::unique_lock<std::mutex> lock(m_IdleMutex);
+	m_Idle.wait(lock, [&]() { return m_RunningImports == 0; });
+}
+
+void MeshImporter::requestImport(const std::filesystem::path& path) {
+	m_RunningImports++;
+
+	ThreadPool::submit([this, path](uint32_t) {
+		auto parseStart{ std::chrono::steady_clock::now() };
+
+		std::shared_ptr<ImportJob> job{ std::make_shared<ImportJob>() };
+		job->result.path = path;
+
+		tinyobj::ObjReaderConfig config{};
+		config.triangulate = true;
+		config.vertex_color = true;
+		if (!job->reader.ParseFromFile(path.string(), config)) {
+			PYX_ENGINE_ERROR(
+				"[MeshImport] could not parse {0}: {1}",
+				path.string(),
+				job->reader.Error()
+			);
+			finishImport(std::move(job->result));
+			return;
+		}
+		if (!job->reader.Warning().empty()) {
+			PYX_ENGINE_WARNING(
+				"[MeshImport] {0}: {1}", path.string(), job->reader.Warning()
+			);
+		}
+		job->result.parseNs = getElapsedNs(parseStart);
+
+		std::vector<MeshPart> parts{ splitShapes(job->reader.GetShapes()) };
+		if (parts.empty()) {
+			job->result.success = true;
+			finishImport(std::move(job->result));
+			return;
+		}
+
+		job->result.meshes.resize(parts.size());
+		job->buildStart = std::chrono::steady_clock::now();
+
+		for (size_t i{}; i < parts.size(); i++) {
+			ThreadPool::submit(
+				[job, part = parts[i], i](uint32_t) {
+					buildMesh(
+						job->reader.GetAttrib(),
+						job->reader.GetShapes()[part.shape],
+						part,
+						job->result.meshes[i]
+					);
+				},
+				&job->parts
+			);
+		}
+
+		// hands the whole file over once every part is built
+		ThreadPool::submitAfter(job->parts, [this, job](uint32_t) {
+			job->result.buildNs = getElapsedNs(job->buildStart);
+			job->result.success = true;
+			finishImport(std::move(job->result));
+		});
+	});
+}
+
+void MeshImporter::requestDecode(
+	const std::string& name,
+	const MeshAssetInfo& info,
+	const std::span<const uint8_t> vertexStream,
+	const std::span<const uint8_t> indexStream
+) {
+	m_RunningImports++;
+
+	ThreadPool::submit([=, this](uint32_t) {
+		auto decodeStart{ std::chrono::steady_clock::now() };
+
+		uint32_t indexSize{ info.indexType == VK_INDEX_TYPE_UINT16 ? 2u : 4u };
+		ImportedMesh mesh{
+			.name = name,
+			.vertexData = std::vector<uint8_t>(
+				(size_t)info.vertexCount * info.vertexStride
+			),
+			.vertexStride = info.vertexStride,
+			.vertexCount = info.vertexCount,
+			.quantization = VertexQuantization{
+				.scale = glm::vec3{ info.positionScale[0],
+									info.positionScale[1],
+									info.positionScale[2] },
+				.offset = glm::vec3{ info.positionOffset[0],
+									 info.positionOffset[1],
+									 info.positionOffset[2] },
+			},
+			.indices = std::vector<uint8_t>((size_t)info.indexCount * indexSize),
+			.indexType = info.indexType,
+			.indexCount = info.indexCount,
+		};
+
+		MeshImportResult result{ .path = name, .cooked = true };
+		result.success =
+			decodeVertexStream(
+				mesh.vertexData.data(),
+				info.vertexCount,
+				info.vertexStride,
+				vertexStream
+			) &&
+			decodeIndexStream(
+				mesh.indices.data(), info.indexCount, info.indexType, indexStream
+			);
+		result.parseNs = getElapsedNs(decodeStart);
+		if (result.success) {
+			result.meshes.emplace_back(std::move(mesh));
+		} else {
+			PYX_ENGINE_ERROR("[MeshImport] {0} is corrupt", name);
+		}
+
+		finishImport(std::move(result));
+	});
+}
+
+std::vector<MeshImportResult> MeshImporter::pollCompleted() {
+	std::vector<MeshImportResult> completed;
+	std::lock_guard<std::mutex> lock(m_CompletedMutex);
+	completed.swap(m_Completed);
+
+	return completed;
+}
+
+bool MeshImporter::isIdle() {
+	// results are handed over before the running count drops
+	if (m_RunningImports != 0) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_CompletedMutex);
+	return m_Completed.empty();
+}
+
+void MeshImporter::finishImport(MeshImportResult&& result) {
+	if (result.success && result.cooked) {
+		PYX_ENGINE_INFO(
+			"[MeshImport] decoded {0} in {1:.2f}ms",
+			result.path.string(),
+			result.parseNs / 1e6
+		);
+	} else if (result.success) {
+		size_t triangleCount{};
+		size_t vertexCount{};
+		double missesBefore{};
+		double missesAfter{};
+		for (const auto& mesh : result.meshes) {
+			triangleCount += mesh.indexCount / 3;
+			vertexCount += mesh.vertexCount;
+			missesBefore += mesh.stats.acmrBefore * (mesh.indexCount / 3);
+			missesAfter += mesh.stats.acmrAfter * (mesh.indexCount / 3);
+		}
+		PYX_ENGINE_INFO(
+			"[MeshImport] {0}: {1} meshes, {2} triangles, {3} unique "
+			"vertices from {4} corners, parsed in {5:.2f}ms, built in "
+			"{6:.2f}ms",
+			result.path.string(),
+			result.meshes.size(),
+			triangleCount,
+			vertexCount,
+			triangleCount * 3,
+			result.parseNs / 1e6,
+			result.buildNs / 1e6
+		);
+		if (triangleCount > 0) {
+			PYX_ENGINE_INFO(
+				"[MeshImport] {0}: acmr {1:.3f} -> {2:.3f}, {3} -> {4} "
+				"bytes per vertex",
+				result.path.string(),
+				missesBefore / triangleCount,
+				missesAfter / triangleCount,
+				sizeof(Vertex),
+				sizeof(PackedVertex)
+			);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_CompletedMutex);
+		m_Completed.emplace_back(std::move(result));
+	}
+
+	// under the mutex so shutdown cannot miss the wakeup
+	std::lock_guard<std::mutex> lock(m_IdleMutex);
+	m_RunningImports--;
+	m_Idle.notify_all();
+}
+
+namespace {
+	VertexDedupMap::VertexDedupMap(const size_t maxVertices) {
+		// at most two thirds full
+		size_t capacity{ std::bit_ceil(maxVertices + maxVertices / 2 + 1) };
+		m_Slots.assign(capacity, Slot{ .value = c_EMPTY });
+		m_Mask = capacity - 1;
+	}
+
+	uint32_t VertexDedupMap::findOrInsert(
+		const tinyobj::index_t& index, const uint32_t value
+	) {
+		uint64_t hash{ (uint64_t)(uint32_t)index.vertex_index *
+					   0x9e3779b97f4a7c15 };
+		hash ^= (uint64_t)(uint32_t)index.normal_index * 0xc2b2ae3d27d4eb4f;
+		hash ^= hash >> 29;
+
+		for (size_t i{ hash & m_Mask };; i = (i + 1) & m_Mask) {
+			Slot& slot{ m_Slots[i] };
+			if (slot.value == c_EMPTY) {
+				slot = Slot{
+					.vertexIndex = index.vertex_index,
+					.normalIndex = index.normal_index,
+					.value = value,
+				};
+				return value;
+			}
+			if (slot.vertexIndex == index.vertex_index &&
+				slot.normalIndex == index.normal_index) {
+				return slot.value;
+			}
+		}
+	}
+
+	std::vector<MeshPart> splitShapes(const std::vector<tinyobj::shape_t>& shapes
+	) {
+		std::vector<MeshPart> parts;
+		for (size_t shape{}; shape < shapes.size(); shape++) {
+			size_t triangleCount{ shapes[shape].mesh.indices.size() / 3 };
+			for (size_t first{}; first < triangleCount;
+				 first += c_MAX_TRIANGLES_PER_MESH) {
+				parts.emplace_back(MeshPart{
+					.shape = shape,
+					.firstTriangle = first,
+					.triangleCount =
+						std::min(c_MAX_TRIANGLES_PER_MESH, triangleCount - first),
+				});
+			}
+		}
+
+		return parts;
+	}
+
+	void buildMesh(
+		const tinyobj::attrib_t& attrib,
+		const tinyobj::shape_t& shape,
+		const MeshPart& part,
+		ImportedMesh& mesh
+	) {
+		size_t cornerCount{ part.triangleCount * 3 };
+		const tinyobj::index_t* corners{ shape.mesh.indices.data() +
+										 part.firstTriangle * 3 };
+
+		VertexDedupMap dedupMap{ cornerCount };
+		std::vector<uint32_t> indices(cornerCount);
+		std::vector<Vertex> vertices;
+		vertices.reserve(cornerCount / 4);
+
+		for (size_t i{}; i < cornerCount; i++) {
+			uint32_t nextVertex{ (uint32_t)vertices.size() };
+			uint32_t vertex{ dedupMap.findOrInsert(corners[i], nextVertex) };
+			if (vertex == nextVertex) {
+				vertices.emplace_back(makeVertex(attrib, corners[i]));
+			}
+			indices[i] = vertex;
+		}
+
+		OptimizedMesh optimized{ optimizeMesh(vertices, std::move(indices)) };
+
+		mesh.name = shape.name;
+		mesh.vertexStride = sizeof(PackedVertex);
+		mesh.vertexCount = (uint32_t)optimized.vertices.size();
+		mesh.vertexData.resize(optimized.vertices.size() * sizeof(PackedVertex));
+		memcpy(
+			mesh.vertexData.data(),
+			optimized.vertices.data(),
+			mesh.vertexData.size()
+		);
+		mesh.indexCount = (uint32_t)optimized.indices.size();
+		mesh.indices = packIndices(
+			optimized.indices, mesh.vertexCount, mesh.indexType
+		);
+		mesh.quantization = optimized.quantization;
+		mesh.stats = optimized.stats;
+	}
+
+	Vertex makeVertex(
+		const tinyobj::attrib_t& attrib, const tinyobj::index_t& index
+	) {
+		size_t v{ (size_t)index.vertex_index * 3 };
+		Vertex vertex{
+			.pos = { attrib.vertices[v],
+					 attrib.vertices[v + 1],
+					 attrib.vertices[v + 2] },
+			.color = { 1.f, 1.f, 1.f },
+		};
+
+		// the normal is the more useful colour when there is one
+		if (index.normal_index >= 0) {
+			size_t n{ (size_t)index.normal_index * 3 };
+			vertex.color = glm::vec3{ attrib.normals[n],
+									  attrib.normals[n + 1],
+									  attrib.normals[n + 2] } *
+					0.5f +
+				0.5f;
+		} else if (attrib.colors.size() > v + 2) {
+			vertex.color = { attrib.colors[v],
+							 attrib.colors[v + 1],
+							 attrib.colors[v + 2] };
+		}
+
+		return vertex;
+	}
+
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start) {
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				   std::chrono::steady_clock::now() - start
+		)
+			.count();
+	}
+}  // namespace
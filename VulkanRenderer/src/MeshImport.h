@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "AssetArchive.h"
+#include "MeshOptimize.h"
+#include "Vertex.h"
+
+struct ImportedMesh {
+	std::string name;
+	// optimized PackedVertex, as bytes so it can be handed to the geometry
+	// buffer without a copy
+	std::vector<uint8_t> vertexData;
+	uint32_t vertexStride;
+	uint32_t vertexCount;
+	VertexQuantization quantization;
+	MeshOptimizeStats stats;
+	// uint16_t when every index fits, uint32_t otherwise
+	std::vector<uint8_t> indices;
+	VkIndexType indexType;
+	uint32_t indexCount;
+};
+
+struct MeshImportResult {
+	std::filesystem::path path;
+	bool success;
+	// decoded from a cooked archive, parseNs is the decode time and there
+	// are no optimization stats
+	bool cooked;
+	// one per shape, large shapes are split into several meshes
+	std::vector<ImportedMesh> meshes;
+	uint64_t parseNs;
+	uint64_t buildNs;
+};
+
+// imports OBJ files on the thread pool. every file is parsed by one worker,
+// then its shapes are deduplicated, indexed and optimized in parallel.
+// compressed meshes from cooked archives are decoded on the pool as well.
+// finished imports are handed to the render thread by pollCompleted, which
+// never blocks on a running import.
+class MeshImporter {
+   public:
+	// waits for running imports
+	void shutdown();
+
+	void requestImport(const std::filesystem::path& path);
+	// the streams have to stay mapped until the result is polled
+	void requestDecode(
+		const std::string& name,
+		const MeshAssetInfo& info,
+		const std::span<const uint8_t> vertexStream,
+		const std::span<const uint8_t> indexStream
+	);
+	std::vector<MeshImportResult> pollCompleted();
+	// nothing running and every result polled
+	bool isIdle();
+
+   private:
+	void finishImport(MeshImportResult&& result);
+
+	std::mutex m_CompletedMutex;
+	std::vector<MeshImportResult> m_Completed;
+
+	std::atomic<uint32_t> m_RunningImports{};
+	std::mutex m_IdleMutex;
+	std::condition_variable m_Idle;
+};
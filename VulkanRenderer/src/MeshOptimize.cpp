@@ -0,0 +1,390 @@
+#include "MeshOptimize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+	// scoring constants from Forsyth's paper
+	constexpr uint32_t c_SCORING_CACHE_SIZE{ 32 };
+	constexpr float c_CACHE_DECAY_POWER{ 1.5f };
+	constexpr float c_LAST_TRIANGLE_SCORE{ 0.75f };
+	constexpr float c_VALENCE_BOOST_SCALE{ 2.f };
+	constexpr float c_VALENCE_BOOST_POWER{ 0.5f };
+	constexpr uint32_t c_MAX_SCORED_VALENCE{ 64 };
+
+	constexpr uint32_t c_NOT_CACHED{ UINT32_MAX };
+
+	struct ScoreTables {
+		float cache[c_SCORING_CACHE_SIZE];
+		float valence[c_MAX_SCORED_VALENCE];
+	};
+
+	ScoreTables makeScoreTables();
+	float getVertexScore(
+		const ScoreTables& tables,
+		const uint32_t cachePosition,
+		const uint32_t liveTriangles
+	);
+}  // namespace
+
+OptimizedMesh optimizeMesh(
+	const std::vector<Vertex>& vertices, std::vector<uint32_t> indices
+) {
+	OptimizedMesh mesh{};
+	mesh.stats.acmrBefore =
+		getAcmr(indices, (uint32_t)vertices.size(), c_ACMR_CACHE_SIZE);
+	mesh.stats.bytesPerVertexBefore = sizeof(Vertex);
+
+	optimizeVertexCache(indices, (uint32_t)vertices.size());
+	optimizeOverdraw(indices, vertices);
+	std::vector<Vertex> fetchOrdered{ optimizeVertexFetch(indices, vertices) };
+	mesh.quantization = quantizeVertices(fetchOrdered, mesh.vertices);
+
+	mesh.stats.acmrAfter =
+		getAcmr(indices, (uint32_t)vertices.size(), c_ACMR_CACHE_SIZE);
+	mesh.stats.bytesPerVertexAfter = sizeof(PackedVertex);
+	mesh.indices = std::move(indices);
+
+	return mesh;
+}
+
+void optimizeVertexCache(
+	std::vector<uint32_t>& indices, const uint32_t vertexCount
+) {
+	const ScoreTables tables{ makeScoreTables() };
+	const uint32_t triangleCount{ (uint32_t)indices.size() / 3 };
+
+	// triangles of every vertex, the live ones are at the front of the range
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (const auto index : indices) {
+		liveTriangles[index]++;
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::exclusive_scan(
+		liveTriangles.begin(),
+		liveTriangles.end(),
+		adjacencyOffsets.begin(),
+		0u
+	);
+	adjacencyOffsets[vertexCount] = (uint32_t)indices.size();
+
+	std::vector<uint32_t> adjacency(indices.size());
+	{
+		std::vector<uint32_t> fill(
+			adjacencyOffsets.begin(), adjacencyOffsets.end() - 1
+		);
+		for (uint32_t i{}; i < indices.size(); i++) {
+			adjacency[fill[indices[i]]++] = i / 3;
+		}
+	}
+
+	std::vector<uint32_t> cachePositions(vertexCount, c_NOT_CACHED);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t v{}; v < vertexCount; v++) {
+		vertexScores[v] = getVertexScore(tables, c_NOT_CACHED, liveTriangles[v]);
+	}
+
+	std::vector<bool> emitted(triangleCount);
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	// three extra slots hold what the newest triangle pushes out
+	uint32_t cache[c_SCORING_CACHE_SIZE + 3];
+	uint32_t cacheCount{};
+	uint32_t nextCache[c_SCORING_CACHE_SIZE + 3];
+
+	uint32_t bestTriangle{ UINT32_MAX };
+	uint32_t scanCursor{};
+
+	for (uint32_t emittedCount{}; emittedCount < triangleCount;
+		 emittedCount++) {
+		// nothing in the cache has live triangles left, start somewhere new
+		if (bestTriangle == UINT32_MAX) {
+			while (emitted[scanCursor]) {
+				scanCursor++;
+			}
+			bestTriangle = scanCursor;
+		}
+
+		const uint32_t* triangle{ &indices[bestTriangle * 3] };
+		output.insert(output.end(), triangle, triangle + 3);
+		emitted[bestTriangle] = true;
+
+		for (uint32_t i{}; i < 3; i++) {
+			uint32_t v{ triangle[i] };
+			uint32_t* begin{ &adjacency[adjacencyOffsets[v]] };
+			uint32_t* end{ begin + liveTriangles[v] };
+			std::iter_swap(std::find(begin, end, bestTriangle), end - 1);
+			liveTriangles[v]--;
+		}
+
+		// the emitted triangle moves to the front, the rest keeps its order
+		uint32_t nextCount{};
+		for (uint32_t i{}; i < 3; i++) {
+			nextCache[nextCount++] = triangle[i];
+		}
+		for (uint32_t i{}; i < cacheCount; i++) {
+			uint32_t v{ cache[i] };
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+				nextCache[nextCount++] = v;
+			}
+		}
+
+		bestTriangle = UINT32_MAX;
+		float bestScore{ -1.f };
+		for (uint32_t i{}; i < nextCount; i++) {
+			uint32_t v{ nextCache[i] };
+			cachePositions[v] = i < c_SCORING_CACHE_SIZE ? i : c_NOT_CACHED;
+			vertexScores[v] =
+				getVertexScore(tables, cachePositions[v], liveTriangles[v]);
+		}
+		for (uint32_t i{}; i < nextCount; i++) {
+			uint32_t v{ nextCache[i] };
+			for (uint32_t j{}; j < liveTriangles[v]; j++) {
+				uint32_t t{ adjacency[adjacencyOffsets[v] + j] };
+				float score{ vertexScores[indices[t * 3]] +
+							 vertexScores[indices[t * 3 + 1]] +
+							 vertexScores[indices[t * 3 + 2]] };
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(nextCount, c_SCORING_CACHE_SIZE);
+		std::copy(nextCache, nextCache + cacheCount, cache);
+	}
+
+	indices = std::move(output);
+}
+
+void optimizeOverdraw(
+	std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices
+) {
+	struct Cluster {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float sortKey;
+	};
+
+	const uint32_t triangleCount{ (uint32_t)indices.size() / 3 };
+
+	// a triangle missing all three vertices is where the cache started over
+	std::vector<Cluster> clusters;
+	std::vector<uint32_t> cacheTimestamps(vertices.size(), 0);
+	uint32_t time{ c_ACMR_CACHE_SIZE + 1 };
+	for (uint32_t t{}; t < triangleCount; t++) {
+		uint32_t misses{};
+		for (uint32_t i{}; i < 3; i++) {
+			uint32_t v{ indices[t * 3 + i] };
+			if (time - cacheTimestamps[v] > c_ACMR_CACHE_SIZE) {
+				cacheTimestamps[v] = time++;
+				misses++;
+			}
+		}
+
+		if (misses == 3 || clusters.empty()) {
+			clusters.emplace_back(Cluster{ .firstIndex = t * 3 });
+		}
+		clusters.back().indexCount += 3;
+	}
+
+	if (clusters.size() < 2) {
+		return;
+	}
+
+	glm::vec3 meshCentroid{};
+	for (const auto& vertex : vertices) {
+		meshCentroid += vertex.pos;
+	}
+	meshCentroid /= (float)vertices.size();
+
+	for (auto& cluster : clusters) {
+		glm::vec3 centroid{};
+		glm::vec3 normal{};
+		float area{};
+		for (uint32_t i{}; i < cluster.indexCount; i += 3) {
+			const uint32_t* triangle{ &indices[cluster.firstIndex + i] };
+			glm::vec3 a{ vertices[triangle[0]].pos };
+			glm::vec3 b{ vertices[triangle[1]].pos };
+			glm::vec3 c{ vertices[triangle[2]].pos };
+
+			// the length of the cross product is twice the area
+			glm::vec3 faceNormal{ glm::cross(b - a, c - a) };
+			float faceArea{ glm::length(faceNormal) };
+			centroid += (a + b + c) * (faceArea / 3.f);
+			normal += faceNormal;
+			area += faceArea;
+		}
+
+		float normalLength{ glm::length(normal) };
+		if (area > 0.f && normalLength > 0.f) {
+			centroid /= area;
+			cluster.sortKey =
+				glm::dot(centroid - meshCentroid, normal / normalLength);
+		}
+	}
+
+	std::ranges::stable_sort(clusters, [](const Cluster& a, const Cluster& b) {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indices.size());
+	for (const auto& cluster : clusters) {
+		sorted.insert(
+			sorted.end(),
+			indices.begin() + cluster.firstIndex,
+			indices.begin() + cluster.firstIndex + cluster.indexCount
+		);
+	}
+	indices = std::move(sorted);
+}
+
+std::vector<Vertex> optimizeVertexFetch(
+	std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices
+) {
+	std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+	std::vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+
+	for (auto& index : indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = (uint32_t)ordered.size();
+			ordered.emplace_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	return ordered;
+}
+
+VertexQuantization quantizeVertices(
+	const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed
+) {
+	glm::vec3 min{ std::numeric_limits<float>::max() };
+	glm::vec3 max{ std::numeric_limits<float>::lowest() };
+	for (const auto& vertex : vertices) {
+		min = glm::min(min, vertex.pos);
+		max = glm::max(max, vertex.pos);
+	}
+
+	glm::vec3 extent{ max - min };
+	glm::vec3 inverseExtent{ 0.f };
+	for (glm::length_t i{}; i < 3; i++) {
+		if (extent[i] > 0.f) {
+			inverseExtent[i] = 1.f / extent[i];
+		}
+	}
+
+	packed.resize(vertices.size());
+	for (size_t i{}; i < vertices.size(); i++) {
+		glm::vec3 unorm{ (vertices[i].pos - min) * inverseExtent };
+		glm::vec3 color{ glm::clamp(vertices[i].color, 0.f, 1.f) };
+		packed[i] = PackedVertex{
+			.pos = { (uint16_t)std::lround(unorm.x * UINT16_MAX),
+					 (uint16_t)std::lround(unorm.y * UINT16_MAX),
+					 (uint16_t)std::lround(unorm.z * UINT16_MAX),
+					 0 },
+			.color = { (uint8_t)std::lround(color.r * UINT8_MAX),
+					   (uint8_t)std::lround(color.g * UINT8_MAX),
+					   (uint8_t)std::lround(color.b * UINT8_MAX),
+					   UINT8_MAX },
+		};
+	}
+
+	return VertexQuantization{ .scale = extent, .offset = min };
+}
+
+std::vector<uint8_t> packIndices(
+	const std::vector<uint32_t>& indices,
+	const uint32_t vertexCount,
+	VkIndexType& indexType
+) {
+	std::vector<uint8_t> packed;
+	if (vertexCount <= UINT16_MAX + 1) {
+		indexType = VK_INDEX_TYPE_UINT16;
+		packed.resize(indices.size() * sizeof(uint16_t));
+		uint16_t* narrowIndices{ (uint16_t*)packed.data() };
+		for (size_t i{}; i < indices.size(); i++) {
+			narrowIndices[i] = (uint16_t)indices[i];
+		}
+	} else {
+		indexType = VK_INDEX_TYPE_UINT32;
+		packed.resize(indices.size() * sizeof(uint32_t));
+		memcpy(packed.data(), indices.data(), packed.size());
+	}
+
+	return packed;
+}
+
+float getAcmr(
+	const std::vector<uint32_t>& indices,
+	const uint32_t vertexCount,
+	const uint32_t cacheSize
+) {
+	if (indices.empty()) {
+		return 0.f;
+	}
+
+	// fifo, a vertex is cached while fewer than cacheSize misses followed it
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	uint32_t time{ cacheSize + 1 };
+	uint32_t misses{};
+	for (const auto index : indices) {
+		if (time - cacheTimestamps[index] > cacheSize) {
+			cacheTimestamps[index] = time++;
+			misses++;
+		}
+	}
+
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+namespace {
+	ScoreTables makeScoreTables() {
+		ScoreTables tables{};
+		for (uint32_t i{}; i < c_SCORING_CACHE_SIZE; i++) {
+			if (i < 3) {
+				// the last triangle's vertices are deliberately scored lower
+				// so strips do not get stuck on them
+				tables.cache[i] = c_LAST_TRIANGLE_SCORE;
+			} else {
+				float scaler{ 1.f / (c_SCORING_CACHE_SIZE - 3) };
+				tables.cache[i] = std::pow(
+					1.f - (float)(i - 3) * scaler, c_CACHE_DECAY_POWER
+				);
+			}
+		}
+		for (uint32_t i{ 1 }; i < c_MAX_SCORED_VALENCE; i++) {
+			tables.valence[i] = c_VALENCE_BOOST_SCALE *
+				std::pow((float)i, -c_VALENCE_BOOST_POWER);
+		}
+
+		return tables;
+	}
+
+	float getVertexScore(
+		const ScoreTables& tables,
+		const uint32_t cachePosition,
+		const uint32_t liveTriangles
+	) {
+		if (liveTriangles == 0) {
+			return -1.f;
+		}
+
+		float score{ cachePosition != c_NOT_CACHED
+						 ? tables.cache[cachePosition]
+						 : 0.f };
+		// vertices with few triangles left are finished off first
+		score += tables.valence[std::min(
+			liveTriangles, c_MAX_SCORED_VALENCE - 1
+		)];
+
+		return score;
+	}
+}  // namespace
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "Vertex.h"
+
+// cache size the ACMR is reported for, a typical post transform cache
+constexpr uint32_t c_ACMR_CACHE_SIZE{ 16 };
+
+struct MeshOptimizeStats {
+	// average cache miss ratio, transformed vertices per triangle
+	float acmrBefore;
+	float acmrAfter;
+	uint32_t bytesPerVertexBefore;
+	uint32_t bytesPerVertexAfter;
+};
+
+struct OptimizedMesh {
+	std::vector<PackedVertex> vertices;
+	std::vector<uint32_t> indices;
+	VertexQuantization quantization;
+	MeshOptimizeStats stats;
+};
+
+// runs every stage below in order
+OptimizedMesh optimizeMesh(
+	const std::vector<Vertex>& vertices, std::vector<uint32_t> indices
+);
+
+// Forsyth's linear speed vertex cache optimization, reorders triangles so
+// consecutive ones share recently transformed vertices
+void optimizeVertexCache(
+	std::vector<uint32_t>& indices, const uint32_t vertexCount
+);
+// splits the cache optimized order into clusters where the cache starts
+// over and draws clusters facing away from the mesh centre first, so they
+// occlude the rest. the order inside clusters is kept
+void optimizeOverdraw(
+	std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices
+);
+// renumbers vertices in order of first use so fetches walk memory forwards
+std::vector<Vertex> optimizeVertexFetch(
+	std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices
+);
+VertexQuantization quantizeVertices(
+	const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed
+);
+
+// 16 bit indices when every vertex is reachable with them
+std::vector<uint8_t> packIndices(
+	const std::vector<uint32_t>& indices,
+	const uint32_t vertexCount,
+	VkIndexType& indexType
+);
+
+float getAcmr(
+	const std::vector<uint32_t>& indices,
+	const uint32_t vertexCount,
+	const uint32_t cacheSize
+);
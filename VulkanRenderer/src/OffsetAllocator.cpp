@@ -0,0 +1,301 @@
+#include "OffsetAllocator.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+	constexpr uint32_t c_MANTISSA_BITS{ 3 };
+	constexpr uint32_t c_MANTISSA_VALUE{ 1 << c_MANTISSA_BITS };
+	constexpr uint32_t c_MANTISSA_MASK{ c_MANTISSA_VALUE - 1 };
+	constexpr uint32_t c_UNUSED{ UINT32_MAX };
+
+	uint32_t uintToFloatRoundUp(const uint32_t size);
+	uint32_t uintToFloatRoundDown(const uint32_t size);
+	uint32_t findLowestSetBitAfter(const uint32_t mask, const uint32_t start);
+}  // namespace
+
+void OffsetAllocator::init(const uint32_t size, const uint32_t maxAllocations) {
+	m_Size = size;
+	m_MaxAllocations = maxAllocations;
+	reset();
+}
+
+void OffsetAllocator::reset() {
+	m_FreeStorage = 0;
+	m_UsedBinsTop = 0;
+	for (auto& usedBins : m_UsedBins) {
+		usedBins = 0;
+	}
+	for (auto& binIndex : m_BinIndices) {
+		binIndex = c_UNUSED;
+	}
+
+	// maxAllocations + 1 nodes cover the used ranges and the free ranges
+	// between them together, so a fragmented space holds fewer than
+	// maxAllocations allocations. allocate fails once the pool runs out
+	m_Nodes.assign(m_MaxAllocations + 1, Node{});
+	m_FreeNodes.resize(m_MaxAllocations + 1);
+	for (uint32_t i{}; i < m_FreeNodes.size(); i++) {
+		m_FreeNodes[i] = m_MaxAllocations - i;
+	}
+
+	insertNodeIntoBin(m_Size, 0);
+}
+
+OffsetAllocation OffsetAllocator::allocate(const uint32_t size) {
+	// the remainder of the split needs a node
+	if (m_FreeNodes.empty() || size == 0) {
+		return { .offset = c_OFFSET_ALLOCATOR_NO_SPACE, .node = c_UNUSED };
+	}
+
+	// round up so any node in the bin is large enough
+	uint32_t minBinIndex{ uintToFloatRoundUp(size) };
+	uint32_t minTopBinIndex{ minBinIndex >> c_MANTISSA_BITS };
+	uint32_t minLeafBinIndex{ minBinIndex & c_MANTISSA_MASK };
+
+	uint32_t topBinIndex{ minTopBinIndex };
+	uint32_t leafBinIndex{ c_UNUSED };
+	if (m_UsedBinsTop & (1u << topBinIndex)) {
+		leafBinIndex =
+			findLowestSetBitAfter(m_UsedBins[topBinIndex], minLeafBinIndex);
+	}
+	if (leafBinIndex == c_UNUSED) {
+		topBinIndex = findLowestSetBitAfter(m_UsedBinsTop, minTopBinIndex + 1);
+		if (topBinIndex == c_UNUSED) {
+			return { .offset = c_OFFSET_ALLOCATOR_NO_SPACE, .node = c_UNUSED };
+		}
+		// any leaf of a larger top bin fits
+		leafBinIndex = std::countr_zero((uint32_t)m_UsedBins[topBinIndex]);
+	}
+
+	uint32_t binIndex{ (topBinIndex << c_MANTISSA_BITS) | leafBinIndex };
+
+	uint32_t nodeIndex{ m_BinIndices[binIndex] };
+	Node& node{ m_Nodes[nodeIndex] };
+	uint32_t nodeTotalSize{ node.dataSize };
+	node.dataSize = size;
+	node.used = true;
+	m_BinIndices[binIndex] = node.binListNext;
+	if (node.binListNext != c_UNUSED) {
+		m_Nodes[node.binListNext].binListPrev = c_UNUSED;
+	}
+	m_FreeStorage -= nodeTotalSize;
+
+	if (m_BinIndices[binIndex] == c_UNUSED) {
+		m_UsedBins[topBinIndex] &= ~(1u << leafBinIndex);
+		if (m_UsedBins[topBinIndex] == 0) {
+			m_UsedBinsTop &= ~(1u << topBinIndex);
+		}
+	}
+
+	uint32_t remainderSize{ nodeTotalSize - size };
+	if (remainderSize > 0) {
+		uint32_t newNodeIndex{
+			insertNodeIntoBin(remainderSize, node.dataOffset + size)
+		};
+		Node& newNode{ m_Nodes[newNodeIndex] };
+		Node& splitNode{ m_Nodes[nodeIndex] };
+
+		if (splitNode.neighborNext != c_UNUSED) {
+			m_Nodes[splitNode.neighborNext].neighborPrev = newNodeIndex;
+		}
+		newNode.neighborPrev = nodeIndex;
+		newNode.neighborNext = splitNode.neighborNext;
+		splitNode.neighborNext = newNodeIndex;
+	}
+
+	return { .offset = m_Nodes[nodeIndex].dataOffset, .node = nodeIndex };
+}
+
+void OffsetAllocator::free(const OffsetAllocation allocation) {
+	if (allocation.node == c_UNUSED) {
+		return;
+	}
+
+	Node& node{ m_Nodes[allocation.node] };
+	PYX_ENGINE_ASSERT_WARNING(node.used);
+
+	uint32_t offset{ node.dataOffset };
+	uint32_t size{ node.dataSize };
+
+	if (node.neighborPrev != c_UNUSED && !m_Nodes[node.neighborPrev].used) {
+		Node& prevNode{ m_Nodes[node.neighborPrev] };
+		offset = prevNode.dataOffset;
+		size += prevNode.dataSize;
+
+		removeNodeFromBin(node.neighborPrev);
+		node.neighborPrev = prevNode.neighborPrev;
+	}
+
+	if (node.neighborNext != c_UNUSED && !m_Nodes[node.neighborNext].used) {
+		Node& nextNode{ m_Nodes[node.neighborNext] };
+		size += nextNode.dataSize;
+
+		removeNodeFromBin(node.neighborNext);
+		node.neighborNext = nextNode.neighborNext;
+	}
+
+	uint32_t neighborPrev{ node.neighborPrev };
+	uint32_t neighborNext{ node.neighborNext };
+
+	m_FreeNodes.emplace_back(allocation.node);
+
+	uint32_t combinedNodeIndex{ insertNodeIntoBin(size, offset) };
+	if (neighborNext != c_UNUSED) {
+		m_Nodes[combinedNodeIndex].neighborNext = neighborNext;
+		m_Nodes[neighborNext].neighborPrev = combinedNodeIndex;
+	}
+	if (neighborPrev != c_UNUSED) {
+		m_Nodes[combinedNodeIndex].neighborPrev = neighborPrev;
+		m_Nodes[neighborPrev].neighborNext = combinedNodeIndex;
+	}
+}
+
+uint32_t OffsetAllocator::getAllocationSize(const OffsetAllocation allocation
+) const {
+	if (allocation.node == c_UNUSED) {
+		return 0;
+	}
+
+	return m_Nodes[allocation.node].dataSize;
+}
+
+uint32_t OffsetAllocator::getLargestFreeRegion() const {
+	if (m_UsedBinsTop == 0) {
+		return 0;
+	}
+
+	uint32_t topBinIndex{ 31u - std::countl_zero(m_UsedBinsTop) };
+	uint32_t leafBinIndex{
+		31u - std::countl_zero((uint32_t)m_UsedBins[topBinIndex])
+	};
+
+	// the bin only bounds its nodes from below
+	uint32_t largest{};
+	uint32_t nodeIndex{
+		m_BinIndices[(topBinIndex << c_MANTISSA_BITS) | leafBinIndex]
+	};
+	while (nodeIndex != c_UNUSED) {
+		largest = std::max(largest, m_Nodes[nodeIndex].dataSize);
+		nodeIndex = m_Nodes[nodeIndex].binListNext;
+	}
+
+	return largest;
+}
+
+uint32_t OffsetAllocator::insertNodeIntoBin(
+	const uint32_t size, const uint32_t dataOffset
+) {
+	// round down so the node is at least as large as its bin
+	uint32_t binIndex{ uintToFloatRoundDown(size) };
+	uint32_t topBinIndex{ binIndex >> c_MANTISSA_BITS };
+	uint32_t leafBinIndex{ binIndex & c_MANTISSA_MASK };
+
+	if (m_BinIndices[binIndex] == c_UNUSED) {
+		m_UsedBins[topBinIndex] |= 1u << leafBinIndex;
+		m_UsedBinsTop |= 1u << topBinIndex;
+	}
+
+	uint32_t topNodeIndex{ m_BinIndices[binIndex] };
+	uint32_t nodeIndex{ m_FreeNodes.back() };
+	m_FreeNodes.pop_back();
+
+	m_Nodes[nodeIndex] = Node{
+		.dataOffset = dataOffset,
+		.dataSize = size,
+		.binListPrev = c_UNUSED,
+		.binListNext = topNodeIndex,
+		.neighborPrev = c_UNUSED,
+		.neighborNext = c_UNUSED,
+		.used = false,
+	};
+	if (topNodeIndex != c_UNUSED) {
+		m_Nodes[topNodeIndex].binListPrev = nodeIndex;
+	}
+	m_BinIndices[binIndex] = nodeIndex;
+
+	m_FreeStorage += size;
+
+	return nodeIndex;
+}
+
+void OffsetAllocator::removeNodeFromBin(const uint32_t nodeIndex) {
+	Node& node{ m_Nodes[nodeIndex] };
+
+	if (node.binListPrev != c_UNUSED) {
+		m_Nodes[node.binListPrev].binListNext = node.binListNext;
+		if (node.binListNext != c_UNUSED) {
+			m_Nodes[node.binListNext].binListPrev = node.binListPrev;
+		}
+	} else {
+		// head of the bin list
+		uint32_t binIndex{ uintToFloatRoundDown(node.dataSize) };
+		uint32_t topBinIndex{ binIndex >> c_MANTISSA_BITS };
+		uint32_t leafBinIndex{ binIndex & c_MANTISSA_MASK };
+
+		m_BinIndices[binIndex] = node.binListNext;
+		if (node.binListNext != c_UNUSED) {
+			m_Nodes[node.binListNext].binListPrev = c_UNUSED;
+		}
+
+		if (m_BinIndices[binIndex] == c_UNUSED) {
+			m_UsedBins[topBinIndex] &= ~(1u << leafBinIndex);
+			if (m_UsedBins[topBinIndex] == 0) {
+				m_UsedBinsTop &= ~(1u << topBinIndex);
+			}
+		}
+	}
+
+	m_FreeNodes.emplace_back(nodeIndex);
+	m_FreeStorage -= node.dataSize;
+}
+
+namespace {
+	uint32_t uintToFloatRoundUp(const uint32_t size) {
+		if (size < c_MANTISSA_VALUE) {
+			// denormal, the value is the mantissa
+			return size;
+		}
+
+		uint32_t highestSetBit{ 31u - std::countl_zero(size) };
+		uint32_t mantissaStartBit{ highestSetBit - c_MANTISSA_BITS };
+		uint32_t exponent{ mantissaStartBit + 1 };
+		uint32_t mantissa{ (size >> mantissaStartBit) & c_MANTISSA_MASK };
+
+		uint32_t lowBitsMask{ (1u << mantissaStartBit) - 1 };
+		if ((size & lowBitsMask) != 0) {
+			mantissa++;
+		}
+
+		// a mantissa overflow carries into the exponent
+		return (exponent << c_MANTISSA_BITS) + mantissa;
+	}
+
+	uint32_t uintToFloatRoundDown(const uint32_t size) {
+		if (size < c_MANTISSA_VALUE) {
+			return size;
+		}
+
+		uint32_t highestSetBit{ 31u - std::countl_zero(size) };
+		uint32_t mantissaStartBit{ highestSetBit - c_MANTISSA_BITS };
+		uint32_t exponent{ mantissaStartBit + 1 };
+		uint32_t mantissa{ (size >> mantissaStartBit) & c_MANTISSA_MASK };
+
+		return (exponent << c_MANTISSA_BITS) | mantissa;
+	}
+
+	uint32_t findLowestSetBitAfter(const uint32_t mask, const uint32_t start) {
+		if (start >= 32) {
+			return c_UNUSED;
+		}
+
+		uint32_t maskAfterStart{ ~((1u << start) - 1) };
+		uint32_t bitsAfter{ mask & maskAfterStart };
+		if (bitsAfter == 0) {
+			return c_UNUSED;
+		}
+
+		return std::countr_zero(bitsAfter);
+	}
+}  // namespace
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+struct OffsetAllocation {
+	uint32_t offset;
+	// node of the allocation, needed to free it
+	uint32_t node;
+};
+
+constexpr uint32_t c_OFFSET_ALLOCATOR_NO_SPACE{ UINT32_MAX };
+
+// hands out ranges of an abstract [0, size) space, for suballocating large
+// buffers. free ranges are kept in 256 bins keyed by a small float of their
+// size (3 bit mantissa, 5 bit exponent) with a two level bitmask over the
+// bins, so allocate and free are O(1) and freed ranges coalesce with free
+// neighbours immediately. an allocation wastes at most 1/8 of its size to
+// the bin rounding.
+class OffsetAllocator {
+   public:
+	void init(const uint32_t size, const uint32_t maxAllocations);
+	void reset();
+
+	// offset is c_OFFSET_ALLOCATOR_NO_SPACE when nothing fits or every node
+	// is in use
+	OffsetAllocation allocate(const uint32_t size);
+	void free(const OffsetAllocation allocation);
+
+	uint32_t getAllocationSize(const OffsetAllocation allocation) const;
+	uint32_t getFreeStorage() const { return m_FreeStorage; }
+	uint32_t getLargestFreeRegion() const;
+	uint32_t getSize() const { return m_Size; }
+
+   private:
+	struct Node {
+		uint32_t dataOffset;
+		uint32_t dataSize;
+		uint32_t binListPrev;
+		uint32_t binListNext;
+		uint32_t neighborPrev;
+		uint32_t neighborNext;
+		bool used;
+	};
+
+	static constexpr uint32_t c_TOP_BIN_COUNT{ 32 };
+	static constexpr uint32_t c_BINS_PER_LEAF{ 8 };
+	static constexpr uint32_t c_LEAF_BIN_COUNT{ c_TOP_BIN_COUNT *
+												c_BINS_PER_LEAF };
+
+	uint32_t insertNodeIntoBin(const uint32_t size, const uint32_t dataOffset);
+	void removeNodeFromBin(const uint32_t nodeIndex);
+
+	uint32_t m_Size{};
+	uint32_t m_MaxAllocations{};
+	uint32_t m_FreeStorage{};
+
+	uint32_t m_UsedBinsTop{};
+	uint8_t m_UsedBins[c_TOP_BIN_COUNT]{};
+	uint32_t m_BinIndices[c_LEAF_BIN_COUNT]{};
+
+	std::vector<Node> m_Nodes;
+	std::vector<uint32_t> m_FreeNodes;
+};
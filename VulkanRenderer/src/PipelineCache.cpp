@@ -0,0 +1,238 @@
+#include "PipelineCache.h"
+#include "Logger.h"
+#include "Hash.h"
+
+#include <cstring>
+#include <fstream>
+#include <vulkan/vulkan_core.h>
+
+namespace {
+	constexpr uint32_t c_CACHE_MAGIC{ 0x43585950 };	 // "PYXC"
+	constexpr uint32_t c_CACHE_VERSION{ 1 };
+
+	// prepended to the driver blob. the driver only validates its own header
+	// loosely, so the driver version and a checksum are checked here too
+	struct PipelineCacheFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t dataSize;
+		uint64_t dataHash;
+		uint64_t coldCreationNs;
+	};
+
+	bool isCacheCompatible(
+		const VkPhysicalDeviceProperties& props,
+		const PipelineCacheFileHeader& fileHeader,
+		const std::vector<uint8_t>& data
+	);
+}  // namespace
+
+PipelineCache loadPipelineCache(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const std::filesystem::path& path
+) {
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(pDevice, &props);
+
+	PipelineCacheFileHeader fileHeader{};
+	std::vector<uint8_t> data;
+
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (file.is_open()) {
+		size_t fileSize{ (size_t)file.tellg() };
+		file.seekg(0, std::ios::beg);
+
+		if (fileSize >= sizeof(fileHeader)) {
+			file.read((char*)&fileHeader, sizeof(fileHeader));
+			data.resize(fileSize - sizeof(fileHeader));
+			file.read((char*)data.data(), data.size());
+		}
+		file.close();
+	}
+
+	bool warm{ isCacheCompatible(props, fileHeader, data) };
+	if (!warm) {
+		if (!data.empty()) {
+			PYX_ENGINE_INFO(
+				"[PipelineCache] {0} is stale, starting cold", path.string()
+			);
+		}
+		data.clear();
+		fileHeader.coldCreationNs = 0;
+	}
+
+	VkPipelineCacheCreateInfo cacheCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = data.size(),
+		.pInitialData = data.empty() ? nullptr : data.data(),
+	};
+
+	VkPipelineCache handle{};
+	VkResult res{
+		vkCreatePipelineCache(device, &cacheCreateInfo, nullptr, &handle)
+	};
+	if (res != VK_SUCCESS) {
+		PYX_ENGINE_WARNING(
+			"[PipelineCache] driver rejected {0}: {1}", path.string(), (int)res
+		);
+
+		cacheCreateInfo.initialDataSize = 0;
+		cacheCreateInfo.pInitialData = nullptr;
+		VK_CHECK(
+			vkCreatePipelineCache(device, &cacheCreateInfo, nullptr, &handle)
+		);
+		warm = false;
+	}
+
+	PipelineCache cache{
+		.handle = handle,
+		.warm = warm,
+		.coldCreationNs = fileHeader.coldCreationNs,
+	};
+
+	return cache;
+}
+
+void savePipelineCache(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const PipelineCache& cache,
+	const std::filesystem::path& path
+) {
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(pDevice, &props);
+
+	size_t dataSize{};
+	VK_CHECK(vkGetPipelineCacheData(device, cache.handle, &dataSize, nullptr));
+
+	std::vector<uint8_t> data(dataSize);
+	VK_CHECK(
+		vkGetPipelineCacheData(device, cache.handle, &dataSize, data.data())
+	);
+	data.resize(dataSize);
+
+	PipelineCacheFileHeader fileHeader{
+		.magic = c_CACHE_MAGIC,
+		.version = c_CACHE_VERSION,
+		.vendorID = props.vendorID,
+		.deviceID = props.deviceID,
+		.driverVersion = props.driverVersion,
+		.dataSize = data.size(),
+		.dataHash = hashBytes(data.data(), data.size()),
+		.coldCreationNs = cache.warm ? cache.coldCreationNs : cache.creationNs,
+	};
+	memcpy(fileHeader.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+
+	std::filesystem::path tmpPath{ path };
+	tmpPath += ".tmp";
+
+	std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		PYX_ENGINE_WARNING(
+			"[PipelineCache] could not write {0}", tmpPath.string()
+		);
+		return;
+	}
+	file.write((const char*)&fileHeader, sizeof(fileHeader));
+	file.write((const char*)data.data(), data.size());
+	file.close();
+
+	std::error_code error{};
+	std::filesystem::rename(tmpPath, path, error);
+	if (error) {
+		PYX_ENGINE_WARNING(
+			"[PipelineCache] could not replace {0}: {1}",
+			path.string(),
+			error.message()
+		);
+	}
+}
+
+void destroyPipelineCache(const VkDevice device, const PipelineCache& cache) {
+	vkDestroyPipelineCache(device, cache.handle, nullptr);
+}
+
+void mergePipelineCaches(
+	const VkDevice device,
+	const PipelineCache& dstCache,
+	const std::vector<VkPipelineCache>& srcCaches
+) {
+	if (srcCaches.empty()) {
+		return;
+	}
+
+	VK_CHECK(vkMergePipelineCaches(
+		device, dstCache.handle, (uint32_t)srcCaches.size(), srcCaches.data()
+	));
+}
+
+void recordPipelineCreationTime(PipelineCache& cache, const uint64_t ns) {
+	cache.creationNs += ns;
+}
+
+void logPipelineCacheTiming(const PipelineCache& cache) {
+	double creationMs{ cache.creationNs / 1e6 };
+	if (!cache.warm) {
+		PYX_ENGINE_INFO(
+			"[PipelineCache] cold start: pipelines created in {0:.2f}ms",
+			creationMs
+		);
+		return;
+	}
+
+	double coldCreationMs{ cache.coldCreationNs / 1e6 };
+	PYX_ENGINE_INFO(
+		"[PipelineCache] warm start: pipelines created in {0:.2f}ms, cold "
+		"start took {1:.2f}ms ({2:.1f}x)",
+		creationMs,
+		coldCreationMs,
+		creationMs > 0.0 ? coldCreationMs / creationMs : 0.0
+	);
+}
+
+namespace {
+	bool isCacheCompatible(
+		const VkPhysicalDeviceProperties& props,
+		const PipelineCacheFileHeader& fileHeader,
+		const std::vector<uint8_t>& data
+	) {
+		if (fileHeader.magic != c_CACHE_MAGIC ||
+			fileHeader.version != c_CACHE_VERSION ||
+			fileHeader.vendorID != props.vendorID ||
+			fileHeader.deviceID != props.deviceID ||
+			fileHeader.driverVersion != props.driverVersion ||
+			memcmp(
+				fileHeader.pipelineCacheUUID,
+				props.pipelineCacheUUID,
+				VK_UUID_SIZE
+			) != 0) {
+			return false;
+		}
+
+		if (fileHeader.dataSize != data.size() ||
+			fileHeader.dataHash != hashBytes(data.data(), data.size())) {
+			return false;
+		}
+
+		VkPipelineCacheHeaderVersionOne driverHeader{};
+		if (data.size() < sizeof(driverHeader)) {
+			return false;
+		}
+		memcpy(&driverHeader, data.data(), sizeof(driverHeader));
+
+		return driverHeader.headerVersion ==
+			VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			driverHeader.vendorID == props.vendorID &&
+			driverHeader.deviceID == props.deviceID &&
+			memcmp(
+				driverHeader.pipelineCacheUUID,
+				props.pipelineCacheUUID,
+				VK_UUID_SIZE
+			) == 0;
+	}
+}  // namespace
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct PipelineCache {
+	VkPipelineCache handle;
+
+	// loaded from a file that matched this device and driver
+	bool warm;
+
+	// pipeline creation time of the run that created the file
+	uint64_t coldCreationNs;
+	// pipeline creation time of this run
+	uint64_t creationNs;
+};
+
+PipelineCache loadPipelineCache(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const std::filesystem::path& path
+);
+
+// written through a temporary file so a crash never leaves a torn cache
+void savePipelineCache(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const PipelineCache& cache,
+	const std::filesystem::path& path
+);
+
+void destroyPipelineCache(const VkDevice device, const PipelineCache& cache);
+
+void mergePipelineCaches(
+	const VkDevice device,
+	const PipelineCache& dstCache,
+	const std::vector<VkPipelineCache>& srcCaches
+);
+
+void recordPipelineCreationTime(PipelineCache& cache, const uint64_t ns);
+void logPipelineCacheTiming(const PipelineCache& cache);
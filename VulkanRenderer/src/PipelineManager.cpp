@@ -0,0 +1,450 @@
+#include "PipelineManager.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <chrono>
+#include <vulkan/vulkan_core.h>
+
+namespace {
+	VkPipeline buildGraphicsPipeline(
+		const VkDevice device,
+		const VkPipelineCache cache,
+		const GraphicsPipelineDesc& desc
+	);
+	VkPipelineColorBlendAttachmentState getBlendState(const BlendMode blend);
+
+	template<typename T>
+	void hashCombine(size_t& seed, const T& value) {
+		seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+}  // namespace
+
+size_t GraphicsPipelineDescHash::operator()(const GraphicsPipelineDesc& desc
+) const {
+	size_t seed{};
+	hashCombine(seed, (void*)desc.vertexShader);
+	hashCombine(seed, (void*)desc.fragmentShader);
+	hashCombine(seed, (void*)desc.layout);
+	hashCombine(seed, (void*)desc.renderPass);
+	hashCombine(seed, (uint32_t)desc.colorFormat);
+
+	hashCombine(seed, desc.vertexLayout.stride);
+	hashCombine(seed, desc.vertexLayout.attributeCount);
+	for (uint32_t i{}; i < desc.vertexLayout.attributeCount; i++) {
+		const VertexAttribute& attribute{ desc.vertexLayout.attributes[i] };
+		hashCombine(seed, attribute.location);
+		hashCombine(seed, (uint32_t)attribute.format);
+		hashCombine(seed, attribute.offset);
+	}
+
+	hashCombine(seed, (uint32_t)desc.topology);
+	hashCombine(seed, (uint32_t)desc.blend);
+	hashCombine(seed, (uint32_t)desc.polygonMode);
+	hashCombine(seed, (uint32_t)desc.cullMode);
+	hashCombine(seed, (uint32_t)desc.frontFace);
+
+	return seed;
+}
+
+void PipelineManager::init(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const std::filesystem::path& cachePath,
+	const uint32_t framesInFlight
+) {
+	m_PhysicalDevice = pDevice;
+	m_FramesInFlight = framesInFlight;
+	m_Device = device;
+	m_CachePath = cachePath;
+	m_PipelineCache = loadPipelineCache(pDevice, device, cachePath);
+
+	size_t seedSize{};
+	VK_CHECK(vkGetPipelineCacheData(
+		device, m_PipelineCache.handle, &seedSize, nullptr
+	));
+	std::vector<uint8_t> seed(seedSize);
+	VK_CHECK(vkGetPipelineCacheData(
+		device, m_PipelineCache.handle, &seedSize, seed.data()
+	));
+
+	// workers never share a cache, so the driver can skip its locking
+	VkPipelineCacheCreateInfo cacheCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.flags = VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT,
+		.initialDataSize = seedSize,
+		.pInitialData = seed.data(),
+	};
+
+	m_WorkerCaches.resize(ThreadPool::getThreadCount());
+	for (auto& workerCache : m_WorkerCaches) {
+		VK_CHECK(vkCreatePipelineCache(
+			device, &cacheCreateInfo, nullptr, &workerCache
+		));
+	}
+}
+
+void PipelineManager::shutdown() {
+	{
+		std::unique_lock<std::mutex> lock(m_CompiledMutex);
+		m_JobFinished.wait(lock, [&]() { return m_PendingCompiles.empty(); });
+	}
+	update();
+
+	for (const auto& entry : m_Pipelines) {
+		vkDestroyPipeline(m_Device, entry.pipeline, nullptr);
+	}
+	for (const auto& retired : m_RetiredPipelines) {
+		vkDestroyPipeline(m_Device, retired.pipeline, nullptr);
+	}
+	m_Pipelines.clear();
+	m_RetiredPipelines.clear();
+	m_DescToHandle.clear();
+
+	mergePipelineCaches(m_Device, m_PipelineCache, m_WorkerCaches);
+	for (const auto& workerCache : m_WorkerCaches) {
+		vkDestroyPipelineCache(m_Device, workerCache, nullptr);
+	}
+	m_WorkerCaches.clear();
+
+	recordPipelineCreationTime(m_PipelineCache, m_WorkerCompileNs.load());
+	logPipelineCacheTiming(m_PipelineCache);
+
+	savePipelineCache(m_PhysicalDevice, m_Device, m_PipelineCache, m_CachePath);
+	destroyPipelineCache(m_Device, m_PipelineCache);
+}
+
+PipelineHandle PipelineManager::createPipeline(const GraphicsPipelineDesc& desc
+) {
+	auto existing{ m_DescToHandle.find(desc) };
+	if (existing != m_DescToHandle.end()) {
+		return existing->second;
+	}
+
+	auto start{ std::chrono::steady_clock::now() };
+	VkPipeline pipeline{
+		buildGraphicsPipeline(m_Device, m_PipelineCache.handle, desc)
+	};
+	recordPipelineCreationTime(
+		m_PipelineCache,
+		std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start
+		)
+			.count()
+	);
+
+	PipelineHandle handle{ (PipelineHandle)m_Pipelines.size() };
+	m_Pipelines.emplace_back(PipelineEntry{
+		.desc = desc,
+		.pipeline = pipeline,
+		.fallback = c_INVALID_PIPELINE,
+	});
+	m_DescToHandle[desc] = handle;
+
+	return handle;
+}
+
+PipelineHandle PipelineManager::requestPipeline(
+	const GraphicsPipelineDesc& desc, const PipelineHandle fallback
+) {
+	auto existing{ m_DescToHandle.find(desc) };
+	if (existing != m_DescToHandle.end()) {
+		return existing->second;
+	}
+
+	PipelineHandle handle{ (PipelineHandle)m_Pipelines.size() };
+	m_Pipelines.emplace_back(PipelineEntry{
+		.desc = desc,
+		.pipeline = VK_NULL_HANDLE,
+		.fallback = fallback,
+	});
+	m_DescToHandle[desc] = handle;
+
+	compileInBackground(handle);
+
+	return handle;
+}
+
+void PipelineManager::replaceShaderModule(
+	const VkShaderModule oldModule, const VkShaderModule newModule
+) {
+	for (PipelineHandle handle{}; handle < m_Pipelines.size(); handle++) {
+		PipelineEntry& entry{ m_Pipelines[handle] };
+		if (entry.desc.vertexShader != oldModule &&
+			entry.desc.fragmentShader != oldModule) {
+			continue;
+		}
+
+		// two handles can end up with the same desc, the one already indexed
+		// keeps the entry so lookups never switch to a different handle
+		if (auto indexed{ m_DescToHandle.find(entry.desc) };
+			indexed != m_DescToHandle.end() && indexed->second == handle) {
+			m_DescToHandle.erase(indexed);
+		}
+		if (entry.desc.vertexShader == oldModule) {
+			entry.desc.vertexShader = newModule;
+		}
+		if (entry.desc.fragmentShader == oldModule) {
+			entry.desc.fragmentShader = newModule;
+		}
+		m_DescToHandle.try_emplace(entry.desc, handle);
+
+		compileInBackground(handle);
+	}
+}
+
+void PipelineManager::update() {
+	m_FrameCounter++;
+
+	std::vector<CompiledPipeline> compiled;
+	{
+		std::lock_guard<std::mutex> lock(m_CompiledMutex);
+		compiled.swap(m_Compiled);
+	}
+
+	for (const auto& result : compiled) {
+		PipelineEntry& entry{ m_Pipelines[result.handle] };
+		VkPipeline retired{ result.pipeline };
+		if (result.generation == entry.generation) {
+			retired = entry.pipeline;
+			entry.pipeline = result.pipeline;
+		}
+
+		if (retired != VK_NULL_HANDLE) {
+			m_RetiredPipelines.emplace_back(RetiredPipeline{
+				.pipeline = retired,
+				.destroyFrame = m_FrameCounter + m_FramesInFlight,
+			});
+		}
+	}
+
+	std::erase_if(m_RetiredPipelines, [&](const RetiredPipeline& retired) {
+		if (retired.destroyFrame > m_FrameCounter) {
+			return false;
+		}
+		vkDestroyPipeline(m_Device, retired.pipeline, nullptr);
+		return true;
+	});
+}
+
+VkPipeline PipelineManager::getPipeline(const PipelineHandle handle) const {
+	PipelineHandle resolved{ handle };
+	while (resolved != c_INVALID_PIPELINE) {
+		const PipelineEntry& entry{ m_Pipelines[resolved] };
+		if (entry.pipeline != VK_NULL_HANDLE) {
+			return entry.pipeline;
+		}
+		resolved = entry.fallback;
+	}
+
+	return VK_NULL_HANDLE;
+}
+
+bool PipelineManager::isPipelineReady(const PipelineHandle handle) const {
+	return m_Pipelines[handle].pipeline != VK_NULL_HANDLE;
+}
+
+uint64_t PipelineManager::getOldestPendingCompile() {
+	std::lock_guard<std::mutex> lock(m_CompiledMutex);
+	return m_PendingCompiles.empty() ? m_SubmittedCompiles
+									 : *m_PendingCompiles.begin();
+}
+
+void PipelineManager::compileInBackground(const PipelineHandle handle) {
+	uint64_t compile{ m_SubmittedCompiles++ };
+	{
+		std::lock_guard<std::mutex> lock(m_CompiledMutex);
+		m_PendingCompiles.insert(compile);
+	}
+
+	PipelineEntry& entry{ m_Pipelines[handle] };
+	entry.generation++;
+
+	GraphicsPipelineDesc desc{ entry.desc };
+	uint32_t generation{ entry.generation };
+	ThreadPool::submit([this, handle, generation, compile, desc](
+						   uint32_t workerIndex
+					   ) {
+		auto start{ std::chrono::steady_clock::now() };
+		VkPipeline pipeline{
+			buildGraphicsPipeline(m_Device, m_WorkerCaches[workerIndex], desc)
+		};
+		m_WorkerCompileNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+								 std::chrono::steady_clock::now() - start
+		)
+								 .count();
+
+		{
+			std::lock_guard<std::mutex> lock(m_CompiledMutex);
+			m_Compiled.emplace_back(CompiledPipeline{
+				.handle = handle,
+				.generation = generation,
+				.pipeline = pipeline,
+			});
+			m_PendingCompiles.erase(compile);
+		}
+		m_JobFinished.notify_all();
+	});
+}
+
+namespace {
+	VkPipeline buildGraphicsPipeline(
+		const VkDevice device,
+		const VkPipelineCache cache,
+		const GraphicsPipelineDesc& desc
+	) {
+		PYX_TRACE_FUNCTION();
+
+		std::vector<VkDynamicState> dynamicState{ VK_DYNAMIC_STATE_SCISSOR,
+												  VK_DYNAMIC_STATE_VIEWPORT };
+		VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.dynamicStateCount = (uint32_t)dynamicState.size(),
+			.pDynamicStates = dynamicState.data(),
+		};
+
+		VkPipelineViewportStateCreateInfo viewportCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.viewportCount = 1,
+			.scissorCount = 1
+		};
+
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages(2);
+		shaderStages[0] = VkPipelineShaderStageCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = desc.vertexShader,
+			.pName = "main",
+		};
+		shaderStages[1] = VkPipelineShaderStageCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = desc.fragmentShader,
+			.pName = "main",
+		};
+
+		const VertexLayout& vertexLayout{ desc.vertexLayout };
+		VkVertexInputBindingDescription inputBindingDescription{
+			.binding = 0,
+			.stride = vertexLayout.stride,
+			.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+		};
+		std::vector<VkVertexInputAttributeDescription>
+			inputAttributeDescriptions(vertexLayout.attributeCount);
+		for (uint32_t i{}; i < vertexLayout.attributeCount; i++) {
+			inputAttributeDescriptions[i] = {
+				.location = vertexLayout.attributes[i].location,
+				.binding = 0,
+				.format = vertexLayout.attributes[i].format,
+				.offset = vertexLayout.attributes[i].offset,
+			};
+		}
+
+		uint32_t bindingCount{ vertexLayout.stride != 0 ? 1u : 0u };
+		VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.vertexBindingDescriptionCount = bindingCount,
+			.pVertexBindingDescriptions = &inputBindingDescription,
+			.vertexAttributeDescriptionCount =
+				(uint32_t)inputAttributeDescriptions.size(),
+			.pVertexAttributeDescriptions = inputAttributeDescriptions.data()
+		};
+
+		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{
+			getBlendState(desc.blend)
+		};
+		VkPipelineColorBlendStateCreateInfo colorBlendState{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.attachmentCount = 1,
+			.pAttachments = &colorBlendAttachmentState,
+		};
+
+		VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+		};
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{
+			.sType =
+				VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.topology = desc.topology,
+		};
+
+		VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.polygonMode = desc.polygonMode,
+			.cullMode = desc.cullMode,
+			.frontFace = desc.frontFace,
+			.lineWidth = 1.0,
+		};
+
+		VkPipelineRenderingCreateInfo renderingCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &desc.colorFormat,
+		};
+
+		VkGraphicsPipelineCreateInfo pipelineCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = desc.renderPass == VK_NULL_HANDLE ? &renderingCreateInfo
+													   : nullptr,
+			.stageCount = (uint32_t)shaderStages.size(),
+			.pStages = shaderStages.data(),
+			.pVertexInputState = &vertexInputStateCreateInfo,
+			.pInputAssemblyState = &inputAssemblyCreateInfo,
+			.pViewportState = &viewportCreateInfo,
+			.pRasterizationState = &rasterizationStateCreateInfo,
+			.pMultisampleState = &multisampleStateCreateInfo,
+			.pColorBlendState = &colorBlendState,
+			.pDynamicState = &dynamicStateCreateInfo,
+			.layout = desc.layout,
+			.renderPass = desc.renderPass,
+			.subpass = 0
+		};
+
+		VkPipeline pipeline{};
+		VkResult res{ vkCreateGraphicsPipelines(
+			device, cache, 1, &pipelineCreateInfo, nullptr, &pipeline
+		) };
+		if (res != VK_SUCCESS) {
+			PYX_ENGINE_ERROR("could not create graphics pipeline: {0}", (int)res);
+		}
+
+		return pipeline;
+	}
+
+	VkPipelineColorBlendAttachmentState getBlendState(const BlendMode blend) {
+		VkPipelineColorBlendAttachmentState blendState{
+			.blendEnable = VK_FALSE,
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+				VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+				VK_COLOR_COMPONENT_A_BIT
+		};
+
+		switch (blend) {
+			case BlendMode::opaque:
+				break;
+			case BlendMode::alpha:
+				blendState.blendEnable = VK_TRUE;
+				blendState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				blendState.dstColorBlendFactor =
+					VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+				blendState.colorBlendOp = VK_BLEND_OP_ADD;
+				blendState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				blendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+				blendState.alphaBlendOp = VK_BLEND_OP_ADD;
+				break;
+			case BlendMode::additive:
+				blendState.blendEnable = VK_TRUE;
+				blendState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+				blendState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+				blendState.colorBlendOp = VK_BLEND_OP_ADD;
+				blendState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				blendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+				blendState.alphaBlendOp = VK_BLEND_OP_ADD;
+				break;
+		}
+
+		return blendState;
+	}
+}  // namespace
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "PipelineCache.h"
+
+enum class BlendMode : uint8_t {
+	opaque,
+	alpha,
+	additive,
+};
+
+struct VertexAttribute {
+	uint32_t location;
+	VkFormat format;
+	uint32_t offset;
+
+	bool operator==(const VertexAttribute&) const = default;
+};
+
+struct VertexLayout {
+	static constexpr uint32_t MAX_ATTRIBUTES{ 8 };
+
+	// a stride of 0 means no vertex buffer is bound
+	uint32_t stride;
+	uint32_t attributeCount;
+	VertexAttribute attributes[MAX_ATTRIBUTES];
+
+	bool operator==(const VertexLayout&) const = default;
+};
+
+// everything that makes two graphics pipelines different. the shader
+// modules, layout and render pass have to outlive the compile.
+struct GraphicsPipelineDesc {
+	VkShaderModule vertexShader;
+	VkShaderModule fragmentShader;
+	VkPipelineLayout layout;
+
+	// null renders with dynamic rendering into colorFormat
+	VkRenderPass renderPass;
+	VkFormat colorFormat;
+
+	VertexLayout vertexLayout;
+	VkPrimitiveTopology topology;
+	BlendMode blend;
+	VkPolygonMode polygonMode;
+	VkCullModeFlags cullMode;
+	VkFrontFace frontFace;
+
+	bool operator==(const GraphicsPipelineDesc&) const = default;
+};
+
+struct GraphicsPipelineDescHash {
+	size_t operator()(const GraphicsPipelineDesc& desc) const;
+};
+
+using PipelineHandle = uint32_t;
+constexpr PipelineHandle c_INVALID_PIPELINE{ UINT32_MAX };
+
+// identical requests share one pipeline. requested pipelines compile on the
+// thread pool, each worker with its own externally synchronized copy of the
+// disk cache, and resolve to their fallback until update() publishes them.
+class PipelineManager {
+   public:
+	void init(
+		const VkPhysicalDevice pDevice,
+		const VkDevice device,
+		const std::filesystem::path& cachePath,
+		const uint32_t framesInFlight
+	);
+	// merges the worker caches back and writes the cache to disk
+	void shutdown();
+
+	// compiles on the calling thread, meant for fallbacks
+	PipelineHandle createPipeline(const GraphicsPipelineDesc& desc);
+	PipelineHandle requestPipeline(
+		const GraphicsPipelineDesc& desc, const PipelineHandle fallback
+	);
+
+	// recompiles every pipeline built from oldModule in the background. the
+	// current pipelines stay in use until their replacements are published
+	void replaceShaderModule(
+		const VkShaderModule oldModule, const VkShaderModule newModule
+	);
+
+	// publishes pipelines finished by the workers, call once per frame
+	void update();
+
+	VkPipeline getPipeline(const PipelineHandle handle) const;
+	bool isPipelineReady(const PipelineHandle handle) const;
+
+	// background compiles submitted so far, each is numbered in order
+	uint64_t getSubmittedCompiles() const { return m_SubmittedCompiles; }
+	// every compile numbered below this has finished, so shader modules
+	// replaced before it was submitted are no longer referenced
+	uint64_t getOldestPendingCompile();
+
+   private:
+	struct PipelineEntry {
+		GraphicsPipelineDesc desc;
+		VkPipeline pipeline;
+		PipelineHandle fallback;
+		// bumped on every recompile so stale results can be dropped
+		uint32_t generation;
+	};
+	struct CompiledPipeline {
+		PipelineHandle handle;
+		uint32_t generation;
+		VkPipeline pipeline;
+	};
+	struct RetiredPipeline {
+		VkPipeline pipeline;
+		uint64_t destroyFrame;
+	};
+
+	void compileInBackground(const PipelineHandle handle);
+
+	VkPhysicalDevice m_PhysicalDevice{};
+	VkDevice m_Device{};
+	std::filesystem::path m_CachePath;
+	PipelineCache m_PipelineCache{};
+	std::vector<VkPipelineCache> m_WorkerCaches;
+
+	uint32_t m_FramesInFlight{};
+	uint64_t m_FrameCounter{};
+
+	std::vector<PipelineEntry> m_Pipelines;
+	std::vector<RetiredPipeline> m_RetiredPipelines;
+	std::unordered_map<
+		GraphicsPipelineDesc,
+		PipelineHandle,
+		GraphicsPipelineDescHash>
+		m_DescToHandle;
+
+	std::mutex m_CompiledMutex;
+	std::condition_variable m_JobFinished;
+	std::vector<CompiledPipeline> m_Compiled;
+	std::set<uint64_t> m_PendingCompiles;
+	uint64_t m_SubmittedCompiles{};
+	std::atomic<uint64_t> m_WorkerCompileNs{};
+};
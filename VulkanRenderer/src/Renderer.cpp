@@ -8,34 +8,60 @@
 #include <vulkan/vulkan_core.h>
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 
 #include "Logger.h"
 #include "DeletionQueue.h"
 #include "Device.h"
 #include "Swapchain.h"
 
-#include <iostream>
-#include <fstream>
 #include <glm/glm.hpp>
 
 #include "Instance.h"
+#include "AssetArchive.h"
 #include "Memory.h"
+#include "UploadRing.h"
+#include "Transfer.h"
+#include "PipelineManager.h"
+#include "ShaderLibrary.h"
+#include "LayoutCache.h"
+#include "Bindless.h"
+#include "Texture.h"
+#include "Vertex.h"
+#include "Geometry.h"
+#include "MeshImport.h"
+#include "MeshOptimize.h"
+#include "ThreadPool.h"
 #include "Commands.h"
+#include "GpuProfiler.h"
+#include "Trace.h"
 
-struct Vertex {
-	glm::vec3 pos;
-	glm::vec3 color;
+struct SceneMesh {
+	MeshHandle handle;
+	VertexQuantization quantization;
 };
 
 struct FrameState {
 	VkFence renderFinishFence;
 	VkSemaphore renderFinishSemaphore;
 	VkSemaphore imageAvaliableSemaphore;
-
-	VkCommandBuffer cmdBuffer;
 };
 
 namespace {
+	constexpr VkDeviceSize c_UPLOAD_REGION_SIZE{ 8 * 1024 * 1024 };
+	constexpr const char* c_PIPELINE_CACHE_PATH{ "pipeline_cache.bin" };
+	constexpr const char* c_SHADER_DIR{ "shaders" };
+	constexpr const char* c_ASSET_ARCHIVE_PATH{ "assets.pyxa" };
+	constexpr VkDeviceSize c_GEOMETRY_VERTEX_CAPACITY{ 256 * 1024 * 1024 };
+	constexpr VkDeviceSize c_GEOMETRY_INDEX_CAPACITY{ 128 * 1024 * 1024 };
+	constexpr uint32_t c_MAX_MESHES{ 1 << 16 };
+	constexpr float c_MAX_ANISOTROPY{ 16.f };
+	// below two batches of this the draws are recorded inline, secondary
+	// buffers cost more than they save on short scenes
+	constexpr uint32_t c_MIN_DRAWS_PER_BATCH{ 128 };
+
 	struct VulkanState {
 		VkInstance instance;
 		VkDebugUtilsMessengerEXT debugMessenger;
@@ -44,15 +70,29 @@ namespace {
 
 		VkPhysicalDevice pDevice;
 		VkDevice device;
+		VmaAllocator allocator;
 
 		std::unordered_map<QueueFamily, uint32_t> queueFamilyIndices;
 		std::unordered_map<QueueFamily, VkQueue> queues;
-		VkCommandPool cmdPool;
-
-		VkBuffer vertexBuffer;
-		VkDeviceMemory vertexBufferMemory;
+		FrameCommandPools* commandPools;
+		TransferEngine transfer;
+		GpuProfiler* gpuProfiler;
+		VulkanRenderer::FrameTimings timings;
+		// written on cleanup when not empty
+		std::filesystem::path tracePath;
+
+		AssetArchive* archive;
+		UploadRing uploadRing;
+		GeometryBuffer* geometry;
+		MeshImporter* meshImporter;
+		std::vector<SceneMesh> meshes;
+		TextureManager* textureManager;
+		SamplerCache* samplerCache;
+		std::vector<TextureHandle> textures;
 
 		VkSurfaceKHR surface;
+		// no surface or swapchain, the image views are offscreen images
+		bool headless;
 
 		VkSwapchainKHR swapchain;
 		VkExtent2D swapchainExtent;
@@ -60,22 +100,49 @@ namespace {
 
 		std::vector<VkFramebuffer> framebuffers;
 
-		VkPipeline pipeline;
+		ShaderLibrary* shaderLibrary;
+		BindlessHeap* bindlessHeap;
+		LayoutCache* layoutCache;
+		PipelineManager* pipelineManager;
+		PipelineHandle pipeline;
 		VkPipelineLayout pipelineLayout;
 		VkRenderPass renderPass;
 
 		static constexpr uint32_t FRAMES_IN_FLIGHT{ 2 };
 		std::array<FrameState, FRAMES_IN_FLIGHT> frames;
+		uint64_t frameNumber;
 	};
 
 	VulkanState* s_State{ nullptr };
 
+	// draws the meshes in [begin, end), binds everything it needs so it works
+	// the same in the primary and in secondaries
+	void recordDraws(
+		const VkCommandBuffer cmdBuffer,
+		const VkPipeline pipeline,
+		const uint32_t begin,
+		const uint32_t end
+	);
 }  // namespace
 
-void VulkanRenderer::init(SDL_Window* window) {
+void VulkanRenderer::init(
+	SDL_Window* window,
+	const uint32_t headlessWidth,
+	const uint32_t headlessHeight
+) {
 	PYX_ENGINE_ASSERT_WARNING(s_State == nullptr);
 	Logger::init();
 
+	// PYX_TRACE=<path> captures cpu zones from here until cleanup, only
+	// internal builds record them
+	std::filesystem::path tracePath{};
+	if (const char* path{ std::getenv("PYX_TRACE") }; path != nullptr) {
+		tracePath = path;
+		Trace::beginCapture();
+	}
+	PYX_TRACE_THREAD("main");
+	PYX_TRACE_FUNCTION();
+
 	// VkInstance, VkDebugUtilsMessengerEXT
 	auto [instance, debugMessenger]{ createInstance(window) };
 
@@ -84,12 +151,17 @@ void VulkanRenderer::init(SDL_Window* window) {
 		deleteInstance(instance, debugMessenger);
 	});
 
+	// without a surface nothing is presented, devices that cannot present
+	// such as cpu implementations are fine
+	bool headless{ window == nullptr };
 	VkSurfaceKHR surface{};
-	SDL_Vulkan_CreateSurface(window, instance, &surface);
+	if (!headless) {
+		SDL_Vulkan_CreateSurface(window, instance, &surface);
 
-	objectDeletionQueue.pushDeleter([=]() {
-		vkDestroySurfaceKHR(instance, surface, nullptr);
-	});
+		objectDeletionQueue.pushDeleter([=]() {
+			vkDestroySurfaceKHR(instance, surface, nullptr);
+		});
+	}
 
 	VkPhysicalDevice pDevice{ findSuitablePhysicalDevice(instance, surface) };
 	std::unordered_map<QueueFamily, uint32_t> queueFamilyIndices{
@@ -103,218 +175,164 @@ void VulkanRenderer::init(SDL_Window* window) {
 		vkDestroyDevice(device, nullptr);
 	});
 
-	VkSurfaceCapabilitiesKHR surfaceCapabilities{};
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
-		pDevice, surface, &surfaceCapabilities
-	);
-
-	SwapchainInfo swapchainInfo{ createSwapchain(
-		pDevice, device, surface, window, VulkanState::FRAMES_IN_FLIGHT
+	VmaAllocator allocator{ createAllocator(
+		instance,
+		pDevice,
+		device,
+		isDeviceExtensionSupported(pDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)
 	) };
+	objectDeletionQueue.pushDeleter([=]() {
+		logMemoryStats(allocator);
+		destroyAllocator(allocator);
+	});
 
-	uint64_t swapchainDeleterHandle{ objectDeletionQueue.pushDeleter([=]() {
-		deleteSwapchain(
-			device, swapchainInfo.swapchain, swapchainInfo.imageViews
-		);
-	}) };
-
-	std::unordered_map<QueueFamily, VkQueue> queues;
-	for (const auto& index : queueFamilyIndices) {
-		VkQueue queue{};
-		vkGetDeviceQueue(device, index.second, 0, &queue);
-		queues[index.first] = queue;
+	// pinning keeps workers off each other's caches, set PYX_PIN_WORKERS=1
+	const char* pinWorkers{ std::getenv("PYX_PIN_WORKERS") };
+	ThreadPool::init(0, pinWorkers != nullptr && pinWorkers[0] == '1');
+	objectDeletionQueue.pushDeleter([=]() { ThreadPool::shutdown(); });
+
+	// next to the executable, so launching from another directory still
+	// finds the loose binaries and the cooked archive
+	std::filesystem::path baseDir{};
+	char* basePath{ SDL_GetBasePath() };
+	if (basePath != nullptr) {
+		baseDir = basePath;
+		SDL_free(basePath);
 	}
 
-	VkDescriptorPoolSize dPoolSize{ .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-									.descriptorCount = 1 };
-
-	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-		.maxSets = 1,
-		.poolSizeCount = 1,
-		.pPoolSizes = &dPoolSize
-	};
-
-	VkDescriptorPool descriptorPool{};
-	vkCreateDescriptorPool(
-		device, &descriptorPoolCreateInfo, nullptr, &descriptorPool
-	);
+	// optional, everything it holds can also be loaded from loose files.
+	// outlives every user of its payloads
+	AssetArchive* archive{ new AssetArchive{} };
+	if (!archive->open(baseDir / c_ASSET_ARCHIVE_PATH)) {
+		PYX_ENGINE_INFO("[Assets] no cooked archive, using loose files");
+	}
 	objectDeletionQueue.pushDeleter([=]() {
-		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		archive->close();
+		delete archive;
 	});
 
-	VkDescriptorSetLayoutBinding setLayoutBinding{
-		.binding = 0,
-		.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-		.descriptorCount = 1,
-		.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
-	};
-
-	VkDescriptorSetLayoutCreateInfo descriptorSetLayout{
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-	};
-
-	VkDescriptorSetAllocateInfo dSetAllocInfo{
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-		.descriptorPool = descriptorPool,
-		.descriptorSetCount = 1,
-	};
-
-	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-	};
-	VkPipelineLayout pipelineLayout{};
-	VkResult res{ vkCreatePipelineLayout(
-		device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout
-	) };
-
-	if (res != VK_SUCCESS) {
-		std::cout << "could not create pipeline layout" << std::endl;
+	ShaderLibrary* shaderLibrary{ new ShaderLibrary{} };
+	shaderLibrary->init(device, baseDir / c_SHADER_DIR);
+	if (archive->isOpen()) {
+		shaderLibrary->setArchive(archive);
 	}
+#ifdef INTERNAL_BUILD
+	shaderLibrary->startWatching();
+#endif
+	objectDeletionQueue.pushDeleter([=]() {
+		shaderLibrary->shutdown();
+		delete shaderLibrary;
+	});
 
-	std::vector<VkDynamicState> dynamicState{ VK_DYNAMIC_STATE_SCISSOR,
-											  VK_DYNAMIC_STATE_VIEWPORT };
-	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-		.dynamicStateCount = (uint32_t)dynamicState.size(),
-		.pDynamicStates = dynamicState.data(),
-	};
-
-	VkPipelineViewportStateCreateInfo viewportCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-		.viewportCount = 1,
-		.scissorCount = 1
-	};
-
-	std::vector<uint32_t> vShaderBytes;
-	std::vector<uint32_t> fShaderBytes;
+	BindlessHeap* bindlessHeap{ new BindlessHeap{} };
+	bindlessHeap->init(pDevice, device, VulkanState::FRAMES_IN_FLIGHT);
+	objectDeletionQueue.pushDeleter([=]() {
+		bindlessHeap->shutdown();
+		delete bindlessHeap;
+	});
 
-	std::ifstream vShaderFile(
-		"shaders/First.vert.spv", std::ios::binary | std::ios::ate
+	// outlives the pipeline manager, queued compiles still reference layouts
+	LayoutCache* layoutCache{ new LayoutCache{} };
+	layoutCache->init(device);
+	layoutCache->setGlobalSetLayout(
+		bindlessHeap->getSetLayout(), bindlessHeap->getBindings()
 	);
-	if (vShaderFile.is_open()) {
-		uint32_t vShaderSize{ (uint32_t)vShaderFile.tellg() };
-		vShaderFile.seekg(0, std::ios::beg);
-
-		vShaderBytes = std::vector<uint32_t>(vShaderSize);
-		vShaderFile.read((char*)vShaderBytes.data(), vShaderSize);
+	objectDeletionQueue.pushDeleter([=]() {
+		layoutCache->shutdown();
+		delete layoutCache;
+	});
 
-		vShaderFile.close();
-	}
-	std::ifstream fShaderFile(
-		"shaders/First.frag.spv", std::ios::binary | std::ios::ate
+	PipelineManager* pipelineManager{ new PipelineManager{} };
+	pipelineManager->init(
+		pDevice, device, c_PIPELINE_CACHE_PATH, VulkanState::FRAMES_IN_FLIGHT
 	);
-	if (fShaderFile.is_open()) {
-		uint32_t fShaderSize{ (uint32_t)fShaderFile.tellg() };
-		fShaderFile.seekg(0, std::ios::beg);
-
-		fShaderBytes = std::vector<uint32_t>(fShaderSize);
-		fShaderFile.read((char*)fShaderBytes.data(), fShaderSize);
+	objectDeletionQueue.pushDeleter([=]() {
+		pipelineManager->shutdown();
+		delete pipelineManager;
+	});
 
-		fShaderFile.close();
-	}
+	// headless frames render into an offscreen image per frame in flight,
+	// which takes the place of the swapchain images
+	SwapchainInfo swapchainInfo{};
+	if (headless) {
+		OffscreenTargets offscreen{ createOffscreenTargets(
+			allocator,
+			device,
+			VkExtent2D{ headlessWidth, headlessHeight },
+			VulkanState::FRAMES_IN_FLIGHT
+		) };
+		objectDeletionQueue.pushDeleter([=]() {
+			deleteOffscreenTargets(allocator, device, offscreen);
+		});
 
-	VkShaderModuleCreateInfo vShaderModuleCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-		.codeSize = vShaderBytes.size(),
-		.pCode = vShaderBytes.data(),
-	};
+		swapchainInfo = SwapchainInfo{
+			.swapchain = VK_NULL_HANDLE,
+			.imageViews = offscreen.imageViews,
+			.extent = offscreen.extent,
+			.format = offscreen.format,
+		};
+	} else {
+		VkSurfaceCapabilitiesKHR surfaceCapabilities{};
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+			pDevice, surface, &surfaceCapabilities
+		);
 
-	VkShaderModuleCreateInfo fShaderModuleCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-		.codeSize = fShaderBytes.size(),
-		.pCode = fShaderBytes.data(),
-	};
+		swapchainInfo = createSwapchain(
+			pDevice, device, surface, window, VulkanState::FRAMES_IN_FLIGHT
+		);
 
-	VkShaderModule vShaderModule{};
-	VkShaderModule fShaderModule{};
-	res = vkCreateShaderModule(
-		device, &vShaderModuleCreateInfo, nullptr, &vShaderModule
-	);
-	if (res != VK_SUCCESS) {
-		std::cout << "couldnt create vertex shader module" << std::endl;
-	}
-	vkCreateShaderModule(
-		device, &fShaderModuleCreateInfo, nullptr, &fShaderModule
-	);
-	if (res != VK_SUCCESS) {
-		std::cout << "couldnt create fragment shader module" << std::endl;
+		objectDeletionQueue.pushDeleter([=]() {
+			deleteSwapchain(
+				device, swapchainInfo.swapchain, swapchainInfo.imageViews
+			);
+		});
 	}
 
-	std::vector<VkPipelineShaderStageCreateInfo> shaderStages(2);
-	shaderStages[0] = VkPipelineShaderStageCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_VERTEX_BIT,
-		.module = vShaderModule,
-		.pName = "main",
-	};
-	shaderStages[1] = VkPipelineShaderStageCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-		.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-		.module = fShaderModule,
-		.pName = "main",
-	};
+	std::unordered_map<QueueFamily, VkQueue> queues;
+	for (const auto& index : queueFamilyIndices) {
+		VkQueue queue{};
+		vkGetDeviceQueue(device, index.second, 0, &queue);
+		queues[index.first] = queue;
+	}
 
-	VkVertexInputBindingDescription inputBindingDescription{
-		.binding = 0,
-		.stride = sizeof(Vertex),
-		.inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-	};
-	std::vector<VkVertexInputAttributeDescription> inputAttributeDescriptions(2
+	// createLogicalDevice enables both features when they are supported
+	VkPhysicalDeviceFeatures deviceFeatures{};
+	vkGetPhysicalDeviceFeatures(pDevice, &deviceFeatures);
+	GpuProfiler* gpuProfiler{ new GpuProfiler{} };
+	gpuProfiler->init(
+		pDevice,
+		device,
+		queueFamilyIndices.at(QueueFamily::graphics),
+		VulkanState::FRAMES_IN_FLIGHT,
+		deviceFeatures.pipelineStatisticsQuery &&
+			deviceFeatures.inheritedQueries
 	);
-	inputAttributeDescriptions[0] = { .location = 0,
-									  .binding = 0,
-									  .format = VK_FORMAT_R32G32B32_SFLOAT,
-									  .offset = offsetof(Vertex, pos) };
-	inputAttributeDescriptions[1] = { .location = 1,
-									  .binding = 0,
-									  .format = VK_FORMAT_R32G32B32_SFLOAT,
-									  .offset = offsetof(Vertex, color) };
-
-	VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		.vertexBindingDescriptionCount = 1,
-		.pVertexBindingDescriptions = &inputBindingDescription,
-		.vertexAttributeDescriptionCount =
-			(uint32_t)inputAttributeDescriptions.size(),
-		.pVertexAttributeDescriptions = inputAttributeDescriptions.data()
-	};
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachmentState{
-		.blendEnable = VK_TRUE,
-		.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-		.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-		.colorBlendOp = VK_BLEND_OP_ADD,
-		.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-		.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-		.alphaBlendOp = VK_BLEND_OP_ADD,
-		.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-			VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-	};
-
-	VkPipelineColorBlendStateCreateInfo colorBlendState{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-		.attachmentCount = 1,
-		.pAttachments = &colorBlendAttachmentState,
-	};
+	objectDeletionQueue.pushDeleter([=]() {
+		gpuProfiler->shutdown();
+		delete gpuProfiler;
+	});
 
-	VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-		.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-	};
+	TransferEngine transfer{ createTransferEngine(
+		device,
+		queueFamilyIndices.at(QueueFamily::transfer),
+		queues.at(QueueFamily::transfer),
+		queueFamilyIndices.at(QueueFamily::graphics)
+	) };
+	objectDeletionQueue.pushDeleter([=]() { destroyTransferEngine(transfer); }
+	);
 
-	VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-	};
+	VkShaderModule vShaderModule{ shaderLibrary->loadShader("Pulled.vert.spv") };
+	VkShaderModule fShaderModule{ shaderLibrary->loadShader("First.frag.spv") };
+	PYX_ENGINE_ASSERT_ERROR(vShaderModule != VK_NULL_HANDLE);
+	PYX_ENGINE_ASSERT_ERROR(fShaderModule != VK_NULL_HANDLE);
 
-	VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-		.polygonMode = VK_POLYGON_MODE_FILL,
-		.cullMode = VK_CULL_MODE_BACK_BIT,
-		.frontFace = VK_FRONT_FACE_CLOCKWISE,
-		.lineWidth = 1.0,
+	const ShaderReflection* vShaderReflection{
+		shaderLibrary->getReflection("Pulled.vert.spv")
 	};
+	VkPipelineLayout pipelineLayout{ layoutCache->getPipelineLayout(
+		{ vShaderReflection, shaderLibrary->getReflection("First.frag.spv") }
+	) };
+	PYX_ENGINE_ASSERT_ERROR(pipelineLayout != VK_NULL_HANDLE);
 
 	VkAttachmentDescription imageAttachment{
 		.format = swapchainInfo.format,
@@ -324,7 +342,9 @@ void VulkanRenderer::init(SDL_Window* window) {
 		.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 		.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 		.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+		// offscreen images are left ready to be copied from
+		.finalLayout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+								: VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
 	};
 
 	VkAttachmentReference imageAttachmentRefrence{
@@ -357,63 +377,54 @@ void VulkanRenderer::init(SDL_Window* window) {
 	};
 
 	VkRenderPass renderPass{};
-	res =
-		vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass);
+	VkResult res{
+		vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass)
+	};
 	if (res != VK_SUCCESS) {
-		std::cout << "could not create render pass" << std::endl;
+		PYX_ENGINE_ERROR("could not create render pass: {0}", (int)res);
 	}
 
-	VkGraphicsPipelineCreateInfo pipelineCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-		.stageCount = (uint32_t)shaderStages.size(),
-		.pStages = shaderStages.data(),
-		.pVertexInputState = &vertexInputStateCreateInfo,
-		.pInputAssemblyState = &inputAssemblyCreateInfo,
-		.pViewportState = &viewportCreateInfo,
-		.pRasterizationState = &rasterizationStateCreateInfo,
-		.pMultisampleState = &multisampleStateCreateInfo,
-		.pColorBlendState = &colorBlendState,
-		.pDynamicState = &dynamicStateCreateInfo,
+	GraphicsPipelineDesc pipelineDesc{
+		.vertexShader = vShaderModule,
+		.fragmentShader = fShaderModule,
 		.layout = pipelineLayout,
 		.renderPass = renderPass,
-		.subpass = 0
+		.colorFormat = swapchainInfo.format,
+		// no vertex layout, vertices are pulled through their device address
+		.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+		.blend = BlendMode::alpha,
+		.polygonMode = VK_POLYGON_MODE_FILL,
+		.cullMode = VK_CULL_MODE_BACK_BIT,
+		.frontFace = VK_FRONT_FACE_CLOCKWISE,
 	};
 
-	VkPipeline firstGraphicsPipeline{};
-	res = vkCreateGraphicsPipelines(
-		device, 0, 1, &pipelineCreateInfo, nullptr, &firstGraphicsPipeline
+	PYX_ENGINE_ASSERT_ERROR(
+		validateVertexLayout(*vShaderReflection, pipelineDesc.vertexLayout)
 	);
+
+	// compiled up front, it is the fallback for every pipeline requested
+	// later
+	PipelineHandle firstGraphicsPipeline{
+		pipelineManager->createPipeline(pipelineDesc)
+	};
 	objectDeletionQueue.pushDeleter([=]() {
-		vkDestroyPipeline(device, firstGraphicsPipeline, nullptr);
-		vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
 		vkDestroyRenderPass(device, renderPass, nullptr);
 	});
 
-	VkCommandPoolCreateInfo cmdPoolCreateInfo{
-		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-		.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-		.queueFamilyIndex = queueFamilyIndices[QueueFamily::graphics],
-	};
-
-	VkCommandPool cmdPool{};
-	res = vkCreateCommandPool(device, &cmdPoolCreateInfo, nullptr, &cmdPool);
-	if (res != VK_SUCCESS) {
-		std::cout << "could not create command pool" << std::endl;
-	}
+	// one pool per thread that records and frame in flight
+	FrameCommandPools* commandPools{ new FrameCommandPools{} };
+	commandPools->init(
+		device,
+		queueFamilyIndices[QueueFamily::graphics],
+		ThreadPool::getThreadCount(),
+		VulkanState::FRAMES_IN_FLIGHT
+	);
 	objectDeletionQueue.pushDeleter([=]() {
-		vkDestroyCommandPool(device, cmdPool, nullptr);
+		commandPools->shutdown();
+		delete commandPools;
 	});
 
-	VkCommandBufferAllocateInfo cmdBufferAllocInfo{
-		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-		.commandPool = cmdPool,
-		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-		.commandBufferCount = VulkanState::FRAMES_IN_FLIGHT,
-	};
 	std::array<FrameState, VulkanState::FRAMES_IN_FLIGHT> frames;
-	std::array<VkCommandBuffer, VulkanState::FRAMES_IN_FLIGHT> cmdBuffers;
-	vkAllocateCommandBuffers(device, &cmdBufferAllocInfo, cmdBuffers.data());
-
 	VkFenceCreateInfo fenceCreateInfo{ .sType =
 										   VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
 									   .flags = VK_FENCE_CREATE_SIGNALED_BIT };
@@ -443,64 +454,150 @@ void VulkanRenderer::init(SDL_Window* window) {
 			.renderFinishFence = renderFinishFence,
 			.renderFinishSemaphore = renderFinishSemaphore,
 			.imageAvaliableSemaphore = imageAvaliableSemaphore,
-			.cmdBuffer = cmdBuffers[i],
 		};
 		frames[i] = fState;
 	}
 
-	if (res != VK_SUCCESS) {
-		std::cout << "could not create graphics pipeline" << std::endl;
-	}
-
-	Vertex vertexData[3]{
-		{ .pos = { -0.5f, 0.6f, 1.f }, .color = { 1.f, 0.f, 0.f } },
-		{ .pos = { 0.f, -0.5f, 1.f }, .color = { 0.f, 1.f, 0.f } },
-		{ .pos = { 0.5f, 0.5f, 1.f }, .color = { 0.f, 0.f, 1.f } },
-	};
-
-	BufferInfo stagingBuffer{ createBuffer(
+	UploadRing uploadRing{ createUploadRing(
 		pDevice,
-		device,
-		sizeof(vertexData),
-		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		allocator,
+		c_UPLOAD_REGION_SIZE,
+		VulkanState::FRAMES_IN_FLIGHT
 	) };
+	objectDeletionQueue.pushDeleter([=]() {
+		destroyUploadRing(allocator, uploadRing);
+	});
 
-	BufferInfo vertexBuffer{ createBuffer(
-		pDevice,
+	GeometryBuffer* geometry{ new GeometryBuffer{} };
+	geometry->init(
+		allocator,
 		device,
-		sizeof(vertexData),
-		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-	) };
+		c_GEOMETRY_VERTEX_CAPACITY,
+		c_GEOMETRY_INDEX_CAPACITY,
+		c_MAX_MESHES,
+		VulkanState::FRAMES_IN_FLIGHT
+	);
+	objectDeletionQueue.pushDeleter([=]() {
+		geometry->shutdown();
+		delete geometry;
+	});
 
+	// running imports reference the importer, it waits for them before the
+	// thread pool shuts down
+	MeshImporter* meshImporter{ new MeshImporter{} };
 	objectDeletionQueue.pushDeleter([=]() {
-		destroyBuffer(device, stagingBuffer);
-		destroyBuffer(device, vertexBuffer);
+		meshImporter->shutdown();
+		delete meshImporter;
 	});
 
-	void* mappedStageMemory{};
-	vkMapMemory(
-		device,
-		stagingBuffer.memory,
-		0,
-		sizeof(vertexData),
-		0,
-		&mappedStageMemory
+	// decodes reference the manager, it waits for them like the importer
+	TextureManager* textureManager{ new TextureManager{} };
+	textureManager->init(
+		pDevice, device, allocator, bindlessHeap, VulkanState::FRAMES_IN_FLIGHT
 	);
-	memcpy(mappedStageMemory, vertexData, sizeof(vertexData));
-	vkUnmapMemory(device, stagingBuffer.memory);
+	objectDeletionQueue.pushDeleter([=]() {
+		textureManager->shutdown();
+		delete textureManager;
+	});
+	// in MiB, without it textures are only limited by the heap budget
+	if (const char* budget{ std::getenv("PYX_TEXTURE_BUDGET") };
+		budget != nullptr) {
+		textureManager->setBudget(
+			(VkDeviceSize)std::strtoull(budget, nullptr, 10) * 1024 * 1024
+		);
+	}
 
-	copyBuffer(
-		device,
-		queueFamilyIndices.at(QueueFamily::graphics),
-		queues.at(QueueFamily::graphics),
-		stagingBuffer.handle,
-		vertexBuffer.handle,
-		sizeof(vertexData)
-	);
+	SamplerCache* samplerCache{ new SamplerCache{} };
+	samplerCache->init(pDevice, device, bindlessHeap);
+	objectDeletionQueue.pushDeleter([=]() {
+		samplerCache->shutdown();
+		delete samplerCache;
+	});
+	samplerCache->getSampler(SamplerDesc{
+		.filter = VK_FILTER_LINEAR,
+		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+		.addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+		.maxAnisotropy = c_MAX_ANISOTROPY,
+	});
+
+	Vertex vertexData[3]{
+		{ .pos = { -0.5f, 0.6f, 1.f }, .color = { 1.f, 0.f, 0.f } },
+		{ .pos = { 0.f, -0.5f, 1.f }, .color = { 0.f, 1.f, 0.f } },
+		{ .pos = { 0.5f, 0.5f, 1.f }, .color = { 0.f, 0.f, 1.f } },
+	};
+	OptimizedMesh triangle{ optimizeMesh(
+		std::vector<Vertex>(std::begin(vertexData), std::end(vertexData)),
+		{ 0, 1, 2 }
+	) };
+
+	// streamed by the first frame
+	VkIndexType triangleIndexType{};
+	std::vector<uint8_t> triangleIndices{ packIndices(
+		triangle.indices, (uint32_t)triangle.vertices.size(), triangleIndexType
+	) };
+	SceneMesh triangleMesh{
+		.handle = geometry->addMesh(
+			std::vector<uint8_t>(
+				(uint8_t*)triangle.vertices.data(),
+				(uint8_t*)(triangle.vertices.data() + triangle.vertices.size())
+			),
+			sizeof(PackedVertex),
+			std::move(triangleIndices),
+			triangleIndexType
+		),
+		.quantization = triangle.quantization,
+	};
+	std::vector<SceneMesh> meshes{ triangleMesh };
+
+	// cooked meshes and textures are streamed straight out of the mapping,
+	// compressed meshes arrive through the importer once decoded
+	std::vector<TextureHandle> textures;
+	for (const auto& entry : archive->getEntries()) {
+		if (entry.type == AssetType::texture) {
+			TextureHandle handle{ textureManager->addTexture(
+				archive->getPayload(entry),
+				entry.texture.width,
+				entry.texture.height,
+				entry.texture.format,
+				entry.texture.mipCount
+			) };
+			if (handle != c_INVALID_TEXTURE) {
+				textures.emplace_back(handle);
+			}
+			continue;
+		}
+		if (entry.type != AssetType::mesh) {
+			continue;
+		}
+		if ((entry.flags & c_ASSET_FLAG_COMPRESSED) != 0) {
+			meshImporter->requestDecode(
+				std::string{ archive->getName(entry) },
+				entry.mesh,
+				archive->getMeshVertices(entry),
+				archive->getMeshIndices(entry)
+			);
+			continue;
+		}
+		MeshHandle handle{ geometry->addMesh(
+			archive->getMeshVertices(entry),
+			entry.mesh.vertexStride,
+			archive->getMeshIndices(entry),
+			entry.mesh.indexType
+		) };
+		if (handle != c_INVALID_MESH) {
+			meshes.emplace_back(SceneMesh{
+				.handle = handle,
+				.quantization = VertexQuantization{
+					.scale = glm::vec3{ entry.mesh.positionScale[0],
+										entry.mesh.positionScale[1],
+										entry.mesh.positionScale[2] },
+					.offset = glm::vec3{ entry.mesh.positionOffset[0],
+										 entry.mesh.positionOffset[1],
+										 entry.mesh.positionOffset[2] },
+				},
+			});
+		}
+	}
 
 	std::vector<VkFramebuffer> framebuffers;
 	framebuffers.reserve(swapchainInfo.imageViews.size());
@@ -528,25 +625,37 @@ void VulkanRenderer::init(SDL_Window* window) {
 		}
 	});
 
-	vkDestroyShaderModule(device, vShaderModule, nullptr);
-	vkDestroyShaderModule(device, fShaderModule, nullptr);
-
 	s_State = new VulkanState{
 		.instance = instance,
 		.debugMessenger = debugMessenger,
 		.objectDeletionQueue = objectDeletionQueue,
 		.pDevice = pDevice,
 		.device = device,
+		.allocator = allocator,
 		.queueFamilyIndices = std::move(queueFamilyIndices),
 		.queues = std::move(queues),
-		.cmdPool = cmdPool,
-		.vertexBuffer = vertexBuffer.handle,
-		.vertexBufferMemory = vertexBuffer.memory,
+		.commandPools = commandPools,
+		.transfer = transfer,
+		.gpuProfiler = gpuProfiler,
+		.tracePath = tracePath,
+		.archive = archive,
+		.uploadRing = uploadRing,
+		.geometry = geometry,
+		.meshImporter = meshImporter,
+		.meshes = std::move(meshes),
+		.textureManager = textureManager,
+		.samplerCache = samplerCache,
+		.textures = std::move(textures),
 		.surface = surface,
+		.headless = headless,
 		.swapchain = swapchainInfo.swapchain,
 		.swapchainExtent = swapchainInfo.extent,
 		.swapchainImageViews = swapchainInfo.imageViews,
 		.framebuffers = framebuffers,
+		.shaderLibrary = shaderLibrary,
+		.bindlessHeap = bindlessHeap,
+		.layoutCache = layoutCache,
+		.pipelineManager = pipelineManager,
 		.pipeline = firstGraphicsPipeline,
 		.pipelineLayout = pipelineLayout,
 		.renderPass = renderPass,
@@ -555,17 +664,66 @@ void VulkanRenderer::init(SDL_Window* window) {
 }
 
 void VulkanRenderer::renderFrame() {
+	PYX_TRACE_FUNCTION();
+
 	uint32_t swapchainImageIndex{};
 	VkResult res{};
+	using Clock = std::chrono::steady_clock;
 
-	for (size_t frameIndex{}; frameIndex < VulkanState::FRAMES_IN_FLIGHT;
-		 frameIndex++) {
-		FrameState& frame{ s_State->frames[frameIndex] };
+	size_t frameIndex{ s_State->frameNumber % VulkanState::FRAMES_IN_FLIGHT };
+	s_State->frameNumber++;
+
+	FrameState& frame{ s_State->frames[frameIndex] };
+	{
+		PYX_TRACE_ZONE("fence wait");
+		Clock::time_point fenceWaitStart{ Clock::now() };
 		vkWaitForFences(
 			s_State->device, 1, &frame.renderFinishFence, VK_TRUE, UINT64_MAX
 		);
-		vkResetFences(s_State->device, 1, &frame.renderFinishFence);
+		std::chrono::duration<double, std::milli> fenceWait{
+			Clock::now() - fenceWaitStart
+		};
+		s_State->timings.fenceWaitMs = fenceWait.count();
+	}
+	vkResetFences(s_State->device, 1, &frame.renderFinishFence);
+	s_State->commandPools->beginFrame((uint32_t)frameIndex);
+
+	beginUploadRegion(s_State->uploadRing, frameIndex);
 
+	std::vector<ShaderReload> reloads{
+		s_State->shaderLibrary->pollReloads(*s_State->pipelineManager)
+	};
+	for (const auto& reload : reloads) {
+		s_State->pipelineManager->replaceShaderModule(
+			reload.oldModule, reload.newModule
+		);
+	}
+	s_State->pipelineManager->update();
+	s_State->bindlessHeap->update();
+	for (auto& result : s_State->meshImporter->pollCompleted()) {
+		for (auto& mesh : result.meshes) {
+			MeshHandle handle{ s_State->geometry->addMesh(
+				std::move(mesh.vertexData),
+				mesh.vertexStride,
+				std::move(mesh.indices),
+				mesh.indexType
+			) };
+			if (handle != c_INVALID_MESH) {
+				s_State->meshes.emplace_back(SceneMesh{
+					.handle = handle,
+					.quantization = mesh.quantization,
+				});
+			}
+		}
+	}
+	s_State->geometry->update(s_State->uploadRing, s_State->transfer);
+
+	if (s_State->headless) {
+		// an offscreen image per frame in flight, the fence above already
+		// waited for its last use
+		swapchainImageIndex = (uint32_t)frameIndex;
+	} else {
+		PYX_TRACE_ZONE("acquire");
 		res = vkAcquireNextImageKHR(
 			s_State->device,
 			s_State->swapchain,
@@ -574,88 +732,244 @@ void VulkanRenderer::renderFrame() {
 			0,
 			&swapchainImageIndex
 		);
+	}
 
-		VkRect2D renderArea{
-			.extent = s_State->swapchainExtent,
-		};
-
-		VkClearValue clearValue{ { { 0.f, 0.f, 0.f, 1.f } } };
-
-		VkRenderPassBeginInfo renderPassBeginInfo{
-			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-			.renderPass = s_State->renderPass,
-			.framebuffer = s_State->framebuffers[swapchainImageIndex],
-			.renderArea = renderArea,
-			.clearValueCount = 1,
-			.pClearValues = &clearValue,
-		};
-		VkCommandBufferBeginInfo cmdBufferBeginInfo{
-			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-		};
+	VkRect2D renderArea{
+		.extent = s_State->swapchainExtent,
+	};
 
-		vkBeginCommandBuffer(frame.cmdBuffer, &cmdBufferBeginInfo);
-		vkCmdBeginRenderPass(
-			frame.cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE
-		);
+	VkClearValue clearValue{ { { 0.f, 0.f, 0.f, 1.f } } };
 
-		VkDeviceSize offset[1]{ 0 };
-		vkCmdBindVertexBuffers(
-			frame.cmdBuffer, 0, 1, &s_State->vertexBuffer, offset
-		);
+	VkRenderPassBeginInfo renderPassBeginInfo{
+		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+		.renderPass = s_State->renderPass,
+		.framebuffer = s_State->framebuffers[swapchainImageIndex],
+		.renderArea = renderArea,
+		.clearValueCount = 1,
+		.pClearValues = &clearValue,
+	};
+	VkCommandBufferBeginInfo cmdBufferBeginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+	};
 
-		VkViewport viewport{ .width = (float)s_State->swapchainExtent.width,
-							 .height = (float)s_State->swapchainExtent.height,
-							 .minDepth = 0.f,
-							 .maxDepth = 1.f };
-		VkRect2D scissor{ .extent = s_State->swapchainExtent };
+	VkCommandBuffer cmdBuffer{
+		s_State->commandPools->getPrimary(ThreadPool::getThreadIndex())
+	};
+	vkBeginCommandBuffer(cmdBuffer, &cmdBufferBeginInfo);
 
-		vkCmdSetViewport(frame.cmdBuffer, 0, 1, &viewport);
-		vkCmdSetScissor(frame.cmdBuffer, 0, 1, &scissor);
+	// the frame scope comes first, so the first result is the whole frame
+	s_State->gpuProfiler->beginFrame(cmdBuffer, (uint32_t)frameIndex);
+	const std::vector<GpuScopeResult>& gpuResults{
+		s_State->gpuProfiler->getResults()
+	};
+	s_State->timings.gpuMs =
+		gpuResults.empty() ? 0. : gpuResults.front().milliseconds;
+	uint32_t frameScope{ s_State->gpuProfiler->beginScope(cmdBuffer, "frame") };
+
+	submitTransfers(s_State->transfer);
+	std::optional<VkSemaphoreSubmitInfo> transferWait{};
+	{
+		PYX_TRACE_ZONE("record uploads");
+		GpuScope uploads{ *s_State->gpuProfiler, cmdBuffer, "uploads" };
+		transferWait = recordTransferAcquires(s_State->transfer, cmdBuffer);
+
+		s_State->geometry->recordDefragment(cmdBuffer);
+		// nothing reports screen coverage yet, so every texture asks for the
+		// detail it would need to cover the whole swapchain
+		float screenSize{ (float)std::max(
+			s_State->swapchainExtent.width, s_State->swapchainExtent.height
+		) };
+		for (TextureHandle texture : s_State->textures) {
+			s_State->textureManager->requestScreenSize(texture, screenSize);
+		}
+		s_State->textureManager->update(s_State->uploadRing, cmdBuffer);
+	}
 
-		vkCmdBindPipeline(
-			frame.cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, s_State->pipeline
-		);
+	{
+		PYX_TRACE_ZONE("record main pass");
+		// vertex and fragment invocations too, the counters are inherited by
+		// the secondaries
+		GpuScope mainPass{
+			*s_State->gpuProfiler, cmdBuffer, "main pass", true
+		};
 
-		vkCmdDraw(frame.cmdBuffer, 3, 1, 0, 0);
+		VkPipeline pipeline{
+			s_State->pipelineManager->getPipeline(s_State->pipeline)
+		};
+		uint32_t drawCount{ (uint32_t)s_State->meshes.size() };
+		if (drawCount < 2 * c_MIN_DRAWS_PER_BATCH) {
+			vkCmdBeginRenderPass(
+				cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE
+			);
+			recordDraws(cmdBuffer, pipeline, 0, drawCount);
+		} else {
+			// a few batches per thread so stealing can even out the uneven
+			// ones, but never so small that the secondaries dominate
+			uint32_t batchSize{ std::max(
+				drawCount / (ThreadPool::getThreadCount() * 4),
+				c_MIN_DRAWS_PER_BATCH
+			) };
+			std::vector<VkCommandBuffer> secondaries(
+				(drawCount + batchSize - 1) / batchSize
+			);
+
+			vkCmdBeginRenderPass(
+				cmdBuffer,
+				&renderPassBeginInfo,
+				VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+			);
+
+			VkCommandBufferInheritanceInfo inheritanceInfo{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+				.renderPass = s_State->renderPass,
+				.subpass = 0,
+				.framebuffer = renderPassBeginInfo.framebuffer,
+				.pipelineStatistics =
+					s_State->gpuProfiler->getInheritedStatistics(),
+			};
+			ThreadPool::parallelFor(
+				drawCount,
+				batchSize,
+				[&](uint32_t begin, uint32_t end, uint32_t threadIndex) {
+					PYX_TRACE_ZONE("record draws");
+					VkCommandBuffer secondary{
+						s_State->commandPools->getSecondary(threadIndex)
+					};
+					VkCommandBufferBeginInfo secondaryBeginInfo{
+						.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+						.flags =
+							VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT |
+							VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+						.pInheritanceInfo = &inheritanceInfo,
+					};
+					vkBeginCommandBuffer(secondary, &secondaryBeginInfo);
+					recordDraws(secondary, pipeline, begin, end);
+					vkEndCommandBuffer(secondary);
+
+					// batches land in draw order whichever thread ran them
+					secondaries[begin / batchSize] = secondary;
+				}
+			);
+
+			vkCmdExecuteCommands(
+				cmdBuffer, (uint32_t)secondaries.size(), secondaries.data()
+			);
+		}
 
-		vkCmdEndRenderPass(frame.cmdBuffer);
+		vkCmdEndRenderPass(cmdBuffer);
+	}
 
-		vkEndCommandBuffer(frame.cmdBuffer);
+	s_State->gpuProfiler->endScope(cmdBuffer, frameScope);
+	vkEndCommandBuffer(cmdBuffer);
 
-		VkPipelineStageFlags pipelineStageFlags{
-			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-		};
-		VkSubmitInfo submitInfo{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = &frame.imageAvaliableSemaphore,
-			.pWaitDstStageMask = &pipelineStageFlags,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &frame.cmdBuffer,
-			.signalSemaphoreCount = 1,
-			.pSignalSemaphores = &frame.renderFinishSemaphore,
+	flushUploadRegion(s_State->allocator, s_State->uploadRing);
 
-		};
-		res = vkQueueSubmit(
+	std::vector<VkSemaphoreSubmitInfo> waitInfos;
+	if (!s_State->headless) {
+		waitInfos.emplace_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = frame.imageAvaliableSemaphore,
+			.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		});
+	}
+	if (transferWait.has_value()) {
+		waitInfos.emplace_back(transferWait.value());
+	}
+	VkCommandBufferSubmitInfo cmdBufferSubmitInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+		.commandBuffer = cmdBuffer,
+	};
+	VkSemaphoreSubmitInfo signalInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore = frame.renderFinishSemaphore,
+		.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+	};
+	VkSubmitInfo2 submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		.waitSemaphoreInfoCount = (uint32_t)waitInfos.size(),
+		.pWaitSemaphoreInfos = waitInfos.data(),
+		.commandBufferInfoCount = 1,
+		.pCommandBufferInfos = &cmdBufferSubmitInfo,
+		// nothing would wait on it without a present
+		.signalSemaphoreInfoCount = s_State->headless ? 0u : 1u,
+		.pSignalSemaphoreInfos = &signalInfo,
+	};
+	{
+		PYX_TRACE_ZONE("submit");
+		Clock::time_point submitStart{ Clock::now() };
+		res = vkQueueSubmit2(
 			s_State->queues[QueueFamily::graphics],
 			1,
 			&submitInfo,
 			frame.renderFinishFence
 		);
+		std::chrono::duration<double, std::milli> submit{
+			Clock::now() - submitStart
+		};
+		s_State->timings.submitMs = submit.count();
+	}
+	if (s_State->headless) {
+		return;
+	}
 
-		VkPresentInfoKHR presentInfo{
-			.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = &frame.renderFinishSemaphore,
-			.swapchainCount = 1,
-			.pSwapchains = &s_State->swapchain,
-			.pImageIndices = &swapchainImageIndex,
+	PYX_TRACE_ZONE("present");
 
-		};
-		res = vkQueuePresentKHR(
-			s_State->queues[QueueFamily::presentation], &presentInfo
-		);
+	VkPresentInfoKHR presentInfo{
+		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+		.waitSemaphoreCount = 1,
+		.pWaitSemaphores = &frame.renderFinishSemaphore,
+		.swapchainCount = 1,
+		.pSwapchains = &s_State->swapchain,
+		.pImageIndices = &swapchainImageIndex,
+
+	};
+	res = vkQueuePresentKHR(
+		s_State->queues[QueueFamily::presentation], &presentInfo
+	);
+}
+
+void VulkanRenderer::renderFrames(const uint32_t frameCount) {
+	for (uint32_t i{}; i < frameCount; i++) {
+		renderFrame();
 	}
+
+	std::array<VkFence, VulkanState::FRAMES_IN_FLIGHT> fences;
+	for (size_t i{}; i < fences.size(); i++) {
+		fences[i] = s_State->frames[i].renderFinishFence;
+	}
+	vkWaitForFences(
+		s_State->device,
+		(uint32_t)fences.size(),
+		fences.data(),
+		VK_TRUE,
+		UINT64_MAX
+	);
+}
+
+VulkanRenderer::FrameTimings VulkanRenderer::getFrameTimings() {
+	return s_State->timings;
+}
+
+const std::vector<GpuScopeResult>& VulkanRenderer::getGpuScopeResults() {
+	return s_State->gpuProfiler->getResults();
+}
+
+void VulkanRenderer::loadMesh(const char* path) {
+	s_State->meshImporter->requestImport(path);
+}
+
+void VulkanRenderer::loadTexture(const char* path) {
+	s_State->textures.emplace_back(
+		s_State->textureManager->requestLoad(path, true)
+	);
+}
+
+bool VulkanRenderer::isLoadingIdle() {
+	return s_State->meshImporter->isIdle() && s_State->geometry->isIdle() &&
+		isTransferIdle(s_State->transfer) &&
+		s_State->textureManager->isIdle() &&
+		s_State->pipelineManager->getOldestPendingCompile() ==
+		s_State->pipelineManager->getSubmittedCompiles();
 }
 
 void VulkanRenderer::cleanup() {
@@ -664,5 +978,76 @@ void VulkanRenderer::cleanup() {
 	vkDeviceWaitIdle(s_State->device);
 	s_State->objectDeletionQueue.flush();
 
+	// a capture that was ended on demand is not written over
+	if (!s_State->tracePath.empty() && Trace::isCapturing()) {
+		Trace::endCapture(s_State->tracePath);
+	}
+
 	delete s_State;
+
+	Logger::shutdown();
 }
+
+namespace {
+	void recordDraws(
+		const VkCommandBuffer cmdBuffer,
+		const VkPipeline pipeline,
+		const uint32_t begin,
+		const uint32_t end
+	) {
+		// every pipeline layout shares set 0 and the push constant range, so
+		// this stays bound across pipeline switches
+		s_State->bindlessHeap->bind(
+			cmdBuffer, s_State->pipelineLayout, VK_PIPELINE_BIND_POINT_GRAPHICS
+		);
+
+		VkViewport viewport{ .width = (float)s_State->swapchainExtent.width,
+							 .height = (float)s_State->swapchainExtent.height,
+							 .minDepth = 0.f,
+							 .maxDepth = 1.f };
+		VkRect2D scissor{ .extent = s_State->swapchainExtent };
+
+		vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+
+		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+		// one index buffer binding serves every mesh of the same index type
+		VkIndexType boundIndexType{ VK_INDEX_TYPE_MAX_ENUM };
+		for (uint32_t i{ begin }; i < end; i++) {
+			const SceneMesh& sceneMesh{ s_State->meshes[i] };
+			if (!s_State->geometry->isMeshReady(sceneMesh.handle)) {
+				continue;
+			}
+
+			MeshDrawInfo mesh{ s_State->geometry->getMesh(sceneMesh.handle) };
+			if (mesh.indexType != boundIndexType) {
+				vkCmdBindIndexBuffer(
+					cmdBuffer,
+					s_State->geometry->getIndexBuffer(),
+					0,
+					mesh.indexType
+				);
+				boundIndexType = mesh.indexType;
+			}
+
+			VertexPullConstants pullConstants{
+				.vertices = mesh.vertexAddress,
+				.positionScale = sceneMesh.quantization.scale,
+				.positionOffset = sceneMesh.quantization.offset,
+			};
+			vkCmdPushConstants(
+				cmdBuffer,
+				s_State->pipelineLayout,
+				VK_SHADER_STAGE_ALL,
+				0,
+				sizeof(pullConstants),
+				&pullConstants
+			);
+
+			vkCmdDrawIndexed(
+				cmdBuffer, mesh.indexCount, 1, mesh.firstIndex, 0, 0
+			);
+		}
+	}
+}  // namespace
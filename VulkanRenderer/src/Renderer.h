@@ -1,9 +1,45 @@
 #pragma once
 
+#include <stdint.h>
+#include <vector>
+
 typedef struct SDL_Window SDL_Window;
+struct GpuScopeResult;
 
 namespace VulkanRenderer {
-	void init(SDL_Window* window);
+	// a null window means no surface or swapchain, frames are rendered into
+	// offscreen images of headlessWidth by headlessHeight. runs on devices
+	// that cannot present, cpu implementations like lavapipe included
+	void init(
+		SDL_Window* window,
+		const uint32_t headlessWidth = 0,
+		const uint32_t headlessHeight = 0
+	);
 	void renderFrame();
+	// returns once the frames have finished on the gpu, not just submitted
+	void renderFrames(const uint32_t frameCount);
+
+	struct FrameTimings {
+		// blocked on the frame's fence before recording it
+		double fenceWaitMs;
+		double submitMs;
+		// first to last command of the frame whose fence the wait was on,
+		// FRAMES_IN_FLIGHT frames back. 0 without timestamp support or
+		// before that frame exists
+		double gpuMs;
+	};
+	// of the last renderFrame
+	FrameTimings getFrameTimings();
+	// per scope gpu times of the frame gpuMs belongs to, the whole frame
+	// first
+	const std::vector<GpuScopeResult>& getGpuScopeResults();
+	// imported in the background, drawn once uploaded
+	void loadMesh(const char* path);
+	// decoded in the background, mipmapped and registered with the bindless
+	// heap once uploaded
+	void loadTexture(const char* path);
+	// no import, decode, upload, transfer or pipeline compile is running or
+	// waiting for the next frame. frames have to be rendered to get there
+	bool isLoadingIdle();
 	void cleanup();
 };	// namespace VulkanRenderer
@@ -0,0 +1,307 @@
+#include "ShaderLibrary.h"
+#include "AssetArchive.h"
+#include "PipelineManager.h"
+#include "Logger.h"
+#include "FileMapping.h"
+#include "Hash.h"
+#include "EmbeddedShaders.h"
+#include "Trace.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vulkan/vulkan_core.h>
+
+#ifdef PYX_PLATFORM_LINUX
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace {
+	constexpr uint32_t c_SPIRV_MAGIC{ 0x07230203 };
+}  // namespace
+
+void ShaderLibrary::init(
+	const VkDevice device, const std::filesystem::path& shaderDir
+) {
+	m_Device = device;
+	m_ShaderDir = shaderDir;
+
+	const char* overrideDir{ std::getenv("PYX_SHADER_DIR") };
+	if (overrideDir != nullptr) {
+		m_ShaderDir = overrideDir;
+		m_DiskOverride = true;
+		PYX_ENGINE_INFO(
+			"[Shaders] loading from {0} instead of embedded shaders",
+			m_ShaderDir.string()
+		);
+	}
+}
+
+void ShaderLibrary::shutdown() {
+	if (m_WatchThread.joinable()) {
+		m_StopWatching = true;
+		m_WatchThread.join();
+	}
+
+	for (const auto& entry : m_ModulesByHash) {
+		vkDestroyShaderModule(m_Device, entry.second.module, nullptr);
+	}
+	for (const auto& retired : m_RetiredModules) {
+		vkDestroyShaderModule(m_Device, retired.module, nullptr);
+	}
+	m_ModulesByHash.clear();
+	m_NameToHash.clear();
+	m_RetiredModules.clear();
+}
+
+VkShaderModule ShaderLibrary::loadShader(const std::string& name) {
+	auto existing{ m_NameToHash.find(name) };
+	if (existing != m_NameToHash.end()) {
+		return m_ModulesByHash.at(existing->second).module;
+	}
+
+	std::optional<uint64_t> hash{ loadModule(name, !m_DiskOverride) };
+	if (!hash.has_value()) {
+		return VK_NULL_HANDLE;
+	}
+	m_NameToHash[name] = hash.value();
+
+	return m_ModulesByHash.at(hash.value()).module;
+}
+
+const ShaderReflection* ShaderLibrary::getReflection(const std::string& name
+) const {
+	auto loaded{ m_NameToHash.find(name) };
+	if (loaded == m_NameToHash.end()) {
+		return nullptr;
+	}
+
+	return &m_ModulesByHash.at(loaded->second).reflection;
+}
+
+void ShaderLibrary::startWatching() {
+#ifdef PYX_PLATFORM_LINUX
+	m_StopWatching = false;
+	m_WatchThread = std::thread(&ShaderLibrary::watchLoop, this);
+#else
+	PYX_ENGINE_INFO("[Shaders] hot reload is only supported on linux");
+#endif
+}
+
+std::vector<ShaderReload> ShaderLibrary::pollReloads(
+	PipelineManager& pipelineManager
+) {
+	uint64_t oldestPendingCompile{ pipelineManager.getOldestPendingCompile() };
+	std::erase_if(m_RetiredModules, [&](const RetiredModule& retired) {
+		if (retired.compileSerial > oldestPendingCompile) {
+			return false;
+		}
+		vkDestroyShaderModule(m_Device, retired.module, nullptr);
+		return true;
+	});
+
+	// the recompiles for this poll's reloads are numbered from here on
+	uint64_t compileSerial{ pipelineManager.getSubmittedCompiles() };
+	std::set<std::string> changedNames;
+	{
+		std::lock_guard<std::mutex> lock(m_ChangedMutex);
+		changedNames.swap(m_ChangedNames);
+	}
+
+	std::vector<ShaderReload> reloads;
+	for (const auto& name : changedNames) {
+		auto loaded{ m_NameToHash.find(name) };
+		if (loaded == m_NameToHash.end()) {
+			continue;
+		}
+
+		uint64_t oldHash{ loaded->second };
+		VkShaderModule oldModule{ m_ModulesByHash.at(oldHash).module };
+
+		std::optional<uint64_t> newHash{ loadModule(name, false) };
+		if (!newHash.has_value() || newHash.value() == oldHash) {
+			if (newHash.has_value()) {
+				releaseModule(newHash.value(), compileSerial);
+			}
+			continue;
+		}
+
+		const ShaderReflection& oldReflection{
+			m_ModulesByHash.at(oldHash).reflection
+		};
+		const ShaderReflection& newReflection{
+			m_ModulesByHash.at(newHash.value()).reflection
+		};
+		if (oldReflection.bindings != newReflection.bindings ||
+			oldReflection.pushConstantSize != newReflection.pushConstantSize) {
+			PYX_ENGINE_ERROR(
+				"[Shaders] {0} changed its descriptor or push constant "
+				"layout, restart to pick it up",
+				name
+			);
+			releaseModule(newHash.value(), compileSerial);
+			continue;
+		}
+
+		loaded->second = newHash.value();
+		releaseModule(oldHash, compileSerial);
+
+		PYX_ENGINE_INFO("[Shaders] reloaded {0}", name);
+		reloads.emplace_back(ShaderReload{
+			.oldModule = oldModule,
+			.newModule = m_ModulesByHash.at(newHash.value()).module,
+		});
+	}
+
+	return reloads;
+}
+
+std::optional<uint64_t> ShaderLibrary::loadModule(
+	const std::string& name, const bool allowPackaged
+) {
+	PYX_TRACE_FUNCTION();
+
+	std::span<const uint32_t> embedded{
+		allowPackaged ? findEmbeddedShader(name) : std::span<const uint32_t>{}
+	};
+	if (!embedded.empty()) {
+		return createModule(name, embedded.data(), embedded.size_bytes());
+	}
+
+	const AssetEntry* cooked{
+		allowPackaged && m_Archive != nullptr ? m_Archive->find(name) : nullptr
+	};
+	if (cooked != nullptr && cooked->type == AssetType::shader) {
+		// payloads are aligned for pCode
+		std::span<const uint8_t> code{ m_Archive->getPayload(*cooked) };
+		return createModule(name, (const uint32_t*)code.data(), code.size());
+	}
+
+	std::filesystem::path path{ m_ShaderDir / name };
+
+	std::optional<MappedFile> file{ mapFile(path) };
+	if (!file.has_value()) {
+		PYX_ENGINE_ERROR("[Shaders] could not open {0}", path.string());
+		return {};
+	}
+
+	uint32_t magic{};
+	if (file->size >= sizeof(magic)) {
+		memcpy(&magic, file->data, sizeof(magic));
+	}
+	if (file->size % sizeof(uint32_t) != 0 || magic != c_SPIRV_MAGIC) {
+		PYX_ENGINE_ERROR("[Shaders] {0} is not spir-v", path.string());
+		unmapFile(file.value());
+		return {};
+	}
+
+	// mappings are page aligned, which satisfies pCode's alignment
+	std::optional<uint64_t> hash{
+		createModule(name, (const uint32_t*)file->data, file->size)
+	};
+	unmapFile(file.value());
+
+	return hash;
+}
+
+std::optional<uint64_t> ShaderLibrary::createModule(
+	const std::string& name, const uint32_t* code, const size_t size
+) {
+	uint64_t hash{ hashBytes(code, size) };
+
+	auto existing{ m_ModulesByHash.find(hash) };
+	if (existing != m_ModulesByHash.end()) {
+		existing->second.refCount++;
+		return hash;
+	}
+
+	std::optional<ShaderReflection> reflection{ reflectShader(code, size) };
+	if (!reflection.has_value()) {
+		PYX_ENGINE_ERROR("[Shaders] could not reflect {0}", name);
+		return {};
+	}
+
+	VkShaderModuleCreateInfo shaderModuleCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize = size,
+		.pCode = code,
+	};
+
+	VkShaderModule module{};
+	VkResult res{ vkCreateShaderModule(
+		m_Device, &shaderModuleCreateInfo, nullptr, &module
+	) };
+	if (res != VK_SUCCESS) {
+		PYX_ENGINE_ERROR(
+			"[Shaders] could not create module for {0}: {1}", name, (int)res
+		);
+		return {};
+	}
+
+	m_ModulesByHash[hash] = ShaderModuleEntry{
+		.module = module,
+		.reflection = std::move(reflection.value()),
+		.refCount = 1,
+	};
+
+	return hash;
+}
+
+void ShaderLibrary::releaseModule(
+	const uint64_t hash, const uint64_t compileSerial
+) {
+	ShaderModuleEntry& entry{ m_ModulesByHash.at(hash) };
+	entry.refCount--;
+	if (entry.refCount == 0) {
+		m_RetiredModules.emplace_back(RetiredModule{
+			.module = entry.module,
+			.compileSerial = compileSerial,
+		});
+		m_ModulesByHash.erase(hash);
+	}
+}
+
+void ShaderLibrary::watchLoop() {
+#ifdef PYX_PLATFORM_LINUX
+	int fd{ inotify_init1(IN_NONBLOCK | IN_CLOEXEC) };
+	if (fd < 0) {
+		PYX_ENGINE_WARNING("[Shaders] could not start inotify");
+		return;
+	}
+	// compilers either rewrite the file in place or move a finished file
+	// over it
+	int watch{ inotify_add_watch(
+		fd, m_ShaderDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO
+	) };
+	if (watch < 0) {
+		PYX_ENGINE_WARNING(
+			"[Shaders] could not watch {0}", m_ShaderDir.string()
+		);
+		close(fd);
+		return;
+	}
+
+	alignas(inotify_event) char buffer[4096];
+	while (!m_StopWatching) {
+		pollfd pollFd{ .fd = fd, .events = POLLIN };
+		if (poll(&pollFd, 1, 100) <= 0) {
+			continue;
+		}
+
+		ssize_t length{ read(fd, buffer, sizeof(buffer)) };
+		for (ssize_t offset{}; offset < length;) {
+			const inotify_event* event{ (const inotify_event*)(buffer + offset
+			) };
+			if (event->len > 0) {
+				std::lock_guard<std::mutex> lock(m_ChangedMutex);
+				m_ChangedNames.insert(event->name);
+			}
+			offset += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	inotify_rm_watch(fd, watch);
+	close(fd);
+#endif
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "ShaderReflection.h"
+
+class AssetArchive;
+class PipelineManager;
+
+struct ShaderReload {
+	VkShaderModule oldModule;
+	VkShaderModule newModule;
+};
+
+// Shaders come from the binaries embedded at build time, then from the
+// cooked asset archive, or are mapped straight from disk when neither has
+// them or PYX_SHADER_DIR points at a development directory. Modules are
+// shared between every name whose contents hash the same. On Linux the
+// shader directory is watched with inotify so rewritten binaries are picked
+// up at runtime.
+class ShaderLibrary {
+   public:
+	void init(const VkDevice device, const std::filesystem::path& shaderDir);
+	void shutdown();
+
+	// searched before the shader directory, has to stay open while the
+	// library is alive
+	void setArchive(const AssetArchive* archive) { m_Archive = archive; }
+
+	// name is relative to the shader directory, null if the file is missing
+	// or not spir-v
+	VkShaderModule loadShader(const std::string& name);
+	// reflection of a loaded shader, null if it is not loaded
+	const ShaderReflection* getReflection(const std::string& name) const;
+
+	void startWatching();
+	// reloads every loaded shader that changed on disk, call from the render
+	// thread. a reload that changes the shader interface is rejected since
+	// the pipeline layout built from it would no longer match. replaced
+	// modules are destroyed once the compiles that may use them finished
+	std::vector<ShaderReload> pollReloads(PipelineManager& pipelineManager);
+
+   private:
+	struct ShaderModuleEntry {
+		VkShaderModule module;
+		ShaderReflection reflection;
+		uint32_t refCount;
+	};
+
+	std::optional<uint64_t> loadModule(
+		const std::string& name, const bool allowPackaged
+	);
+	std::optional<uint64_t> createModule(
+		const std::string& name, const uint32_t* code, const size_t size
+	);
+	// compileSerial is the number of compiles submitted when the module
+	// stopped being handed out
+	void releaseModule(const uint64_t hash, const uint64_t compileSerial);
+	void watchLoop();
+
+	VkDevice m_Device{};
+	std::filesystem::path m_ShaderDir;
+	bool m_DiskOverride{};
+	const AssetArchive* m_Archive{};
+
+	std::unordered_map<uint64_t, ShaderModuleEntry> m_ModulesByHash;
+	std::unordered_map<std::string, uint64_t> m_NameToHash;
+	struct RetiredModule {
+		VkShaderModule module;
+		uint64_t compileSerial;
+	};
+	// replaced modules may still be referenced by queued pipeline compiles
+	std::vector<RetiredModule> m_RetiredModules;
+
+	std::thread m_WatchThread;
+	std::atomic<bool> m_StopWatching{};
+	std::mutex m_ChangedMutex;
+	std::set<std::string> m_ChangedNames;
+};
@@ -0,0 +1,542 @@
+#include "ShaderReflection.h"
+#include "Logger.h"
+#include "PipelineManager.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+	// the subset of spirv.h the reflection needs
+	enum SpvOp : uint16_t {
+		spvOpEntryPoint = 15,
+		spvOpTypeInt = 21,
+		spvOpTypeFloat = 22,
+		spvOpTypeVector = 23,
+		spvOpTypeMatrix = 24,
+		spvOpTypeImage = 25,
+		spvOpTypeSampler = 26,
+		spvOpTypeSampledImage = 27,
+		spvOpTypeArray = 28,
+		spvOpTypeRuntimeArray = 29,
+		spvOpTypeStruct = 30,
+		spvOpTypePointer = 32,
+		spvOpConstant = 43,
+		spvOpVariable = 59,
+		spvOpDecorate = 71,
+		spvOpMemberDecorate = 72,
+		spvOpTypeAccelerationStructureKHR = 5341,
+	};
+
+	enum SpvDecoration : uint32_t {
+		spvDecorationBlock = 2,
+		spvDecorationBufferBlock = 3,
+		spvDecorationArrayStride = 6,
+		spvDecorationMatrixStride = 7,
+		spvDecorationBuiltIn = 11,
+		spvDecorationLocation = 30,
+		spvDecorationBinding = 33,
+		spvDecorationDescriptorSet = 34,
+		spvDecorationOffset = 35,
+	};
+
+	enum SpvStorageClass : uint32_t {
+		spvStorageClassUniformConstant = 0,
+		spvStorageClassInput = 1,
+		spvStorageClassUniform = 2,
+		spvStorageClassPushConstant = 9,
+		spvStorageClassStorageBuffer = 12,
+		spvStorageClassPhysicalStorageBuffer = 5349,
+	};
+
+	enum SpvDim : uint32_t {
+		spvDimBuffer = 5,
+		spvDimSubpassData = 6,
+	};
+
+	constexpr uint32_t c_SPIRV_MAGIC{ 0x07230203 };
+	constexpr uint32_t c_SPIRV_HEADER_WORDS{ 5 };
+
+	struct SpvDecorations {
+		std::optional<uint32_t> set;
+		std::optional<uint32_t> binding;
+		std::optional<uint32_t> location;
+		uint32_t arrayStride;
+		bool builtIn;
+		bool block;
+		bool bufferBlock;
+
+		std::vector<uint32_t> memberOffsets;
+		std::vector<uint32_t> memberMatrixStrides;
+	};
+
+	struct SpvType {
+		SpvOp op;
+		std::vector<uint32_t> operands;
+	};
+
+	struct SpvVariable {
+		uint32_t id;
+		uint32_t typeId;
+		uint32_t storageClass;
+	};
+
+	struct SpvModule {
+		uint32_t executionModel;
+		std::unordered_map<uint32_t, SpvDecorations> decorations;
+		std::unordered_map<uint32_t, SpvType> types;
+		std::unordered_map<uint32_t, uint32_t> constants;
+		std::vector<SpvVariable> variables;
+	};
+
+	std::optional<SpvModule> parseModule(const uint32_t* words, size_t count);
+
+	VkShaderStageFlagBits getStage(const uint32_t executionModel);
+	std::optional<VkDescriptorType> getDescriptorType(
+		const SpvModule& module, const uint32_t typeId, const uint32_t storage
+	);
+	uint32_t getDescriptorCount(const SpvModule& module, uint32_t& typeId);
+	uint32_t getTypeSize(const SpvModule& module, const uint32_t typeId);
+	VkFormat getVertexFormat(const SpvModule& module, const uint32_t typeId);
+}  // namespace
+
+std::optional<ShaderReflection>
+	reflectShader(const uint32_t* code, const size_t size) {
+	std::optional<SpvModule> parsed{
+		parseModule(code, size / sizeof(uint32_t))
+	};
+	if (!parsed.has_value()) {
+		PYX_ENGINE_ERROR("[Reflection] malformed spir-v");
+		return {};
+	}
+	const SpvModule& module{ parsed.value() };
+
+	ShaderReflection reflection{ .stage = getStage(module.executionModel) };
+
+	for (const auto& variable : module.variables) {
+		const SpvType& pointer{ module.types.at(variable.typeId) };
+		uint32_t typeId{ pointer.operands[1] };
+
+		auto decorationsItt{ module.decorations.find(variable.id) };
+		SpvDecorations noDecorations{};
+		const SpvDecorations& decorations{
+			decorationsItt != module.decorations.end() ? decorationsItt->second
+													   : noDecorations
+		};
+
+		switch (variable.storageClass) {
+			case spvStorageClassPushConstant: {
+				reflection.pushConstantSize = std::max(
+					reflection.pushConstantSize, getTypeSize(module, typeId)
+				);
+			} break;
+			case spvStorageClassInput: {
+				if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT ||
+					decorations.builtIn || !decorations.location.has_value()) {
+					break;
+				}
+				reflection.vertexInputs.emplace_back(ReflectedVertexInput{
+					.location = decorations.location.value(),
+					.format = getVertexFormat(module, typeId),
+				});
+			} break;
+			case spvStorageClassUniformConstant:
+			case spvStorageClassUniform:
+			case spvStorageClassStorageBuffer: {
+				uint32_t count{ getDescriptorCount(module, typeId) };
+				std::optional<VkDescriptorType> type{
+					getDescriptorType(module, typeId, variable.storageClass)
+				};
+				if (!type.has_value()) {
+					break;
+				}
+				reflection.bindings.emplace_back(ReflectedBinding{
+					.set = decorations.set.value_or(0),
+					.binding = decorations.binding.value_or(0),
+					.type = type.value(),
+					.count = count,
+					.stages = (VkShaderStageFlags)reflection.stage,
+				});
+			} break;
+			default:
+				break;
+		}
+	}
+
+	std::ranges::sort(
+		reflection.vertexInputs,
+		[](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+			return a.location < b.location;
+		}
+	);
+
+	return reflection;
+}
+
+std::optional<std::vector<ReflectedBinding>>
+	mergeShaderBindings(const std::vector<const ShaderReflection*>& stages) {
+	std::vector<ReflectedBinding> merged;
+	for (const auto* stage : stages) {
+		for (const auto& binding : stage->bindings) {
+			auto existing{ std::ranges::find_if(
+				merged,
+				[&](const ReflectedBinding& other) {
+					return other.set == binding.set &&
+						other.binding == binding.binding;
+				}
+			) };
+			if (existing == merged.end()) {
+				merged.emplace_back(binding);
+				continue;
+			}
+
+			if (existing->type != binding.type ||
+				existing->count != binding.count) {
+				PYX_ENGINE_ERROR(
+					"[Reflection] set {0} binding {1} is declared as "
+					"{2}[{3}] and {4}[{5}]",
+					binding.set,
+					binding.binding,
+					(int)existing->type,
+					existing->count,
+					(int)binding.type,
+					binding.count
+				);
+				return {};
+			}
+			existing->stages |= binding.stages;
+		}
+	}
+
+	std::ranges::sort(
+		merged,
+		[](const ReflectedBinding& a, const ReflectedBinding& b) {
+			if (a.set != b.set) {
+				return a.set < b.set;
+			}
+			return a.binding < b.binding;
+		}
+	);
+
+	return merged;
+}
+
+bool validateVertexLayout(
+	const ShaderReflection& vertexShader, const VertexLayout& layout
+) {
+	bool valid{ true };
+	for (const auto& input : vertexShader.vertexInputs) {
+		const VertexAttribute* attribute{};
+		for (uint32_t i{}; i < layout.attributeCount; i++) {
+			if (layout.attributes[i].location == input.location) {
+				attribute = &layout.attributes[i];
+			}
+		}
+
+		if (attribute == nullptr) {
+			PYX_ENGINE_ERROR(
+				"[Reflection] vertex input {0} is not fed by the vertex layout",
+				input.location
+			);
+			valid = false;
+		} else if (input.format != VK_FORMAT_UNDEFINED &&
+				   attribute->format != input.format) {
+			PYX_ENGINE_WARNING(
+				"[Reflection] vertex input {0} expects format {1}, layout "
+				"provides {2}",
+				input.location,
+				(int)input.format,
+				(int)attribute->format
+			);
+		}
+	}
+
+	return valid;
+}
+
+namespace {
+	std::optional<SpvModule> parseModule(const uint32_t* words, size_t count) {
+		if (count < c_SPIRV_HEADER_WORDS || words[0] != c_SPIRV_MAGIC) {
+			return {};
+		}
+
+		SpvModule module{};
+		for (size_t i{ c_SPIRV_HEADER_WORDS }; i < count;) {
+			uint16_t op{ (uint16_t)(words[i] & 0xffff) };
+			uint16_t wordCount{ (uint16_t)(words[i] >> 16) };
+			if (wordCount == 0 || i + wordCount > count) {
+				return {};
+			}
+			const uint32_t* operands{ words + i + 1 };
+			uint32_t operandCount{ wordCount - 1u };
+
+			switch (op) {
+				case spvOpEntryPoint: {
+					module.executionModel = operands[0];
+				} break;
+				case spvOpDecorate: {
+					SpvDecorations& decorations{
+						module.decorations[operands[0]]
+					};
+					uint32_t value{ operandCount > 2 ? operands[2] : 0 };
+					switch (operands[1]) {
+						case spvDecorationBlock:
+							decorations.block = true;
+							break;
+						case spvDecorationBufferBlock:
+							decorations.bufferBlock = true;
+							break;
+						case spvDecorationArrayStride:
+							decorations.arrayStride = value;
+							break;
+						case spvDecorationBuiltIn:
+							decorations.builtIn = true;
+							break;
+						case spvDecorationLocation:
+							decorations.location = value;
+							break;
+						case spvDecorationBinding:
+							decorations.binding = value;
+							break;
+						case spvDecorationDescriptorSet:
+							decorations.set = value;
+							break;
+					}
+				} break;
+				case spvOpMemberDecorate: {
+					SpvDecorations& decorations{
+						module.decorations[operands[0]]
+					};
+					uint32_t member{ operands[1] };
+					uint32_t value{ operandCount > 3 ? operands[3] : 0 };
+					std::vector<uint32_t>* memberValues{};
+					if (operands[2] == spvDecorationOffset) {
+						memberValues = &decorations.memberOffsets;
+					} else if (operands[2] == spvDecorationMatrixStride) {
+						memberValues = &decorations.memberMatrixStrides;
+					}
+					if (memberValues != nullptr) {
+						memberValues->resize(
+							std::max<size_t>(memberValues->size(), member + 1)
+						);
+						(*memberValues)[member] = value;
+					}
+				} break;
+				case spvOpTypeInt:
+				case spvOpTypeFloat:
+				case spvOpTypeVector:
+				case spvOpTypeMatrix:
+				case spvOpTypeImage:
+				case spvOpTypeSampler:
+				case spvOpTypeSampledImage:
+				case spvOpTypeArray:
+				case spvOpTypeRuntimeArray:
+				case spvOpTypeStruct:
+				case spvOpTypePointer:
+				case spvOpTypeAccelerationStructureKHR: {
+					module.types[operands[0]] = SpvType{
+						.op = (SpvOp)op,
+						.operands = std::vector<uint32_t>(
+							operands + 1, operands + operandCount
+						),
+					};
+				} break;
+				case spvOpConstant: {
+					module.constants[operands[1]] = operands[2];
+				} break;
+				case spvOpVariable: {
+					module.variables.emplace_back(SpvVariable{
+						.id = operands[1],
+						.typeId = operands[0],
+						.storageClass = operands[2],
+					});
+				} break;
+			}
+
+			i += wordCount;
+		}
+
+		return module;
+	}
+
+	VkShaderStageFlagBits getStage(const uint32_t executionModel) {
+		switch (executionModel) {
+			case 0:
+				return VK_SHADER_STAGE_VERTEX_BIT;
+			case 1:
+				return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+			case 2:
+				return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+			case 3:
+				return VK_SHADER_STAGE_GEOMETRY_BIT;
+			case 4:
+				return VK_SHADER_STAGE_FRAGMENT_BIT;
+			case 5:
+				return VK_SHADER_STAGE_COMPUTE_BIT;
+			default:
+				return VK_SHADER_STAGE_ALL;
+		}
+	}
+
+	std::optional<VkDescriptorType> getDescriptorType(
+		const SpvModule& module, const uint32_t typeId, const uint32_t storage
+	) {
+		const SpvType& type{ module.types.at(typeId) };
+		switch (type.op) {
+			case spvOpTypeSampler:
+				return VK_DESCRIPTOR_TYPE_SAMPLER;
+			case spvOpTypeSampledImage: {
+				const SpvType& image{ module.types.at(type.operands[0]) };
+				return image.operands[1] == spvDimBuffer
+					? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER
+					: VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			}
+			case spvOpTypeImage: {
+				uint32_t dim{ type.operands[1] };
+				uint32_t sampled{ type.operands[5] };
+				if (dim == spvDimSubpassData) {
+					return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+				}
+				if (dim == spvDimBuffer) {
+					return sampled == 2
+						? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+						: VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+				}
+				return sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+									: VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			}
+			case spvOpTypeAccelerationStructureKHR:
+				return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+			case spvOpTypeStruct: {
+				if (storage == spvStorageClassStorageBuffer) {
+					return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				}
+				auto decorations{ module.decorations.find(typeId) };
+				if (decorations != module.decorations.end() &&
+					decorations->second.bufferBlock) {
+					return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				}
+				return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			}
+			default:
+				return {};
+		}
+	}
+
+	// strips array types off typeId
+	uint32_t getDescriptorCount(const SpvModule& module, uint32_t& typeId) {
+		uint32_t count{ 1 };
+		while (true) {
+			const SpvType& type{ module.types.at(typeId) };
+			if (type.op == spvOpTypeArray) {
+				count *= module.constants.at(type.operands[1]);
+			} else if (type.op == spvOpTypeRuntimeArray) {
+				count = 0;
+			} else {
+				return count;
+			}
+			typeId = type.operands[0];
+		}
+	}
+
+	uint32_t getTypeSize(const SpvModule& module, const uint32_t typeId) {
+		const SpvType& type{ module.types.at(typeId) };
+		auto decorations{ module.decorations.find(typeId) };
+
+		switch (type.op) {
+			case spvOpTypeInt:
+			case spvOpTypeFloat:
+				return type.operands[0] / 8;
+			case spvOpTypeVector:
+				return getTypeSize(module, type.operands[0]) * type.operands[1];
+			case spvOpTypeMatrix:
+				return getTypeSize(module, type.operands[0]) * type.operands[1];
+			case spvOpTypePointer:
+				return 8;
+			case spvOpTypeArray: {
+				uint32_t length{ module.constants.at(type.operands[1]) };
+				uint32_t stride{
+					decorations != module.decorations.end()
+						? decorations->second.arrayStride
+						: 0
+				};
+				if (stride == 0) {
+					stride = getTypeSize(module, type.operands[0]);
+				}
+				return stride * length;
+			}
+			case spvOpTypeStruct: {
+				uint32_t size{};
+				for (size_t i{}; i < type.operands.size(); i++) {
+					uint32_t offset{};
+					uint32_t memberSize{
+						getTypeSize(module, type.operands[i])
+					};
+					if (decorations != module.decorations.end()) {
+						const SpvDecorations& members{ decorations->second };
+						if (i < members.memberOffsets.size()) {
+							offset = members.memberOffsets[i];
+						}
+						const SpvType& memberType{
+							module.types.at(type.operands[i])
+						};
+						if (memberType.op == spvOpTypeMatrix &&
+							i < members.memberMatrixStrides.size() &&
+							members.memberMatrixStrides[i] != 0) {
+							memberSize = members.memberMatrixStrides[i] *
+								memberType.operands[1];
+						}
+					}
+					size = std::max(size, offset + memberSize);
+				}
+				return size;
+			}
+			default:
+				return 0;
+		}
+	}
+
+	VkFormat getVertexFormat(const SpvModule& module, const uint32_t typeId) {
+		const SpvType& type{ module.types.at(typeId) };
+
+		uint32_t componentCount{ 1 };
+		const SpvType* component{ &type };
+		if (type.op == spvOpTypeVector) {
+			componentCount = type.operands[1];
+			component = &module.types.at(type.operands[0]);
+		}
+
+		constexpr VkFormat c_FLOAT_FORMATS[]{
+			VK_FORMAT_R32_SFLOAT,
+			VK_FORMAT_R32G32_SFLOAT,
+			VK_FORMAT_R32G32B32_SFLOAT,
+			VK_FORMAT_R32G32B32A32_SFLOAT,
+		};
+		constexpr VkFormat c_SINT_FORMATS[]{
+			VK_FORMAT_R32_SINT,
+			VK_FORMAT_R32G32_SINT,
+			VK_FORMAT_R32G32B32_SINT,
+			VK_FORMAT_R32G32B32A32_SINT,
+		};
+		constexpr VkFormat c_UINT_FORMATS[]{
+			VK_FORMAT_R32_UINT,
+			VK_FORMAT_R32G32_UINT,
+			VK_FORMAT_R32G32B32_UINT,
+			VK_FORMAT_R32G32B32A32_UINT,
+		};
+
+		if (componentCount == 0 || componentCount > 4 ||
+			component->operands[0] != 32) {
+			return VK_FORMAT_UNDEFINED;
+		}
+		if (component->op == spvOpTypeFloat) {
+			return c_FLOAT_FORMATS[componentCount - 1];
+		}
+		if (component->op == spvOpTypeInt) {
+			return component->operands[1] != 0
+				? c_SINT_FORMATS[componentCount - 1]
+				: c_UINT_FORMATS[componentCount - 1];
+		}
+
+		return VK_FORMAT_UNDEFINED;
+	}
+}  // namespace
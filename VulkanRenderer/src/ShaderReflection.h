@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct VertexLayout;
+
+struct ReflectedBinding {
+	uint32_t set;
+	uint32_t binding;
+	VkDescriptorType type;
+	// 0 for runtime sized arrays
+	uint32_t count;
+	VkShaderStageFlags stages;
+
+	bool operator==(const ReflectedBinding&) const = default;
+};
+
+struct ReflectedVertexInput {
+	uint32_t location;
+	VkFormat format;
+};
+
+struct ShaderReflection {
+	VkShaderStageFlagBits stage;
+	std::vector<ReflectedBinding> bindings;
+	uint32_t pushConstantSize;
+	std::vector<ReflectedVertexInput> vertexInputs;
+};
+
+std::optional<ShaderReflection>
+	reflectShader(const uint32_t* code, const size_t size);
+
+// merges the bindings of every stage of a pipeline, fails when two stages
+// disagree about a binding
+std::optional<std::vector<ReflectedBinding>>
+	mergeShaderBindings(const std::vector<const ShaderReflection*>& stages);
+
+// every input the vertex shader reads has to be fed with a matching format
+bool validateVertexLayout(
+	const ShaderReflection& vertexShader, const VertexLayout& layout
+);
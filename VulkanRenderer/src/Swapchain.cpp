@@ -1,4 +1,5 @@
 #include "Swapchain.h"
+#include "Trace.h"
 #include <SDL2/SDL_vulkan.h>
 #include <SDL2/SDL.h>
 
@@ -35,6 +36,8 @@ SwapchainInfo createSwapchain(
 	SDL_Window* window,
 	const uint32_t imagesToCreate
 ) {
+	PYX_TRACE_FUNCTION();
+
 	SurfaceCapabilities capabilities{
 		selectSurfaceCapabilities(pDevice, surface, imagesToCreate, window)
 	};
@@ -107,6 +110,64 @@ void deleteSwapchain(
 	vkDestroySwapchainKHR(device, swapchain, nullptr);
 }
 
+OffscreenTargets createOffscreenTargets(
+	const VmaAllocator allocator,
+	const VkDevice device,
+	const VkExtent2D extent,
+	const uint32_t imagesToCreate
+) {
+	// what surfaces offer nearly everywhere, so both paths render the same
+	VkFormat format{ VK_FORMAT_B8G8R8A8_SRGB };
+
+	std::vector<ImageInfo> images(imagesToCreate);
+	std::vector<VkImageView> imageViews(imagesToCreate);
+	for (uint32_t i{}; i < imagesToCreate; i++) {
+		images[i] = createImage(
+			allocator,
+			extent,
+			format,
+			1,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+				VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+		);
+
+		VkImageViewCreateInfo viewCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = images[i].handle,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = format,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.levelCount = 1,
+				.layerCount = 1,
+			},
+		};
+
+		vkCreateImageView(device, &viewCreateInfo, nullptr, &imageViews[i]);
+	}
+
+	OffscreenTargets targets{
+		.images = std::move(images),
+		.imageViews = std::move(imageViews),
+		.extent = extent,
+		.format = format,
+	};
+	return targets;
+}
+
+void deleteOffscreenTargets(
+	const VmaAllocator allocator,
+	const VkDevice device,
+	const OffscreenTargets& targets
+) {
+	for (const auto& view : targets.imageViews) {
+		vkDestroyImageView(device, view, nullptr);
+	}
+	for (const auto& image : targets.images) {
+		destroyImage(allocator, image);
+	}
+}
+
 namespace {
 	SurfaceCapabilities selectSurfaceCapabilities(
 		const VkPhysicalDevice pDevice,
@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "Memory.h"
+
 typedef struct SDL_Window SDL_Window;
 
 struct SwapchainInfo {
@@ -28,3 +30,26 @@ void deleteSwapchain(
 	VkSwapchainKHR swapchain,
 	const std::vector<VkImageView>& imageViews
 );
+
+// stands in for the swapchain when rendering headless. the images can be
+// copied from once rendered to
+struct OffscreenTargets {
+	std::vector<ImageInfo> images;
+	std::vector<VkImageView> imageViews;
+	VkExtent2D extent;
+
+	VkFormat format;
+};
+
+OffscreenTargets createOffscreenTargets(
+	const VmaAllocator allocator,
+	const VkDevice device,
+	const VkExtent2D extent,
+	const uint32_t imagesToCreate
+);
+
+void deleteOffscreenTargets(
+	const VmaAllocator allocator,
+	const VkDevice device,
+	const OffscreenTargets& targets
+);
@@ -0,0 +1,1022 @@
+#include "Texture.h"
+#include "Hash.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <stb_image.h>
+
+namespace {
+	constexpr VkDeviceSize c_UPLOAD_CHUNK_SIZE{ 1024 * 1024 };
+	// covers the texel size of every format and the copy offset rules
+	constexpr VkDeviceSize c_UPLOAD_ALIGNMENT{ 16 };
+
+	// the coarse tail every streaming texture keeps resident, in texels
+	constexpr uint32_t c_RESIDENT_TAIL_SIZE{ 64 };
+	// residency changes started per frame, each one allocates an image
+	constexpr uint32_t c_MAX_RESIDENCY_CHANGES{ 4 };
+	// level requests stream levels in for this many frames
+	constexpr uint64_t c_REQUEST_FRAMES{ 8 };
+	// of the device local heap budget, the rest is headroom for buffers and
+	// whatever else allocates between two residency updates
+	constexpr VkDeviceSize c_HEAP_BUDGET_PERCENT{ 90 };
+
+	constexpr VkPipelineStageFlags2 c_TEXTURE_STAGES{
+		VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+		VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+	};
+
+	// a block is one texel for uncompressed formats, zero bytes for formats
+	// textures do not support
+	struct FormatBlock {
+		uint32_t extent;
+		uint32_t bytes;
+	};
+
+	FormatBlock getFormatBlock(const VkFormat format);
+	VkExtent2D getLevelExtent(const VkExtent2D extent, const uint32_t level);
+	uint32_t getBlockRows(const FormatBlock block, const VkExtent2D extent);
+	VkDeviceSize getRowBytes(const FormatBlock block, const VkExtent2D extent);
+	// levelCount levels back to back starting at firstLevel
+	VkDeviceSize getChainBytes(
+		const FormatBlock block,
+		const VkExtent2D extent,
+		const uint32_t firstLevel,
+		const uint32_t levelCount
+	);
+	VkImageMemoryBarrier2 makeLevelBarrier(
+		const VkImage image,
+		const uint32_t baseLevel,
+		const uint32_t levelCount,
+		const VkImageLayout oldLayout,
+		const VkImageLayout newLayout
+	);
+	void recordBarrier(
+		const VkCommandBuffer cmdBuffer,
+		const std::span<const VkImageMemoryBarrier2> barriers
+	);
+}  // namespace
+
+size_t SamplerDescHash::operator()(const SamplerDesc& desc) const {
+	return hashBytes(&desc, sizeof(desc));
+}
+
+void SamplerCache::init(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	BindlessHeap* bindlessHeap
+) {
+	m_Device = device;
+	m_BindlessHeap = bindlessHeap;
+
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(pDevice, &properties);
+	m_MaxAnisotropy = properties.limits.maxSamplerAnisotropy;
+}
+
+void SamplerCache::shutdown() {
+	for (const auto& [desc, cached] : m_Samplers) {
+		m_BindlessHeap->remove(BindlessType::sampler, cached.index);
+		vkDestroySampler(m_Device, cached.sampler, nullptr);
+	}
+	m_Samplers.clear();
+}
+
+CachedSampler SamplerCache::getSampler(const SamplerDesc& desc) {
+	if (auto it{ m_Samplers.find(desc) }; it != m_Samplers.end()) {
+		return it->second;
+	}
+
+	float maxAnisotropy{
+		std::clamp(desc.maxAnisotropy, 1.0f, m_MaxAnisotropy)
+	};
+	VkSamplerCreateInfo samplerCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter = desc.filter,
+		.minFilter = desc.filter,
+		.mipmapMode = desc.mipmapMode,
+		.addressModeU = desc.addressMode,
+		.addressModeV = desc.addressMode,
+		.addressModeW = desc.addressMode,
+		.anisotropyEnable = maxAnisotropy > 1.0f,
+		.maxAnisotropy = maxAnisotropy,
+		.minLod = 0.0f,
+		.maxLod = VK_LOD_CLAMP_NONE,
+	};
+
+	VkSampler sampler{};
+	VK_CHECK(vkCreateSampler(m_Device, &samplerCreateInfo, nullptr, &sampler));
+
+	CachedSampler cached{
+		.sampler = sampler,
+		.index = m_BindlessHeap->addSampler(sampler),
+	};
+	m_Samplers.emplace(desc, cached);
+
+	return cached;
+}
+
+void TextureManager::init(
+	const VkPhysicalDevice pDevice,
+	const VkDevice device,
+	const VmaAllocator allocator,
+	BindlessHeap* bindlessHeap,
+	const uint32_t framesInFlight
+) {
+	m_PhysicalDevice = pDevice;
+	m_Device = device;
+	m_Allocator = allocator;
+	m_BindlessHeap = bindlessHeap;
+	m_FramesInFlight = framesInFlight;
+}
+
+void TextureManager::shutdown() {
+	{
+		std::unique_lock<std::mutex> lock(m_IdleMutex);
+		m_Idle.wait(lock, [&]() { return m_RunningDecodes == 0; });
+	}
+
+	for (const auto& retired : m_RetiredTextures) {
+		vkDestroyImageView(m_Device, retired.view, nullptr);
+		destroyImage(m_Allocator, retired.image);
+	}
+	for (const auto& upload : m_CompletedUploads) {
+		m_BindlessHeap->remove(BindlessType::sampledImage, upload.index);
+	}
+	for (const auto& uploads : { &m_PendingUploads, &m_CompletedUploads }) {
+		for (const auto& upload : *uploads) {
+			vkDestroyImageView(m_Device, upload.view, nullptr);
+			destroyImage(m_Allocator, upload.image);
+		}
+	}
+	for (const auto& entry : m_Textures) {
+		if (!entry.alive || !entry.ready) {
+			continue;
+		}
+		m_BindlessHeap->remove(BindlessType::sampledImage, entry.index);
+		vkDestroyImageView(m_Device, entry.view, nullptr);
+		destroyImage(m_Allocator, entry.image);
+	}
+
+	m_RetiredTextures.clear();
+	m_PendingUploads.clear();
+	m_CompletedUploads.clear();
+	m_Decoded.clear();
+	m_Textures.clear();
+	m_FreeTextures.clear();
+	m_ResidentBytes = 0;
+}
+
+TextureHandle TextureManager::requestLoad(
+	const std::filesystem::path& path, const bool srgb
+) {
+	TextureHandle texture{ allocateHandle() };
+	m_Textures[texture].decoding = true;
+	m_RunningDecodes++;
+
+	ThreadPool::submit([this, texture, path, srgb](uint32_t) {
+		DecodedTexture decoded{
+			.texture = texture,
+			.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM,
+		};
+
+		int width{};
+		int height{};
+		int channels{};
+		stbi_uc* pixels{
+			stbi_load(path.string().c_str(), &width, &height, &channels, 4)
+		};
+		if (pixels == nullptr) {
+			PYX_ENGINE_ERROR(
+				"[Texture] could not load {0}: {1}",
+				path.string(),
+				stbi_failure_reason()
+			);
+		} else {
+			decoded.pixels.assign(pixels, pixels + (size_t)width * height * 4);
+			decoded.width = (uint32_t)width;
+			decoded.height = (uint32_t)height;
+			stbi_image_free(pixels);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_DecodedMutex);
+			m_Decoded.emplace_back(std::move(decoded));
+		}
+
+		std::lock_guard<std::mutex> lock(m_IdleMutex);
+		m_RunningDecodes--;
+		m_Idle.notify_all();
+	});
+
+	return texture;
+}
+
+TextureHandle TextureManager::addTexture(
+	std::vector<uint8_t> pixels,
+	const uint32_t width,
+	const uint32_t height,
+	const VkFormat format,
+	const uint32_t mipLevels
+) {
+	TextureHandle texture{ addTexture(
+		std::span<const uint8_t>{ pixels }, width, height, format, mipLevels
+	) };
+	// moving keeps the storage the entry's span points at
+	if (texture != c_INVALID_TEXTURE) {
+		m_Textures[texture].ownedPixels = std::move(pixels);
+	}
+
+	return texture;
+}
+
+TextureHandle TextureManager::addTexture(
+	const std::span<const uint8_t> pixels,
+	const uint32_t width,
+	const uint32_t height,
+	const VkFormat format,
+	const uint32_t mipLevels
+) {
+	FormatBlock block{ getFormatBlock(format) };
+	if (block.bytes == 0) {
+		PYX_ENGINE_ERROR("[Texture] unsupported format {0}", (int)format);
+		return c_INVALID_TEXTURE;
+	}
+	VkDeviceSize size{ getChainBytes(block, { width, height }, 0, mipLevels) };
+	if (pixels.size() < size) {
+		PYX_ENGINE_ERROR(
+			"[Texture] {0} bytes are not {1} levels of format {2}",
+			pixels.size(),
+			mipLevels,
+			(int)format
+		);
+		return c_INVALID_TEXTURE;
+	}
+
+	TextureHandle texture{ allocateHandle() };
+	TextureEntry& entry{ m_Textures[texture] };
+	entry.pixels = pixels;
+	if (!createTexture(texture, width, height, format, mipLevels) ||
+		!queueUpload(texture, getMinResidentLevel(entry))) {
+		entry.alive = false;
+		entry.pixels = {};
+		m_FreeTextures.emplace_back(texture);
+		return c_INVALID_TEXTURE;
+	}
+
+	return texture;
+}
+
+void TextureManager::removeTexture(const TextureHandle texture) {
+	TextureEntry& entry{ m_Textures[texture] };
+	PYX_ENGINE_ASSERT_WARNING(entry.alive);
+
+	std::erase_if(m_PendingUploads, [&](const PendingUpload& upload) {
+		if (upload.texture != texture) {
+			return false;
+		}
+		retireImage(upload.image, upload.view, upload.bytes);
+		return true;
+	});
+	std::erase_if(m_CompletedUploads, [&](const PendingUpload& upload) {
+		if (upload.texture != texture) {
+			return false;
+		}
+		m_BindlessHeap->remove(BindlessType::sampledImage, upload.index);
+		retireImage(upload.image, upload.view, upload.bytes);
+		return true;
+	});
+	if (entry.ready) {
+		m_BindlessHeap->remove(BindlessType::sampledImage, entry.index);
+		retireImage(entry.image, entry.view, entry.residentBytes);
+	}
+
+	entry.alive = false;
+	entry.pixels = {};
+	entry.ownedPixels = {};
+	// update frees the handle when the decode reports back
+	if (!entry.decoding) {
+		m_FreeTextures.emplace_back(texture);
+	}
+}
+
+bool TextureManager::isTextureReady(const TextureHandle texture) const {
+	return m_Textures[texture].alive && m_Textures[texture].ready;
+}
+
+bool TextureManager::isIdle() {
+	if (m_RunningDecodes != 0 || !m_PendingUploads.empty() ||
+		!m_CompletedUploads.empty()) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_DecodedMutex);
+	return m_Decoded.empty();
+}
+
+TextureDrawInfo TextureManager::getTexture(const TextureHandle texture) const {
+	const TextureEntry& entry{ m_Textures[texture] };
+	VkExtent2D extent{ getLevelExtent(entry.extent, entry.residentLevel) };
+
+	return TextureDrawInfo{
+		.image = entry.index,
+		.width = extent.width,
+		.height = extent.height,
+		.mipLevels = entry.mipLevels - entry.residentLevel,
+	};
+}
+
+void TextureManager::requestLevel(
+	const TextureHandle texture, const uint32_t level
+) {
+	TextureEntry& entry{ m_Textures[texture] };
+	if (!entry.alive || entry.mipLevels == 0) {
+		return;
+	}
+
+	uint32_t clampedLevel{ std::min(level, entry.mipLevels - 1) };
+	if (entry.requestFrame != m_Frame) {
+		entry.requestedLevel = clampedLevel;
+		entry.requestFrame = m_Frame;
+	} else {
+		entry.requestedLevel = std::min(entry.requestedLevel, clampedLevel);
+	}
+}
+
+void TextureManager::requestScreenSize(
+	const TextureHandle texture, const float screenSize
+) {
+	const TextureEntry& entry{ m_Textures[texture] };
+	float size{ (float)std::max(entry.extent.width, entry.extent.height) };
+	// each level halves the texels, so the level is how many times the
+	// texture has to be halved to fit
+	uint32_t level{};
+	if (screenSize < size) {
+		level = (uint32_t)std::log2(size / std::max(screenSize, 1.0f));
+	}
+
+	requestLevel(texture, level);
+}
+
+void TextureManager::setBudget(const VkDeviceSize budget) {
+	m_Budget = budget;
+}
+
+void TextureManager::update(UploadRing& ring, const VkCommandBuffer cmdBuffer) {
+	m_Frame++;
+
+	std::erase_if(m_RetiredTextures, [&](const RetiredTexture& retired) {
+		if (retired.frame + m_FramesInFlight > m_Frame) {
+			return false;
+		}
+		vkDestroyImageView(m_Device, retired.view, nullptr);
+		destroyImage(m_Allocator, retired.image);
+		return true;
+	});
+
+	swapCompleted();
+
+	std::vector<DecodedTexture> decoded;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		decoded.swap(m_Decoded);
+	}
+	for (auto& texture : decoded) {
+		TextureEntry& entry{ m_Textures[texture.texture] };
+		entry.decoding = false;
+		if (!entry.alive) {
+			m_FreeTextures.emplace_back(texture.texture);
+			continue;
+		}
+		// failed loads keep their handle but never become ready
+		if (texture.pixels.empty() ||
+			!createTexture(
+				texture.texture,
+				texture.width,
+				texture.height,
+				texture.format,
+				1
+			)) {
+			continue;
+		}
+
+		entry.ownedPixels = std::move(texture.pixels);
+		entry.pixels = entry.ownedPixels;
+		if (!queueUpload(texture.texture, 0)) {
+			entry.pixels = {};
+			entry.ownedPixels = {};
+		}
+	}
+
+	updateResidency();
+
+	// oldest first, a texture is finished in the frame its last rows are
+	// copied
+	size_t completed{};
+	for (auto& upload : m_PendingUploads) {
+		if (!streamUpload(ring, cmdBuffer, upload)) {
+			break;
+		}
+
+		finishTexture(cmdBuffer, m_Textures[upload.texture], upload);
+		upload.index = m_BindlessHeap->addSampledImage(
+			upload.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		);
+		m_CompletedUploads.emplace_back(upload);
+		completed++;
+	}
+	m_PendingUploads.erase(
+		m_PendingUploads.begin(), m_PendingUploads.begin() + completed
+	);
+}
+
+TextureHandle TextureManager::allocateHandle() {
+	TextureEntry entry{
+		.index = c_INVALID_BINDLESS_INDEX,
+		.alive = true,
+	};
+
+	TextureHandle texture{};
+	if (!m_FreeTextures.empty()) {
+		texture = m_FreeTextures.back();
+		m_FreeTextures.pop_back();
+		m_Textures[texture] = std::move(entry);
+	} else {
+		texture = (TextureHandle)m_Textures.size();
+		m_Textures.emplace_back(std::move(entry));
+	}
+
+	return texture;
+}
+
+bool TextureManager::createTexture(
+	const TextureHandle texture,
+	const uint32_t width,
+	const uint32_t height,
+	const VkFormat format,
+	const uint32_t mipLevels
+) {
+	PYX_ENGINE_ASSERT_WARNING(width > 0 && height > 0 && mipLevels > 0);
+
+	constexpr VkFormatFeatureFlags c_BLIT_FEATURES{
+		VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
+	};
+
+	// block compressed formats need textureCompressionBC
+	VkFormatFeatureFlags features{ getFormatFeatures(format) };
+	if ((features & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0) {
+		PYX_ENGINE_ERROR(
+			"[Texture] format {0} can not be sampled on this device",
+			(int)format
+		);
+		return false;
+	}
+
+	bool generateMips{ mipLevels == 1 &&
+					   (features & c_BLIT_FEATURES) == c_BLIT_FEATURES };
+
+	TextureEntry& entry{ m_Textures[texture] };
+	entry.extent = { width, height };
+	entry.format = format;
+	entry.mipLevels = generateMips
+		? (uint32_t)std::bit_width(std::max(width, height))
+		: mipLevels;
+	entry.generateMips = generateMips;
+	entry.requestedLevel = getMinResidentLevel(entry);
+
+	return true;
+}
+
+bool TextureManager::queueUpload(
+	const TextureHandle texture, const uint32_t residentLevel
+) {
+	TextureEntry& entry{ m_Textures[texture] };
+
+	VkImageUsageFlags usage{
+		VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
+	};
+	if (entry.generateMips) {
+		usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+
+	uint32_t levelCount{ entry.mipLevels - residentLevel };
+	ImageInfo image{ createImage(
+		m_Allocator,
+		getLevelExtent(entry.extent, residentLevel),
+		entry.format,
+		levelCount,
+		usage
+	) };
+	if (image.handle == VK_NULL_HANDLE) {
+		return false;
+	}
+
+	VkImageViewCreateInfo viewCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.image = image.handle,
+		.viewType = VK_IMAGE_VIEW_TYPE_2D,
+		.format = entry.format,
+		.subresourceRange = {
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel = 0,
+			.levelCount = levelCount,
+			.baseArrayLayer = 0,
+			.layerCount = 1,
+		},
+	};
+	VkImageView view{};
+	VK_CHECK(vkCreateImageView(m_Device, &viewCreateInfo, nullptr, &view));
+
+	VmaAllocationInfo allocationInfo{};
+	vmaGetAllocationInfo(m_Allocator, image.allocation, &allocationInfo);
+	m_ResidentBytes += allocationInfo.size;
+
+	// the current image stays in use until the new one is swapped in
+	entry.streaming = entry.ready;
+	m_PendingUploads.emplace_back(PendingUpload{
+		.texture = texture,
+		.image = image,
+		.view = view,
+		.bytes = allocationInfo.size,
+		.residentLevel = residentLevel,
+		.uploadedLevel = residentLevel,
+		.levelOffset = getChainBytes(
+			getFormatBlock(entry.format), entry.extent, 0, residentLevel
+		),
+		.index = c_INVALID_BINDLESS_INDEX,
+	});
+
+	return true;
+}
+
+bool TextureManager::streamUpload(
+	UploadRing& ring,
+	const VkCommandBuffer cmdBuffer,
+	PendingUpload& upload
+) {
+	const TextureEntry& entry{ m_Textures[upload.texture] };
+	FormatBlock block{ getFormatBlock(entry.format) };
+	uint32_t levelEnd{ entry.generateMips ? 1 : entry.mipLevels };
+
+	while (upload.uploadedLevel < levelEnd) {
+		VkExtent2D extent{ getLevelExtent(entry.extent, upload.uploadedLevel) };
+		uint32_t blockRows{ getBlockRows(block, extent) };
+		VkDeviceSize rowBytes{ getRowBytes(block, extent) };
+		if (upload.uploadedRows == blockRows) {
+			upload.levelOffset += blockRows * rowBytes;
+			upload.uploadedLevel++;
+			upload.uploadedRows = 0;
+			continue;
+		}
+
+		uint32_t rows{ std::min(
+			blockRows - upload.uploadedRows,
+			(uint32_t)std::max<VkDeviceSize>(c_UPLOAD_CHUNK_SIZE / rowBytes, 1)
+		) };
+		std::optional<UploadAllocation> allocation{ writeUpload(
+			ring,
+			entry.pixels.data() + upload.levelOffset +
+				upload.uploadedRows * rowBytes,
+			rows * rowBytes,
+			c_UPLOAD_ALIGNMENT
+		) };
+		if (!allocation.has_value()) {
+			return false;
+		}
+
+		// the image stays in transfer dst across frames until it is finished
+		if (upload.uploadedLevel == upload.residentLevel &&
+			upload.uploadedRows == 0) {
+			VkImageMemoryBarrier2 barrier{ makeLevelBarrier(
+				upload.image.handle,
+				0,
+				entry.mipLevels - upload.residentLevel,
+				VK_IMAGE_LAYOUT_UNDEFINED,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
+			) };
+			recordBarrier(cmdBuffer, { &barrier, 1 });
+		}
+
+		// copies of the last block row may extend past the level, as long as
+		// they end at its edge
+		uint32_t y{ upload.uploadedRows * block.extent };
+		VkBufferImageCopy region{
+			.bufferOffset = allocation->offset,
+			.imageSubresource = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel = upload.uploadedLevel - upload.residentLevel,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+			.imageOffset = { 0, (int32_t)y, 0 },
+			.imageExtent = {
+				extent.width,
+				std::min(rows * block.extent, extent.height - y),
+				1,
+			},
+		};
+		vkCmdCopyBufferToImage(
+			cmdBuffer,
+			allocation->buffer,
+			upload.image.handle,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1,
+			&region
+		);
+		upload.uploadedRows += rows;
+	}
+
+	return true;
+}
+
+void TextureManager::finishTexture(
+	const VkCommandBuffer cmdBuffer,
+	const TextureEntry& entry,
+	const PendingUpload& upload
+) const {
+	VkImage image{ upload.image.handle };
+	uint32_t levelCount{ entry.mipLevels - upload.residentLevel };
+	uint32_t blitLevels{ entry.generateMips ? levelCount : 1 };
+	for (uint32_t level{ 1 }; level < blitLevels; level++) {
+		VkImageMemoryBarrier2 barrier{ makeLevelBarrier(
+			image,
+			level - 1,
+			1,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+		) };
+		recordBarrier(cmdBuffer, { &barrier, 1 });
+
+		VkExtent2D srcExtent{
+			getLevelExtent(entry.extent, upload.residentLevel + level - 1)
+		};
+		int32_t srcWidth{ (int32_t)srcExtent.width };
+		int32_t srcHeight{ (int32_t)srcExtent.height };
+		VkImageBlit blit{
+			.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+			.srcOffsets = { { 0, 0, 0 }, { srcWidth, srcHeight, 1 } },
+			.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+			.dstOffsets = {
+				{ 0, 0, 0 },
+				{ std::max(srcWidth / 2, 1), std::max(srcHeight / 2, 1), 1 },
+			},
+		};
+		vkCmdBlitImage(
+			cmdBuffer,
+			image,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1,
+			&blit,
+			VK_FILTER_LINEAR
+		);
+	}
+
+	// every blitted level but the last was a blit source, the rest were
+	// only written
+	std::array<VkImageMemoryBarrier2, 2> barriers{};
+	uint32_t barrierCount{};
+	if (blitLevels > 1) {
+		barriers[barrierCount++] = makeLevelBarrier(
+			image,
+			0,
+			blitLevels - 1,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+		);
+	}
+	barriers[barrierCount++] = makeLevelBarrier(
+		image,
+		blitLevels - 1,
+		levelCount - blitLevels + 1,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	);
+	recordBarrier(cmdBuffer, { barriers.data(), barrierCount });
+}
+
+void TextureManager::swapCompleted() {
+	for (const auto& upload : m_CompletedUploads) {
+		TextureEntry& entry{ m_Textures[upload.texture] };
+		if (entry.ready) {
+			m_BindlessHeap->remove(BindlessType::sampledImage, entry.index);
+			retireImage(entry.image, entry.view, entry.residentBytes);
+		}
+
+		entry.image = upload.image;
+		entry.view = upload.view;
+		entry.residentLevel = upload.residentLevel;
+		entry.residentBytes = upload.bytes;
+		entry.index = upload.index;
+		entry.ready = true;
+		entry.streaming = false;
+		// textures that are always fully resident are done with their pixels
+		if (getMinResidentLevel(entry) == 0) {
+			entry.pixels = {};
+			entry.ownedPixels = {};
+		}
+	}
+	m_CompletedUploads.clear();
+}
+
+void TextureManager::updateResidency() {
+	// textures being replaced count with their replacement, and what is
+	// about to be freed does not count against the heap
+	VkDeviceSize textureBytes{};
+	VkDeviceSize releasingBytes{};
+	for (const auto& entry : m_Textures) {
+		if (!entry.alive || !entry.ready) {
+			continue;
+		}
+		if (entry.streaming) {
+			releasingBytes += entry.residentBytes;
+		} else {
+			textureBytes += entry.residentBytes;
+		}
+	}
+	for (const auto& uploads : { &m_PendingUploads, &m_CompletedUploads }) {
+		for (const auto& upload : *uploads) {
+			textureBytes += upload.bytes;
+		}
+	}
+	for (const auto& retired : m_RetiredTextures) {
+		releasingBytes += retired.bytes;
+	}
+	VkDeviceSize budget{ getTextureBudget(textureBytes, releasingBytes) };
+
+	std::vector<TextureHandle> candidates;
+	for (TextureHandle texture{}; texture < m_Textures.size(); texture++) {
+		const TextureEntry& entry{ m_Textures[texture] };
+		if (entry.alive && entry.ready && !entry.streaming &&
+			!entry.generateMips) {
+			candidates.emplace_back(texture);
+		}
+	}
+
+	uint32_t changes{};
+	if (textureBytes > budget) {
+		// least recently requested first, the largest among those
+		std::ranges::sort(candidates, [&](TextureHandle a, TextureHandle b) {
+			const TextureEntry& entryA{ m_Textures[a] };
+			const TextureEntry& entryB{ m_Textures[b] };
+			if (entryA.requestFrame != entryB.requestFrame) {
+				return entryA.requestFrame < entryB.requestFrame;
+			}
+			return entryA.residentBytes > entryB.residentBytes;
+		});
+
+		for (TextureHandle texture : candidates) {
+			if (textureBytes <= budget || changes == c_MAX_RESIDENCY_CHANGES) {
+				break;
+			}
+			const TextureEntry& entry{ m_Textures[texture] };
+			if (entry.residentLevel >= getMinResidentLevel(entry)) {
+				continue;
+			}
+			VkDeviceSize residentBytes{ entry.residentBytes };
+			if (!queueUpload(texture, entry.residentLevel + 1)) {
+				continue;
+			}
+			textureBytes =
+				textureBytes - residentBytes + m_PendingUploads.back().bytes;
+			changes++;
+		}
+		return;
+	}
+
+	// most recently requested first, the largest jump in detail among those
+	std::ranges::sort(candidates, [&](TextureHandle a, TextureHandle b) {
+		const TextureEntry& entryA{ m_Textures[a] };
+		const TextureEntry& entryB{ m_Textures[b] };
+		if (entryA.requestFrame != entryB.requestFrame) {
+			return entryA.requestFrame > entryB.requestFrame;
+		}
+		return (int32_t)(entryA.residentLevel - entryA.requestedLevel) >
+			(int32_t)(entryB.residentLevel - entryB.requestedLevel);
+	});
+
+	for (TextureHandle texture : candidates) {
+		if (changes == c_MAX_RESIDENCY_CHANGES) {
+			break;
+		}
+		const TextureEntry& entry{ m_Textures[texture] };
+		if (entry.requestFrame + c_REQUEST_FRAMES < m_Frame) {
+			break;
+		}
+		if (entry.requestedLevel >= entry.residentLevel) {
+			continue;
+		}
+		// smaller requests further down may still fit
+		VkDeviceSize bytes{ getChainBytes(
+			getFormatBlock(entry.format),
+			entry.extent,
+			entry.requestedLevel,
+			entry.mipLevels - entry.requestedLevel
+		) };
+		if (textureBytes - entry.residentBytes + bytes > budget) {
+			continue;
+		}
+		VkDeviceSize residentBytes{ entry.residentBytes };
+		if (!queueUpload(texture, entry.requestedLevel)) {
+			continue;
+		}
+		textureBytes =
+			textureBytes - residentBytes + m_PendingUploads.back().bytes;
+		changes++;
+	}
+}
+
+VkDeviceSize TextureManager::getTextureBudget(
+	const VkDeviceSize textureBytes, const VkDeviceSize releasingBytes
+) const {
+	MemoryBudget heap{ getDeviceLocalBudget(m_Allocator) };
+	VkDeviceSize usage{ heap.usage - std::min(heap.usage, releasingBytes) };
+	VkDeviceSize heapLimit{ heap.budget / 100 * c_HEAP_BUDGET_PERCENT };
+
+	// textures may grow into whatever the heap has left and have to shrink
+	// by as much as it is over
+	VkDeviceSize budget{};
+	if (usage <= heapLimit) {
+		budget = textureBytes + (heapLimit - usage);
+	} else {
+		budget = textureBytes - std::min(textureBytes, usage - heapLimit);
+	}
+	if (m_Budget != 0) {
+		budget = std::min(budget, m_Budget);
+	}
+
+	return budget;
+}
+
+uint32_t TextureManager::getMinResidentLevel(const TextureEntry& entry) const {
+	if (entry.generateMips) {
+		return 0;
+	}
+
+	uint32_t level{};
+	while (level + 1 < entry.mipLevels) {
+		VkExtent2D extent{ getLevelExtent(entry.extent, level) };
+		if (std::max(extent.width, extent.height) <= c_RESIDENT_TAIL_SIZE) {
+			break;
+		}
+		level++;
+	}
+
+	return level;
+}
+
+void TextureManager::retireImage(
+	const ImageInfo image, const VkImageView view, const VkDeviceSize bytes
+) {
+	m_RetiredTextures.emplace_back(RetiredTexture{
+		.image = image,
+		.view = view,
+		.bytes = bytes,
+		.frame = m_Frame,
+	});
+	m_ResidentBytes -= bytes;
+}
+
+VkFormatFeatureFlags TextureManager::getFormatFeatures(const VkFormat format
+) const {
+	VkFormatProperties properties{};
+	vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &properties);
+
+	return properties.optimalTilingFeatures;
+}
+
+namespace {
+	FormatBlock getFormatBlock(const VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+			case VK_FORMAT_B8G8R8A8_UNORM:
+			case VK_FORMAT_B8G8R8A8_SRGB:
+				return FormatBlock{ .extent = 1, .bytes = 4 };
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+			case VK_FORMAT_BC4_SNORM_BLOCK:
+				return FormatBlock{ .extent = 4, .bytes = 8 };
+			case VK_FORMAT_BC2_UNORM_BLOCK:
+			case VK_FORMAT_BC2_SRGB_BLOCK:
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC5_SNORM_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return FormatBlock{ .extent = 4, .bytes = 16 };
+			default:
+				return FormatBlock{};
+		}
+	}
+
+	VkExtent2D getLevelExtent(const VkExtent2D extent, const uint32_t level) {
+		return VkExtent2D{
+			.width = std::max(extent.width >> level, 1u),
+			.height = std::max(extent.height >> level, 1u),
+		};
+	}
+
+	uint32_t getBlockRows(const FormatBlock block, const VkExtent2D extent) {
+		return (extent.height + block.extent - 1) / block.extent;
+	}
+
+	VkDeviceSize getRowBytes(const FormatBlock block, const VkExtent2D extent) {
+		return (VkDeviceSize)(extent.width + block.extent - 1) / block.extent *
+			block.bytes;
+	}
+
+	VkDeviceSize getChainBytes(
+		const FormatBlock block,
+		const VkExtent2D extent,
+		const uint32_t firstLevel,
+		const uint32_t levelCount
+	) {
+		VkDeviceSize bytes{};
+		for (uint32_t level{ firstLevel }; level < firstLevel + levelCount;
+			 level++) {
+			VkExtent2D levelExtent{ getLevelExtent(extent, level) };
+			bytes += getBlockRows(block, levelExtent) *
+				getRowBytes(block, levelExtent);
+		}
+
+		return bytes;
+	}
+
+	VkImageMemoryBarrier2 makeLevelBarrier(
+		const VkImage image,
+		const uint32_t baseLevel,
+		const uint32_t levelCount,
+		const VkImageLayout oldLayout,
+		const VkImageLayout newLayout
+	) {
+		VkImageMemoryBarrier2 barrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.oldLayout = oldLayout,
+			.newLayout = newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = image,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = baseLevel,
+				.levelCount = levelCount,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+
+		switch (oldLayout) {
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+				barrier.srcStageMask =
+					VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT;
+				barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+				barrier.srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+				break;
+			default:
+				barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+				break;
+		}
+
+		switch (newLayout) {
+			case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+				barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+				barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+				break;
+			case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+				barrier.dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+				barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+				break;
+			default:
+				barrier.dstStageMask = c_TEXTURE_STAGES;
+				barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+				break;
+		}
+
+		return barrier;
+	}
+
+	void recordBarrier(
+		const VkCommandBuffer cmdBuffer,
+		const std::span<const VkImageMemoryBarrier2> barriers
+	) {
+		VkDependencyInfo dependencyInfo{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.imageMemoryBarrierCount = (uint32_t)barriers.size(),
+			.pImageMemoryBarriers = barriers.data(),
+		};
+		vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+	}
+}  // namespace
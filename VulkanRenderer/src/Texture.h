@@ -0,0 +1,262 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+#include <vk_mem_alloc.h>
+
+#include "Bindless.h"
+#include "Memory.h"
+#include "UploadRing.h"
+
+using TextureHandle = uint32_t;
+constexpr TextureHandle c_INVALID_TEXTURE{ UINT32_MAX };
+
+struct SamplerDesc {
+	VkFilter filter;
+	VkSamplerMipmapMode mipmapMode;
+	VkSamplerAddressMode addressMode;
+	// clamped to the device limit, 1 turns anisotropic filtering off
+	float maxAnisotropy;
+
+	bool operator==(const SamplerDesc&) const = default;
+};
+
+struct SamplerDescHash {
+	size_t operator()(const SamplerDesc& desc) const;
+};
+
+struct CachedSampler {
+	VkSampler sampler;
+	BindlessIndex index;
+};
+
+// samplers are created once per distinct description and registered with
+// the bindless heap, so any number of textures can share them
+class SamplerCache {
+   public:
+	void init(
+		const VkPhysicalDevice pDevice,
+		const VkDevice device,
+		BindlessHeap* bindlessHeap
+	);
+	void shutdown();
+
+	CachedSampler getSampler(const SamplerDesc& desc);
+
+   private:
+	VkDevice m_Device{};
+	BindlessHeap* m_BindlessHeap{};
+	float m_MaxAnisotropy{};
+
+	std::unordered_map<SamplerDesc, CachedSampler, SamplerDescHash> m_Samplers;
+};
+
+// of the resident levels, the index changes whenever the residency does so
+// it has to be fetched every frame
+struct TextureDrawInfo {
+	BindlessIndex image;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipLevels;
+};
+
+// sampled 2d textures. files are decoded with stb_image on the thread pool,
+// pixels are streamed through the upload ring over as many frames as it
+// takes, then the mip chain is generated with blits on the graphics queue.
+// cooked block compressed textures bring their own mips and are copied as
+// is. textures are registered with the bindless heap once they are complete.
+//
+// textures with their own mips start out with only the coarse tail resident.
+// finer levels are streamed in when requested and dropped again, least
+// recently requested first, when textures outgrow the memory budget. a
+// residency change uploads a new image next to the old one and swaps them
+// once it is complete, so sampling never waits on streaming.
+class TextureManager {
+   public:
+	void init(
+		const VkPhysicalDevice pDevice,
+		const VkDevice device,
+		const VmaAllocator allocator,
+		BindlessHeap* bindlessHeap,
+		const uint32_t framesInFlight
+	);
+	// waits for running decodes
+	void shutdown();
+
+	// decoded in the background, srgb for color data
+	TextureHandle
+		requestLoad(const std::filesystem::path& path, const bool srgb);
+	// mipLevels levels of format back to back, block compressed formats
+	// included. a single level of a format that can be blitted gets the rest
+	// of its chain generated
+	TextureHandle addTexture(
+		std::vector<uint8_t> pixels,
+		const uint32_t width,
+		const uint32_t height,
+		const VkFormat format,
+		const uint32_t mipLevels
+	);
+	// same as above without taking ownership, textures with mips stream
+	// from the pixels for as long as they live. used for payloads in mapped
+	// archives
+	TextureHandle addTexture(
+		const std::span<const uint8_t> pixels,
+		const uint32_t width,
+		const uint32_t height,
+		const VkFormat format,
+		const uint32_t mipLevels
+	);
+	// the image is destroyed once the frames in flight are done with it
+	void removeTexture(const TextureHandle texture);
+
+	// uploaded, mipmapped and registered with the bindless heap
+	bool isTextureReady(const TextureHandle texture) const;
+	// no decode, upload or residency change is running or pending
+	bool isIdle();
+	TextureDrawInfo getTexture(const TextureHandle texture) const;
+
+	// residency feedback, the finest level wanted this frame. requests older
+	// than a few frames no longer stream levels in
+	void requestLevel(const TextureHandle texture, const uint32_t level);
+	// the level whose texels are about the size of pixels covering
+	// screenSize pixels along the larger side of the texture
+	void requestScreenSize(const TextureHandle texture, const float screenSize);
+	// caps the bytes of resident textures, 0 leaves only the limit derived
+	// from the device local heap budget
+	void setBudget(const VkDeviceSize budget);
+	VkDeviceSize getResidentBytes() const { return m_ResidentBytes; }
+
+	// streams pending pixels, generates mips and balances residency against
+	// the budget, call once per frame on the graphics queue after
+	// beginUploadRegion and before the render pass
+	void update(UploadRing& ring, const VkCommandBuffer cmdBuffer);
+
+   private:
+	struct TextureEntry {
+		ImageInfo image;
+		VkImageView view;
+		// of the whole chain, the image holds residentLevel and coarser
+		VkExtent2D extent;
+		VkFormat format;
+		uint32_t mipLevels;
+		uint32_t residentLevel;
+		VkDeviceSize residentBytes;
+		BindlessIndex index;
+		// every level back to back, kept while the texture can stream
+		std::span<const uint8_t> pixels;
+		std::vector<uint8_t> ownedPixels;
+		uint32_t requestedLevel;
+		uint64_t requestFrame;
+		bool alive;
+		// only the base level is uploaded, the rest is blitted from it. these
+		// textures are always fully resident
+		bool generateMips;
+		// the handle is only reused after the decode job has reported back
+		bool decoding;
+		bool ready;
+		// a new image with a different resident level is being uploaded
+		bool streaming;
+	};
+
+	struct PendingUpload {
+		TextureHandle texture;
+		// replaces the texture's image once every level is uploaded
+		ImageInfo image;
+		VkImageView view;
+		VkDeviceSize bytes;
+		uint32_t residentLevel;
+		// levels of the whole chain, uploadedRows are block rows of
+		// uploadedLevel, which starts at levelOffset
+		uint32_t uploadedLevel;
+		uint32_t uploadedRows;
+		size_t levelOffset;
+		// registered when the upload is finished and swapped in next frame,
+		// after the bindless heap has written the descriptor
+		BindlessIndex index;
+	};
+
+	struct DecodedTexture {
+		TextureHandle texture;
+		std::vector<uint8_t> pixels;
+		uint32_t width;
+		uint32_t height;
+		VkFormat format;
+	};
+
+	struct RetiredTexture {
+		ImageInfo image;
+		VkImageView view;
+		VkDeviceSize bytes;
+		uint64_t frame;
+	};
+
+	TextureHandle allocateHandle();
+	// fills in the entry of an already allocated handle
+	bool createTexture(
+		const TextureHandle texture,
+		const uint32_t width,
+		const uint32_t height,
+		const VkFormat format,
+		const uint32_t mipLevels
+	);
+	// creates an image of residentLevel and coarser and queues its upload
+	bool queueUpload(const TextureHandle texture, const uint32_t residentLevel);
+	// false once the upload region is full
+	bool streamUpload(
+		UploadRing& ring,
+		const VkCommandBuffer cmdBuffer,
+		PendingUpload& upload
+	);
+	// generates the mip chain if the image has one and transitions every
+	// level for sampling
+	void finishTexture(
+		const VkCommandBuffer cmdBuffer,
+		const TextureEntry& entry,
+		const PendingUpload& upload
+	) const;
+	// makes finished uploads the texture's image
+	void swapCompleted();
+	// evicts levels while over budget and streams requested levels in while
+	// they fit
+	void updateResidency();
+	// releasingBytes are still allocated but about to be freed
+	VkDeviceSize getTextureBudget(
+		const VkDeviceSize textureBytes, const VkDeviceSize releasingBytes
+	) const;
+	// coarsest level a streaming texture keeps resident
+	uint32_t getMinResidentLevel(const TextureEntry& entry) const;
+	void retireImage(
+		const ImageInfo image, const VkImageView view, const VkDeviceSize bytes
+	);
+	VkFormatFeatureFlags getFormatFeatures(const VkFormat format) const;
+
+	VkPhysicalDevice m_PhysicalDevice{};
+	VkDevice m_Device{};
+	VmaAllocator m_Allocator{};
+	BindlessHeap* m_BindlessHeap{};
+	uint32_t m_FramesInFlight{};
+	uint64_t m_Frame{};
+	VkDeviceSize m_Budget{};
+	// resident and pending images
+	VkDeviceSize m_ResidentBytes{};
+
+	std::vector<TextureEntry> m_Textures;
+	std::vector<TextureHandle> m_FreeTextures;
+	std::vector<PendingUpload> m_PendingUploads;
+	std::vector<PendingUpload> m_CompletedUploads;
+	std::vector<RetiredTexture> m_RetiredTextures;
+
+	std::mutex m_DecodedMutex;
+	std::vector<DecodedTexture> m_Decoded;
+
+	std::atomic<uint32_t> m_RunningDecodes{};
+	std::mutex m_IdleMutex;
+	std::condition_variable m_Idle;
+};
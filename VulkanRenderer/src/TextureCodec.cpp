@@ -0,0 +1,885 @@
+#include "TextureCodec.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define PYX_TEXTURE_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace {
+	constexpr uint32_t c_BLOCK_EXTENT{ 4 };
+	constexpr uint32_t c_BLOCK_TEXELS{ 16 };
+	constexpr uint32_t c_POWER_ITERATIONS{ 4 };
+
+	// palette positions in format order, the palettes below run from the
+	// first endpoint to the second
+	constexpr uint8_t c_BC1_CODES[4]{ 0, 2, 3, 1 };
+	constexpr uint8_t c_BC4_CODES[8]{ 0, 2, 3, 4, 5, 6, 7, 1 };
+	constexpr uint32_t c_BC7_WEIGHTS[16]{ 0,  4,  9,  13, 17, 21, 26, 30,
+										  34, 38, 43, 47, 51, 55, 60, 64 };
+	// mode 6 is a one in bit 6 after six zeros
+	constexpr uint32_t c_BC7_MODE6{ 1 << 6 };
+
+	// channel major so four texels of a channel fill a register
+	struct BlockTexels {
+		alignas(16) float channels[4][c_BLOCK_TEXELS];
+	};
+
+	// channels relative to the first one being encoded
+	struct Endpoints {
+		float first[4];
+		float second[4];
+	};
+
+	struct Palette {
+		float colors[16][4];
+		uint32_t size;
+	};
+
+	struct Bc7Endpoints {
+		uint32_t first[4];
+		uint32_t second[4];
+		uint32_t firstP;
+		uint32_t secondP;
+	};
+
+	// 128 bits written least significant first
+	struct BitWriter {
+		uint64_t words[2];
+		uint32_t offset;
+	};
+
+	BlockTexels loadBlock(
+		const std::span<const uint8_t> rgba,
+		const uint32_t width,
+		const uint32_t height,
+		const uint32_t blockX,
+		const uint32_t blockY
+	);
+	void encodeBlock(
+		const BlockTexels& block,
+		const BlockFormat format,
+		const BlockQuality quality,
+		uint8_t* out
+	);
+	uint32_t getRefinementCount(const BlockQuality quality);
+
+	Endpoints fitPrincipalAxis(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount
+	);
+	// least squares endpoints for the chosen indices, unchanged if every
+	// texel picked the same weight
+	void refineEndpoints(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount,
+		const uint8_t* indices,
+		const float* weights,
+		Endpoints& endpoints
+	);
+	// the closest palette entry for every texel, returns the squared error
+	float selectIndices(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount,
+		const Palette& palette,
+		uint8_t* indices
+	);
+
+	void encodeBc1(
+		const BlockTexels& block, const BlockQuality quality, uint8_t* out
+	);
+	void encodeBc4(
+		const BlockTexels& block,
+		const uint32_t channel,
+		const BlockQuality quality,
+		uint8_t* out
+	);
+	void encodeBc7(
+		const BlockTexels& block, const BlockQuality quality, uint8_t* out
+	);
+	uint16_t packRgb565(const float* color);
+	void unpackRgb565(const uint16_t color, float* out);
+	// a negative p bit is picked per endpoint by the smaller error
+	Bc7Endpoints quantizeBc7(
+		const Endpoints& endpoints, const int32_t firstP, const int32_t secondP
+	);
+
+	void writeBits(
+		BitWriter& writer, const uint64_t value, const uint32_t count
+	);
+	uint32_t
+		readBits(const uint8_t* data, uint32_t& offset, const uint32_t count);
+
+	void decodeBc1(const uint8_t* data, uint8_t (*texels)[4]);
+	void decodeBc4(
+		const uint8_t* data, const uint32_t channel, uint8_t (*texels)[4]
+	);
+	void decodeBc7(const uint8_t* data, uint8_t (*texels)[4]);
+}  // namespace
+
+VkFormat getBlockVkFormat(const BlockFormat format, const bool srgb) {
+	switch (format) {
+		case BlockFormat::bc1:
+			return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK
+						: VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case BlockFormat::bc3:
+			return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+		case BlockFormat::bc5:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case BlockFormat::bc7:
+			return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+	}
+
+	return VK_FORMAT_UNDEFINED;
+}
+
+uint32_t getBlockBytes(const BlockFormat format) {
+	return format == BlockFormat::bc1 ? 8 : 16;
+}
+
+size_t getCompressedSize(
+	const BlockFormat format, const uint32_t width, const uint32_t height
+) {
+	return (size_t)((width + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT) *
+		((height + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT) *
+		getBlockBytes(format);
+}
+
+std::vector<uint8_t> compressTexture(
+	const std::span<const uint8_t> rgba,
+	const uint32_t width,
+	const uint32_t height,
+	const BlockFormat format,
+	const BlockQuality quality
+) {
+	PYX_ENGINE_ASSERT_WARNING(rgba.size() >= (size_t)width * height * 4);
+
+	uint32_t blocksX{ (width + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT };
+	uint32_t blocksY{ (height + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT };
+	uint32_t blockBytes{ getBlockBytes(format) };
+	std::vector<uint8_t> blocks((size_t)blocksX * blocksY * blockBytes);
+
+	// rows are handed out in batches, the caller encodes some of them too
+	ThreadPool::parallelFor(
+		blocksY,
+		0,
+		[&](const uint32_t firstRow, const uint32_t lastRow, uint32_t) {
+			for (uint32_t blockY{ firstRow }; blockY < lastRow; blockY++) {
+				uint8_t* out{
+					blocks.data() + (size_t)blockY * blocksX * blockBytes
+				};
+				for (uint32_t blockX{}; blockX < blocksX; blockX++) {
+					encodeBlock(
+						loadBlock(rgba, width, height, blockX, blockY),
+						format,
+						quality,
+						out + blockX * blockBytes
+					);
+				}
+			}
+		}
+	);
+
+	return blocks;
+}
+
+std::vector<uint8_t> decompressTexture(
+	const std::span<const uint8_t> blocks,
+	const uint32_t width,
+	const uint32_t height,
+	const BlockFormat format
+) {
+	PYX_ENGINE_ASSERT_WARNING(
+		blocks.size() >= getCompressedSize(format, width, height)
+	);
+
+	uint32_t blocksX{ (width + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT };
+	uint32_t blocksY{ (height + c_BLOCK_EXTENT - 1) / c_BLOCK_EXTENT };
+	uint32_t blockBytes{ getBlockBytes(format) };
+	std::vector<uint8_t> rgba((size_t)width * height * 4);
+
+	for (uint32_t blockY{}; blockY < blocksY; blockY++) {
+		for (uint32_t blockX{}; blockX < blocksX; blockX++) {
+			const uint8_t* data{
+				blocks.data() + ((size_t)blockY * blocksX + blockX) * blockBytes
+			};
+			uint8_t texels[c_BLOCK_TEXELS][4]{};
+			switch (format) {
+				case BlockFormat::bc1:
+					decodeBc1(data, texels);
+					break;
+				case BlockFormat::bc3:
+					decodeBc1(data + 8, texels);
+					decodeBc4(data, 3, texels);
+					break;
+				case BlockFormat::bc5:
+					decodeBc4(data, 0, texels);
+					decodeBc4(data + 8, 1, texels);
+					for (auto& texel : texels) {
+						texel[3] = 255;
+					}
+					break;
+				case BlockFormat::bc7:
+					decodeBc7(data, texels);
+					break;
+			}
+
+			for (uint32_t y{}; y < c_BLOCK_EXTENT; y++) {
+				for (uint32_t x{}; x < c_BLOCK_EXTENT; x++) {
+					uint32_t pixelX{ blockX * c_BLOCK_EXTENT + x };
+					uint32_t pixelY{ blockY * c_BLOCK_EXTENT + y };
+					if (pixelX < width && pixelY < height) {
+						memcpy(
+							rgba.data() + ((size_t)pixelY * width + pixelX) * 4,
+							texels[y * c_BLOCK_EXTENT + x],
+							4
+						);
+					}
+				}
+			}
+		}
+	}
+
+	return rgba;
+}
+
+namespace {
+	BlockTexels loadBlock(
+		const std::span<const uint8_t> rgba,
+		const uint32_t width,
+		const uint32_t height,
+		const uint32_t blockX,
+		const uint32_t blockY
+	) {
+		BlockTexels block{};
+		for (uint32_t y{}; y < c_BLOCK_EXTENT; y++) {
+			uint32_t pixelY{
+				std::min(blockY * c_BLOCK_EXTENT + y, height - 1)
+			};
+			for (uint32_t x{}; x < c_BLOCK_EXTENT; x++) {
+				uint32_t pixelX{
+					std::min(blockX * c_BLOCK_EXTENT + x, width - 1)
+				};
+				const uint8_t* texel{
+					rgba.data() + ((size_t)pixelY * width + pixelX) * 4
+				};
+				for (uint32_t channel{}; channel < 4; channel++) {
+					block.channels[channel][y * c_BLOCK_EXTENT + x] =
+						texel[channel];
+				}
+			}
+		}
+
+		return block;
+	}
+
+	void encodeBlock(
+		const BlockTexels& block,
+		const BlockFormat format,
+		const BlockQuality quality,
+		uint8_t* out
+	) {
+		switch (format) {
+			case BlockFormat::bc1:
+				encodeBc1(block, quality, out);
+				break;
+			case BlockFormat::bc3:
+				encodeBc4(block, 3, quality, out);
+				encodeBc1(block, quality, out + 8);
+				break;
+			case BlockFormat::bc5:
+				encodeBc4(block, 0, quality, out);
+				encodeBc4(block, 1, quality, out + 8);
+				break;
+			case BlockFormat::bc7:
+				encodeBc7(block, quality, out);
+				break;
+		}
+	}
+
+	uint32_t getRefinementCount(const BlockQuality quality) {
+		switch (quality) {
+			case BlockQuality::fast:
+				return 0;
+			case BlockQuality::normal:
+				return 1;
+			case BlockQuality::high:
+				return 3;
+		}
+
+		return 0;
+	}
+
+	Endpoints fitPrincipalAxis(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount
+	) {
+		float mean[4]{};
+		for (uint32_t i{}; i < channelCount; i++) {
+			for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+				mean[i] += block.channels[firstChannel + i][texel];
+			}
+			mean[i] /= c_BLOCK_TEXELS;
+		}
+
+		float covariance[4][4]{};
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			for (uint32_t i{}; i < channelCount; i++) {
+				float di{ block.channels[firstChannel + i][texel] - mean[i] };
+				for (uint32_t j{ i }; j < channelCount; j++) {
+					float dj{
+						block.channels[firstChannel + j][texel] - mean[j]
+					};
+					covariance[i][j] += di * dj;
+				}
+			}
+		}
+		for (uint32_t i{}; i < channelCount; i++) {
+			for (uint32_t j{}; j < i; j++) {
+				covariance[i][j] = covariance[j][i];
+			}
+		}
+
+		// the column of the widest channel is never orthogonal to the
+		// principal axis unless the block is degenerate
+		uint32_t widest{};
+		for (uint32_t i{ 1 }; i < channelCount; i++) {
+			if (covariance[i][i] > covariance[widest][widest]) {
+				widest = i;
+			}
+		}
+		float axis[4]{};
+		for (uint32_t i{}; i < channelCount; i++) {
+			axis[i] = covariance[i][widest];
+		}
+		for (uint32_t iteration{}; iteration < c_POWER_ITERATIONS;
+			 iteration++) {
+			float next[4]{};
+			float length{};
+			for (uint32_t i{}; i < channelCount; i++) {
+				for (uint32_t j{}; j < channelCount; j++) {
+					next[i] += covariance[i][j] * axis[j];
+				}
+				length = std::max(length, std::abs(next[i]));
+			}
+			if (length < FLT_EPSILON) {
+				break;
+			}
+			for (uint32_t i{}; i < channelCount; i++) {
+				axis[i] = next[i] / length;
+			}
+		}
+
+		float lengthSquared{};
+		for (uint32_t i{}; i < channelCount; i++) {
+			lengthSquared += axis[i] * axis[i];
+		}
+		Endpoints endpoints{};
+		if (lengthSquared < FLT_EPSILON) {
+			std::copy_n(mean, 4, endpoints.first);
+			std::copy_n(mean, 4, endpoints.second);
+			return endpoints;
+		}
+
+		float minT{ FLT_MAX };
+		float maxT{ -FLT_MAX };
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			float t{};
+			for (uint32_t i{}; i < channelCount; i++) {
+				t += (block.channels[firstChannel + i][texel] - mean[i]) *
+					axis[i];
+			}
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+		for (uint32_t i{}; i < channelCount; i++) {
+			float scale{ axis[i] / lengthSquared };
+			endpoints.first[i] =
+				std::clamp(mean[i] + minT * scale, 0.0f, 255.0f);
+			endpoints.second[i] =
+				std::clamp(mean[i] + maxT * scale, 0.0f, 255.0f);
+		}
+
+		return endpoints;
+	}
+
+	void refineEndpoints(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount,
+		const uint8_t* indices,
+		const float* weights,
+		Endpoints& endpoints
+	) {
+		float firstSquared{};
+		float secondSquared{};
+		float cross{};
+		float firstSum[4]{};
+		float secondSum[4]{};
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			float second{ weights[indices[texel]] };
+			float first{ 1.0f - second };
+			firstSquared += first * first;
+			secondSquared += second * second;
+			cross += first * second;
+			for (uint32_t i{}; i < channelCount; i++) {
+				float value{ block.channels[firstChannel + i][texel] };
+				firstSum[i] += first * value;
+				secondSum[i] += second * value;
+			}
+		}
+
+		float determinant{ firstSquared * secondSquared - cross * cross };
+		if (std::abs(determinant) < 1e-6f) {
+			return;
+		}
+		for (uint32_t i{}; i < channelCount; i++) {
+			endpoints.first[i] = std::clamp(
+				(firstSum[i] * secondSquared - secondSum[i] * cross) /
+					determinant,
+				0.0f,
+				255.0f
+			);
+			endpoints.second[i] = std::clamp(
+				(secondSum[i] * firstSquared - firstSum[i] * cross) /
+					determinant,
+				0.0f,
+				255.0f
+			);
+		}
+	}
+
+	float selectIndices(
+		const BlockTexels& block,
+		const uint32_t firstChannel,
+		const uint32_t channelCount,
+		const Palette& palette,
+		uint8_t* indices
+	) {
+		float error{};
+#ifdef PYX_TEXTURE_SSE2
+		for (uint32_t group{}; group < c_BLOCK_TEXELS; group += 4) {
+			__m128 texels[4];
+			for (uint32_t i{}; i < channelCount; i++) {
+				texels[i] =
+					_mm_load_ps(&block.channels[firstChannel + i][group]);
+			}
+
+			__m128 best{ _mm_set1_ps(FLT_MAX) };
+			__m128i bestIndex{ _mm_setzero_si128() };
+			for (uint32_t entry{}; entry < palette.size; entry++) {
+				__m128 distance{ _mm_setzero_ps() };
+				for (uint32_t i{}; i < channelCount; i++) {
+					__m128 delta{ _mm_sub_ps(
+						texels[i], _mm_set1_ps(palette.colors[entry][i])
+					) };
+					distance = _mm_add_ps(distance, _mm_mul_ps(delta, delta));
+				}
+				__m128i closer{
+					_mm_castps_si128(_mm_cmplt_ps(distance, best))
+				};
+				best = _mm_min_ps(distance, best);
+				bestIndex = _mm_or_si128(
+					_mm_and_si128(closer, _mm_set1_epi32((int32_t)entry)),
+					_mm_andnot_si128(closer, bestIndex)
+				);
+			}
+
+			alignas(16) int32_t groupIndices[4];
+			alignas(16) float groupErrors[4];
+			_mm_store_si128((__m128i*)groupIndices, bestIndex);
+			_mm_store_ps(groupErrors, best);
+			for (uint32_t i{}; i < 4; i++) {
+				indices[group + i] = (uint8_t)groupIndices[i];
+				error += groupErrors[i];
+			}
+		}
+#else
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			float best{ FLT_MAX };
+			for (uint32_t entry{}; entry < palette.size; entry++) {
+				float distance{};
+				for (uint32_t i{}; i < channelCount; i++) {
+					float delta{ block.channels[firstChannel + i][texel] -
+								 palette.colors[entry][i] };
+					distance += delta * delta;
+				}
+				if (distance < best) {
+					best = distance;
+					indices[texel] = (uint8_t)entry;
+				}
+			}
+			error += best;
+		}
+#endif
+
+		return error;
+	}
+
+	void encodeBc1(
+		const BlockTexels& block, const BlockQuality quality, uint8_t* out
+	) {
+		constexpr float c_WEIGHTS[4]{ 0.0f, 1.0f / 3, 2.0f / 3, 1.0f };
+
+		Endpoints endpoints{ fitPrincipalAxis(block, 0, 3) };
+		float bestError{ FLT_MAX };
+		uint16_t bestColors[2]{};
+		uint8_t bestIndices[c_BLOCK_TEXELS]{};
+
+		uint32_t refinements{ getRefinementCount(quality) };
+		for (uint32_t pass{}; pass <= refinements; pass++) {
+			uint16_t colors[2]{ packRgb565(endpoints.first),
+								packRgb565(endpoints.second) };
+			// four colors are only decoded when the first is greater
+			if (colors[0] < colors[1]) {
+				std::swap(colors[0], colors[1]);
+			}
+
+			Palette palette{ .colors = {}, .size = 4 };
+			float first[3]{};
+			float second[3]{};
+			unpackRgb565(colors[0], first);
+			unpackRgb565(colors[1], second);
+			for (uint32_t entry{}; entry < 4; entry++) {
+				for (uint32_t i{}; i < 3; i++) {
+					palette.colors[entry][i] = first[i] +
+						(second[i] - first[i]) * c_WEIGHTS[entry];
+				}
+			}
+
+			uint8_t indices[c_BLOCK_TEXELS]{};
+			float error{ selectIndices(block, 0, 3, palette, indices) };
+			if (error < bestError) {
+				bestError = error;
+				std::copy_n(colors, 2, bestColors);
+				std::copy_n(indices, c_BLOCK_TEXELS, bestIndices);
+			}
+			if (colors[0] == colors[1]) {
+				break;
+			}
+
+			refineEndpoints(block, 0, 3, indices, c_WEIGHTS, endpoints);
+		}
+
+		uint32_t codes{};
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			// equal colors decode in three color mode, index 0 is still the
+			// first color
+			uint32_t code{ bestColors[0] == bestColors[1]
+							   ? 0u
+							   : c_BC1_CODES[bestIndices[texel]] };
+			codes |= code << (texel * 2);
+		}
+		memcpy(out, bestColors, 4);
+		memcpy(out + 4, &codes, 4);
+	}
+
+	void encodeBc4(
+		const BlockTexels& block,
+		const uint32_t channel,
+		const BlockQuality quality,
+		uint8_t* out
+	) {
+		constexpr float c_WEIGHTS[8]{ 0.0f,		1.0f / 7, 2.0f / 7, 3.0f / 7,
+									  4.0f / 7, 5.0f / 7, 6.0f / 7, 1.0f };
+
+		Endpoints endpoints{ fitPrincipalAxis(block, channel, 1) };
+		float bestError{ FLT_MAX };
+		uint8_t bestValues[2]{};
+		uint8_t bestIndices[c_BLOCK_TEXELS]{};
+
+		uint32_t refinements{ getRefinementCount(quality) };
+		for (uint32_t pass{}; pass <= refinements; pass++) {
+			// eight values are only decoded when the first is greater
+			uint8_t values[2]{
+				(uint8_t)std::lround(
+					std::max(endpoints.first[0], endpoints.second[0])
+				),
+				(uint8_t)std::lround(
+					std::min(endpoints.first[0], endpoints.second[0])
+				),
+			};
+
+			Palette palette{ .colors = {}, .size = 8 };
+			for (uint32_t entry{}; entry < 8; entry++) {
+				palette.colors[entry][0] =
+					((7 - entry) * values[0] + entry * values[1]) / 7.0f;
+			}
+
+			uint8_t indices[c_BLOCK_TEXELS]{};
+			float error{ selectIndices(block, channel, 1, palette, indices) };
+			if (error < bestError) {
+				bestError = error;
+				std::copy_n(values, 2, bestValues);
+				std::copy_n(indices, c_BLOCK_TEXELS, bestIndices);
+			}
+			if (values[0] == values[1]) {
+				break;
+			}
+
+			endpoints.first[0] = values[0];
+			endpoints.second[0] = values[1];
+			refineEndpoints(block, channel, 1, indices, c_WEIGHTS, endpoints);
+		}
+
+		uint64_t codes{};
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			uint64_t code{ bestValues[0] == bestValues[1]
+							   ? 0u
+							   : c_BC4_CODES[bestIndices[texel]] };
+			codes |= code << (texel * 3);
+		}
+		out[0] = bestValues[0];
+		out[1] = bestValues[1];
+		memcpy(out + 2, &codes, 6);
+	}
+
+	void encodeBc7(
+		const BlockTexels& block, const BlockQuality quality, uint8_t* out
+	) {
+		float weights[16]{};
+		for (uint32_t entry{}; entry < 16; entry++) {
+			weights[entry] = c_BC7_WEIGHTS[entry] / 64.0f;
+		}
+
+		Endpoints endpoints{ fitPrincipalAxis(block, 0, 4) };
+		float bestError{ FLT_MAX };
+		Bc7Endpoints best{};
+		uint8_t bestIndices[c_BLOCK_TEXELS]{};
+
+		int32_t pCombinations{ quality == BlockQuality::high ? 4 : 1 };
+		uint32_t refinements{ getRefinementCount(quality) };
+		for (uint32_t pass{}; pass <= refinements; pass++) {
+			uint8_t passIndices[c_BLOCK_TEXELS]{};
+			float passError{ FLT_MAX };
+			for (int32_t p{}; p < pCombinations; p++) {
+				Bc7Endpoints quantized{ quantizeBc7(
+					endpoints,
+					pCombinations == 1 ? -1 : p & 1,
+					pCombinations == 1 ? -1 : p >> 1
+				) };
+
+				Palette palette{ .colors = {}, .size = 16 };
+				for (uint32_t entry{}; entry < 16; entry++) {
+					for (uint32_t i{}; i < 4; i++) {
+						uint32_t first{ quantized.first[i] << 1 |
+										quantized.firstP };
+						uint32_t second{ quantized.second[i] << 1 |
+										 quantized.secondP };
+						palette.colors[entry][i] = (float)((
+							(64 - c_BC7_WEIGHTS[entry]) * first +
+							c_BC7_WEIGHTS[entry] * second + 32
+						) >> 6);
+					}
+				}
+
+				uint8_t indices[c_BLOCK_TEXELS]{};
+				float error{ selectIndices(block, 0, 4, palette, indices) };
+				if (error < passError) {
+					passError = error;
+					std::copy_n(indices, c_BLOCK_TEXELS, passIndices);
+				}
+				if (error < bestError) {
+					bestError = error;
+					best = quantized;
+					std::copy_n(indices, c_BLOCK_TEXELS, bestIndices);
+				}
+			}
+
+			refineEndpoints(block, 0, 4, passIndices, weights, endpoints);
+		}
+
+		// the anchor index is stored without its top bit
+		if (bestIndices[0] >= 8) {
+			std::swap(best.first, best.second);
+			std::swap(best.firstP, best.secondP);
+			for (auto& index : bestIndices) {
+				index = (uint8_t)(15 - index);
+			}
+		}
+
+		BitWriter writer{};
+		writeBits(writer, c_BC7_MODE6, 7);
+		for (uint32_t i{}; i < 4; i++) {
+			writeBits(writer, best.first[i], 7);
+			writeBits(writer, best.second[i], 7);
+		}
+		writeBits(writer, best.firstP, 1);
+		writeBits(writer, best.secondP, 1);
+		writeBits(writer, bestIndices[0], 3);
+		for (uint32_t texel{ 1 }; texel < c_BLOCK_TEXELS; texel++) {
+			writeBits(writer, bestIndices[texel], 4);
+		}
+		memcpy(out, writer.words, 16);
+	}
+
+	uint16_t packRgb565(const float* color) {
+		uint32_t r{ (uint32_t)std::lround(color[0] * 31 / 255.0f) };
+		uint32_t g{ (uint32_t)std::lround(color[1] * 63 / 255.0f) };
+		uint32_t b{ (uint32_t)std::lround(color[2] * 31 / 255.0f) };
+		return (uint16_t)(r << 11 | g << 5 | b);
+	}
+
+	void unpackRgb565(const uint16_t color, float* out) {
+		uint32_t r{ (uint32_t)(color >> 11) & 31 };
+		uint32_t g{ (uint32_t)(color >> 5) & 63 };
+		uint32_t b{ (uint32_t)color & 31 };
+		out[0] = (float)(r << 3 | r >> 2);
+		out[1] = (float)(g << 2 | g >> 4);
+		out[2] = (float)(b << 3 | b >> 2);
+	}
+
+	Bc7Endpoints quantizeBc7(
+		const Endpoints& endpoints, const int32_t firstP, const int32_t secondP
+	) {
+		// 7 bits per channel plus the shared p bit make 8
+		auto quantize{ [](const float* color, const int32_t p, uint32_t* out) {
+			uint32_t bestP{};
+			float bestError{ FLT_MAX };
+			for (uint32_t candidate{}; candidate < 2; candidate++) {
+				if (p >= 0 && candidate != (uint32_t)p) {
+					continue;
+				}
+				float error{};
+				uint32_t values[4]{};
+				for (uint32_t i{}; i < 4; i++) {
+					values[i] = (uint32_t)std::clamp<long>(
+						std::lround((color[i] - candidate) / 2), 0, 127
+					);
+					float delta{
+						(float)(values[i] << 1 | candidate) - color[i]
+					};
+					error += delta * delta;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestP = candidate;
+					std::copy_n(values, 4, out);
+				}
+			}
+			return bestP;
+		} };
+
+		Bc7Endpoints quantized{};
+		quantized.firstP = quantize(endpoints.first, firstP, quantized.first);
+		quantized.secondP =
+			quantize(endpoints.second, secondP, quantized.second);
+
+		return quantized;
+	}
+
+	void writeBits(
+		BitWriter& writer, const uint64_t value, const uint32_t count
+	) {
+		uint32_t word{ writer.offset / 64 };
+		uint32_t shift{ writer.offset % 64 };
+		writer.words[word] |= value << shift;
+		if (shift + count > 64) {
+			writer.words[word + 1] |= value >> (64 - shift);
+		}
+		writer.offset += count;
+	}
+
+	uint32_t
+		readBits(const uint8_t* data, uint32_t& offset, const uint32_t count) {
+		uint32_t value{};
+		for (uint32_t bit{}; bit < count; bit++, offset++) {
+			value |= (uint32_t)(data[offset / 8] >> (offset % 8) & 1) << bit;
+		}
+		return value;
+	}
+
+	void decodeBc1(const uint8_t* data, uint8_t (*texels)[4]) {
+		uint16_t colors[2]{};
+		uint32_t codes{};
+		memcpy(colors, data, 4);
+		memcpy(&codes, data + 4, 4);
+
+		float palette[4][3]{};
+		unpackRgb565(colors[0], palette[0]);
+		unpackRgb565(colors[1], palette[1]);
+		for (uint32_t i{}; i < 3; i++) {
+			if (colors[0] > colors[1]) {
+				palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+				palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+			} else {
+				palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+			}
+		}
+
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			uint32_t code{ codes >> (texel * 2) & 3 };
+			for (uint32_t i{}; i < 3; i++) {
+				texels[texel][i] = (uint8_t)std::lround(palette[code][i]);
+			}
+			texels[texel][3] = 255;
+		}
+	}
+
+	void decodeBc4(
+		const uint8_t* data, const uint32_t channel, uint8_t (*texels)[4]
+	) {
+		uint64_t codes{};
+		memcpy(&codes, data + 2, 6);
+
+		float palette[8]{ (float)data[0], (float)data[1] };
+		for (uint32_t code{ 2 }; code < 8; code++) {
+			if (data[0] > data[1]) {
+				palette[code] =
+					((8 - code) * palette[0] + (code - 1) * palette[1]) / 7;
+			} else if (code < 6) {
+				palette[code] =
+					((6 - code) * palette[0] + (code - 1) * palette[1]) / 5;
+			} else {
+				palette[code] = code == 6 ? 0.0f : 255.0f;
+			}
+		}
+
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			texels[texel][channel] =
+				(uint8_t)std::lround(palette[codes >> (texel * 3) & 7]);
+		}
+	}
+
+	void decodeBc7(const uint8_t* data, uint8_t (*texels)[4]) {
+		uint32_t offset{};
+		if (readBits(data, offset, 7) != c_BC7_MODE6) {
+			memset(texels, 0, c_BLOCK_TEXELS * 4);
+			return;
+		}
+
+		uint32_t endpoints[2][4]{};
+		for (uint32_t i{}; i < 4; i++) {
+			endpoints[0][i] = readBits(data, offset, 7) << 1;
+			endpoints[1][i] = readBits(data, offset, 7) << 1;
+		}
+		uint32_t firstP{ readBits(data, offset, 1) };
+		uint32_t secondP{ readBits(data, offset, 1) };
+		for (uint32_t i{}; i < 4; i++) {
+			endpoints[0][i] |= firstP;
+			endpoints[1][i] |= secondP;
+		}
+
+		for (uint32_t texel{}; texel < c_BLOCK_TEXELS; texel++) {
+			uint32_t index{ readBits(data, offset, texel == 0 ? 3 : 4) };
+			uint32_t weight{ c_BC7_WEIGHTS[index] };
+			for (uint32_t i{}; i < 4; i++) {
+				texels[texel][i] = (uint8_t)(
+					((64 - weight) * endpoints[0][i] +
+					 weight * endpoints[1][i] + 32) >>
+					6
+				);
+			}
+		}
+	}
+}  // namespace
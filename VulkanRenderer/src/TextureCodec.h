@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+// bump when the encoder output changes, cached textures are keyed by it
+constexpr uint32_t c_TEXTURE_CODEC_VERSION{ 1 };
+
+enum class BlockFormat {
+	// opaque rgb, 4 bits per texel
+	bc1,
+	// bc1 rgb with a separate alpha block, 8 bits per texel
+	bc3,
+	// two independent channels for normal maps, 8 bits per texel
+	bc5,
+	// rgba in mode 6 only, 8 bits per texel
+	bc7,
+};
+
+enum class BlockQuality {
+	// endpoints straight from the principal axis
+	fast,
+	// endpoints refined by least squares against the chosen indices
+	normal,
+	// more refinement, bc7 also tries every pair of p bits
+	high,
+};
+
+VkFormat getBlockVkFormat(const BlockFormat format, const bool srgb);
+// bytes per 4x4 block
+uint32_t getBlockBytes(const BlockFormat format);
+size_t getCompressedSize(
+	const BlockFormat format, const uint32_t width, const uint32_t height
+);
+
+// rgba8 texels in rows, edge blocks repeat the last row and column. block
+// rows are split across the thread pool
+std::vector<uint8_t> compressTexture(
+	const std::span<const uint8_t> rgba,
+	const uint32_t width,
+	const uint32_t height,
+	const BlockFormat format,
+	const BlockQuality quality
+);
+// back to rgba8 for measuring the error, bc7 only understands mode 6
+std::vector<uint8_t> decompressTexture(
+	const std::span<const uint8_t> blocks,
+	const uint32_t width,
+	const uint32_t height,
+	const BlockFormat format
+);
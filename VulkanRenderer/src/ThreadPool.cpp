@@ -0,0 +1,439 @@
+#include "ThreadPool.h"
+#include "Logger.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+
+#ifdef PYX_PLATFORM_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+struct ThreadPool::Job {
+	std::function<void(uint32_t)> function;
+	JobCounter* counter;
+	bool background;
+};
+
+namespace {
+	using ThreadPool::Job;
+	using ThreadPool::JobCounter;
+
+	// jobs past this go to the shared queue, a worker only fills its deque
+	// this far when a job fans out without waiting
+	constexpr int64_t c_DEQUE_CAPACITY{ 4096 };
+	// waiting threads look for new jobs this often while the counter's jobs
+	// run elsewhere
+	constexpr std::chrono::microseconds c_WAIT_POLL{ 200 };
+	constexpr uint32_t c_BATCHES_PER_THREAD{ 4 };
+
+	// chase lev deque. the owner pushes and pops at the bottom, thieves
+	// take from the top and only race the owner for the last job
+	class WorkDeque {
+	   public:
+		bool push(Job* job);
+		Job* pop();
+		Job* steal();
+
+	   private:
+		std::atomic<int64_t> m_Top{};
+		std::atomic<int64_t> m_Bottom{};
+		std::array<std::atomic<Job*>, c_DEQUE_CAPACITY> m_Jobs{};
+	};
+
+	struct ThreadPoolState {
+		std::vector<std::thread> workers;
+		std::vector<std::unique_ptr<WorkDeque>> deques;
+
+		// jobs from owners of a full deque
+		std::mutex sharedMutex;
+		std::deque<Job*> sharedJobs;
+		// taken last and only by workers and background jobs that wait, the
+		// thread that called init never runs them in the middle of a frame
+		std::deque<Job*> backgroundJobs;
+
+		// counted before they are pushed, so sleeping workers never miss one
+		std::atomic<uint32_t> queuedJobs;
+		std::atomic<uint32_t> sleepingWorkers;
+		std::mutex sleepMutex;
+		std::condition_variable jobAvailable;
+		bool stopping;
+	};
+
+	ThreadPoolState* s_Pool{ nullptr };
+	// of the deque the thread owns
+	thread_local uint32_t t_ThreadIndex{ UINT32_MAX };
+	thread_local bool t_InBackgroundJob{ false };
+
+	void workerLoop(const uint32_t workerIndex);
+	// nobody in the pool waits on jobs without a counter or from other
+	// threads, and whatever background jobs submit is background too
+	bool isBackground(const JobCounter* counter);
+	void pushJob(Job* job);
+	Job* takeJob(const uint32_t threadIndex, const bool takeBackground);
+	void runJob(Job* job, const uint32_t threadIndex);
+	void pinThread(std::thread& thread, const uint32_t core);
+}  // namespace
+
+void ThreadPool::init(uint32_t workerCount, const bool pinWorkers) {
+	PYX_ENGINE_ASSERT_WARNING(s_Pool == nullptr);
+
+	uint32_t hardwareThreads{ std::max(std::thread::hardware_concurrency(), 1u)
+	};
+	if (workerCount == 0) {
+		workerCount = std::max(hardwareThreads, 2u) - 1;
+	}
+
+	s_Pool = new ThreadPoolState{};
+	// the last deque belongs to this thread
+	s_Pool->deques.reserve(workerCount + 1);
+	for (uint32_t i{}; i <= workerCount; i++) {
+		s_Pool->deques.emplace_back(std::make_unique<WorkDeque>());
+	}
+	t_ThreadIndex = workerCount;
+	// every deque exists before the first worker starts stealing
+	s_Pool->workers.reserve(workerCount);
+	for (uint32_t i{}; i < workerCount; i++) {
+		s_Pool->workers.emplace_back(workerLoop, i);
+		if (pinWorkers) {
+			pinThread(s_Pool->workers.back(), (i + 1) % hardwareThreads);
+		}
+	}
+}
+
+void ThreadPool::shutdown() {
+	PYX_ENGINE_ASSERT_WARNING(s_Pool != nullptr);
+
+	{
+		std::lock_guard<std::mutex> lock(s_Pool->sleepMutex);
+		s_Pool->stopping = true;
+	}
+	s_Pool->jobAvailable.notify_all();
+
+	for (auto& worker : s_Pool->workers) {
+		worker.join();
+	}
+
+	delete s_Pool;
+	s_Pool = nullptr;
+	t_ThreadIndex = UINT32_MAX;
+}
+
+uint32_t ThreadPool::getWorkerCount() {
+	return (uint32_t)s_Pool->workers.size();
+}
+
+uint32_t ThreadPool::getThreadCount() {
+	return getWorkerCount() + 1;
+}
+
+uint32_t ThreadPool::getThreadIndex() {
+	PYX_ENGINE_ASSERT_WARNING(t_ThreadIndex != UINT32_MAX);
+
+	return t_ThreadIndex;
+}
+
+void ThreadPool::submit(
+	std::function<void(uint32_t)> job, JobCounter* counter
+) {
+	if (counter != nullptr) {
+		counter->pending++;
+	}
+	pushJob(new Job{
+		.function = std::move(job),
+		.counter = counter,
+		.background = isBackground(counter),
+	});
+}
+
+void ThreadPool::submitAfter(
+	JobCounter& dependency,
+	std::function<void(uint32_t)> job,
+	JobCounter* counter
+) {
+	if (counter != nullptr) {
+		counter->pending++;
+	}
+	Job* continuation{ new Job{
+		.function = std::move(job),
+		.counter = counter,
+		.background = isBackground(counter),
+	} };
+
+	// the last job of the dependency takes the lock to queue continuations
+	{
+		std::lock_guard<std::mutex> lock(dependency.mutex);
+		if (dependency.pending != 0) {
+			dependency.continuations.emplace_back(continuation);
+			return;
+		}
+	}
+	pushJob(continuation);
+}
+
+void ThreadPool::wait(JobCounter& counter) {
+	// threads outside the pool have no deque or index to run jobs with, they
+	// only block
+	uint32_t threadIndex{ t_ThreadIndex };
+	while (threadIndex != UINT32_MAX && counter.pending != 0) {
+		// a background job may be waiting on background jobs, anyone else
+		// only on deque and shared jobs
+		if (Job* job{ takeJob(threadIndex, t_InBackgroundJob) };
+			job != nullptr) {
+			runJob(job, threadIndex);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(counter.mutex);
+		counter.done.wait_for(lock, c_WAIT_POLL, [&]() {
+			return counter.pending == 0;
+		});
+	}
+
+	// the last job may still hold the lock, the counter can go away once it
+	// let go
+	std::unique_lock<std::mutex> lock(counter.mutex);
+	counter.done.wait(lock, [&]() { return counter.pending == 0; });
+}
+
+void ThreadPool::parallelFor(
+	const uint32_t count, uint32_t batchSize, const BatchFunction& function
+) {
+	if (count == 0) {
+		return;
+	}
+	if (batchSize == 0) {
+		batchSize =
+			std::max(count / (getThreadCount() * c_BATCHES_PER_THREAD), 1u);
+	}
+
+	// the first batch is left to a caller in the pool, others only wait
+	uint32_t threadIndex{ t_ThreadIndex };
+	uint32_t queuedBegin{ threadIndex == UINT32_MAX ? 0 : batchSize };
+	JobCounter counter{};
+	for (uint32_t begin{ queuedBegin }; begin < count; begin += batchSize) {
+		uint32_t end{ std::min(begin + batchSize, count) };
+		submit(
+			[&function, begin, end](uint32_t threadIndex) {
+				function(begin, end, threadIndex);
+			},
+			&counter
+		);
+	}
+
+	if (threadIndex != UINT32_MAX) {
+		function(0, std::min(batchSize, count), threadIndex);
+	}
+	wait(counter);
+}
+
+namespace {
+	bool WorkDeque::push(Job* job) {
+		int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) };
+		int64_t top{ m_Top.load(std::memory_order_acquire) };
+		if (bottom - top >= c_DEQUE_CAPACITY) {
+			return false;
+		}
+
+		m_Jobs[bottom % c_DEQUE_CAPACITY].store(job, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	Job* WorkDeque::pop() {
+		int64_t bottom{ m_Bottom.load(std::memory_order_relaxed) - 1 };
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top{ m_Top.load(std::memory_order_relaxed) };
+
+		if (top > bottom) {
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job{
+			m_Jobs[bottom % c_DEQUE_CAPACITY].load(std::memory_order_relaxed)
+		};
+		if (top == bottom) {
+			// the last job, whoever moves top first gets it
+			if (!m_Top.compare_exchange_strong(
+					top,
+					top + 1,
+					std::memory_order_seq_cst,
+					std::memory_order_relaxed
+				)) {
+				job = nullptr;
+			}
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return job;
+	}
+
+	Job* WorkDeque::steal() {
+		int64_t top{ m_Top.load(std::memory_order_acquire) };
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottom{ m_Bottom.load(std::memory_order_acquire) };
+		if (top >= bottom) {
+			return nullptr;
+		}
+
+		Job* job{
+			m_Jobs[top % c_DEQUE_CAPACITY].load(std::memory_order_relaxed)
+		};
+		if (!m_Top.compare_exchange_strong(
+				top,
+				top + 1,
+				std::memory_order_seq_cst,
+				std::memory_order_relaxed
+			)) {
+			return nullptr;
+		}
+
+		return job;
+	}
+
+	void workerLoop(const uint32_t workerIndex) {
+		t_ThreadIndex = workerIndex;
+		PYX_TRACE_THREAD(("worker " + std::to_string(workerIndex)).c_str());
+
+		while (true) {
+			if (Job* job{ takeJob(workerIndex, true) }; job != nullptr) {
+				runJob(job, workerIndex);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(s_Pool->sleepMutex);
+			s_Pool->sleepingWorkers++;
+			s_Pool->jobAvailable.wait(lock, []() {
+				return s_Pool->stopping || s_Pool->queuedJobs != 0;
+			});
+			s_Pool->sleepingWorkers--;
+
+			// drain remaining jobs before stopping so nobody waits on a job
+			// that never ran
+			if (s_Pool->stopping && s_Pool->queuedJobs == 0) {
+				return;
+			}
+		}
+	}
+
+	bool isBackground(const JobCounter* counter) {
+		return counter == nullptr || t_InBackgroundJob ||
+			t_ThreadIndex == UINT32_MAX;
+	}
+
+	void pushJob(Job* job) {
+		// the job can run and be freed as soon as it is counted
+		bool background{ job->background };
+		s_Pool->queuedJobs++;
+
+		if (background) {
+			std::lock_guard<std::mutex> lock(s_Pool->sharedMutex);
+			s_Pool->backgroundJobs.emplace_back(job);
+		} else if (!s_Pool->deques[t_ThreadIndex]->push(job)) {
+			std::lock_guard<std::mutex> lock(s_Pool->sharedMutex);
+			s_Pool->sharedJobs.emplace_back(job);
+		}
+
+		// pairs with the sleeping count going up before workers check for
+		// jobs, one of the two sides always sees the other
+		if (s_Pool->sleepingWorkers != 0) {
+			std::lock_guard<std::mutex> lock(s_Pool->sleepMutex);
+			s_Pool->jobAvailable.notify_one();
+		}
+	}
+
+	Job* takeJob(const uint32_t threadIndex, const bool takeBackground) {
+		uint32_t dequeCount{ (uint32_t)s_Pool->deques.size() };
+
+		Job* job{ s_Pool->deques[threadIndex]->pop() };
+		if (job == nullptr) {
+			std::lock_guard<std::mutex> lock(s_Pool->sharedMutex);
+			if (!s_Pool->sharedJobs.empty()) {
+				job = s_Pool->sharedJobs.front();
+				s_Pool->sharedJobs.pop_front();
+			}
+		}
+		// starting after our own deque spreads thieves over the victims
+		for (uint32_t i{ 1 }; job == nullptr && i < dequeCount; i++) {
+			job = s_Pool->deques[(threadIndex + i) % dequeCount]->steal();
+		}
+		if (job == nullptr && takeBackground) {
+			std::lock_guard<std::mutex> lock(s_Pool->sharedMutex);
+			if (!s_Pool->backgroundJobs.empty()) {
+				job = s_Pool->backgroundJobs.front();
+				s_Pool->backgroundJobs.pop_front();
+			}
+		}
+
+		if (job != nullptr) {
+			s_Pool->queuedJobs--;
+		}
+
+		return job;
+	}
+
+	void runJob(Job* job, const uint32_t threadIndex) {
+		// restored after, a foreground job can run inside a background wait
+		bool inBackgroundJob{ t_InBackgroundJob };
+		t_InBackgroundJob = job->background;
+		{
+			PYX_TRACE_ZONE("job");
+			job->function(threadIndex);
+		}
+		t_InBackgroundJob = inBackgroundJob;
+		JobCounter* counter{ job->counter };
+		delete job;
+		if (counter == nullptr) {
+			return;
+		}
+
+		// the counter may be gone as soon as the lock is released
+		std::vector<Job*> continuations;
+		{
+			std::lock_guard<std::mutex> lock(counter->mutex);
+			if (--counter->pending == 0) {
+				continuations.swap(counter->continuations);
+				counter->done.notify_all();
+			}
+		}
+		for (Job* continuation : continuations) {
+			pushJob(continuation);
+		}
+	}
+
+	void pinThread(std::thread& thread, const uint32_t core) {
+#ifdef PYX_PLATFORM_WINDOWS
+		bool pinned{ SetThreadAffinityMask(
+						 thread.native_handle(), (DWORD_PTR)1 << core
+					 ) != 0 };
+#elif defined(__linux__)
+		cpu_set_t cpuSet{};
+		CPU_ZERO(&cpuSet);
+		CPU_SET(core, &cpuSet);
+		bool pinned{ pthread_setaffinity_np(
+						 thread.native_handle(), sizeof(cpuSet), &cpuSet
+					 ) == 0 };
+#else
+		bool pinned{ false };
+#endif
+		if (!pinned) {
+			PYX_ENGINE_WARNING(
+				"[ThreadPool] could not pin a worker to core {0}", core
+			);
+		}
+	}
+}  // namespace
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// work stealing pool. every worker owns a deque it pushes to and pops from,
+// idle workers steal from the other end of everyone else's. the thread that
+// called init owns a deque too. on the pool's threads waiting on a counter
+// runs queued jobs instead of blocking, so jobs can wait on the jobs they
+// submit. other threads block. jobs without a counter, jobs from other
+// threads and everything those submit are background work, queued apart and
+// picked up by idle workers, never by the thread that called init.
+namespace ThreadPool {
+	struct Job;
+
+	// counts the unfinished jobs submitted with it, jobs submitted after it
+	// are queued once it reaches zero. only touched by the pool, it has to
+	// outlive every job and wait using it
+	struct JobCounter {
+		std::atomic<uint32_t> pending;
+
+		std::mutex mutex;
+		std::condition_variable done;
+		std::vector<Job*> continuations;
+	};
+
+	// 0 picks one worker per hardware thread, minus the main thread. pinned
+	// workers are bound to a core each, the first core is left to the main
+	// thread
+	void init(uint32_t workerCount, const bool pinWorkers = false);
+	void shutdown();
+
+	uint32_t getWorkerCount();
+	// the workers and the thread that called init, which runs jobs while it
+	// waits. for sizing per thread storage indexed by the job argument
+	uint32_t getThreadCount();
+	// the worker index on workers, getWorkerCount() on the thread that called
+	// init
+	uint32_t getThreadIndex();
+
+	// the job receives the index of the thread running it
+	void submit(
+		std::function<void(uint32_t)> job, JobCounter* counter = nullptr
+	);
+	// queued once dependency reaches zero, right away if it already has
+	void submitAfter(
+		JobCounter& dependency,
+		std::function<void(uint32_t)> job,
+		JobCounter* counter = nullptr
+	);
+	// runs queued jobs until counter reaches zero, safe to call from jobs.
+	// threads outside the pool block instead
+	void wait(JobCounter& counter);
+
+	using BatchFunction =
+		std::function<void(uint32_t begin, uint32_t end, uint32_t threadIndex)>;
+	// splits [0, count) into batches of batchSize, 0 picks a few batches per
+	// thread. a caller in the pool runs batches too, every caller returns
+	// once all are done
+	void parallelFor(
+		const uint32_t count, uint32_t batchSize, const BatchFunction& function
+	);
+}  // namespace ThreadPool
@@ -0,0 +1,283 @@
+#include "Trace.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64)
+	#include <intrin.h>
+#elif defined(__x86_64__)
+	#include <x86intrin.h>
+#endif
+
+namespace {
+	// about 384 KiB each, the first is allocated with the thread's trace
+	constexpr uint32_t c_EVENTS_PER_CHUNK{ 1 << 14 };
+	// 24 MiB of events per thread and capture at most
+	constexpr uint32_t c_CHUNKS_PER_THREAD{ 64 };
+
+	// raw timestamps, converted when the capture is written
+	struct TraceEvent {
+		const char* name;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	using TraceChunk = std::array<TraceEvent, c_EVENTS_PER_CHUNK>;
+
+	struct ThreadTrace {
+		// kept for later captures. a chunk is allocated before the count
+		// covering it is published
+		std::array<std::unique_ptr<TraceChunk>, c_CHUNKS_PER_THREAD> chunks;
+		// capture generation in the upper and zones recorded in it in the
+		// lower half. the owner stores it after every zone, which is the
+		// only store a reading capture waits on
+		std::atomic<uint64_t> published;
+
+		// the owning thread's, events go to chunks[count / c_EVENTS_PER_CHUNK]
+		// and zones past the last chunk are only counted
+		uint32_t generation;
+		uint32_t count;
+		TraceEvent* next;
+		TraceEvent* chunkEnd;
+
+		// the rest belongs to the registry mutex
+		uint32_t id;
+		std::string name;
+	};
+
+	struct TraceState {
+		std::mutex mutex;
+		// never freed, threads can exit before their events are written
+		std::vector<std::unique_ptr<ThreadTrace>> threads;
+		// of the last capture begun, 0 is never used
+		uint32_t generation;
+		uint64_t captureBegin;
+		std::chrono::steady_clock::time_point captureBeginTime;
+	};
+
+	// the running capture's generation, 0 while not capturing
+	std::atomic<uint32_t> s_Generation{};
+	TraceState s_Trace{};
+	thread_local ThreadTrace* t_Thread{ nullptr };
+
+	// tsc ticks where available, calibrated against steady_clock per capture
+	uint64_t getTimestamp();
+	ThreadTrace& getThreadTrace();
+	// false once the thread used up its chunks
+	bool openChunk(ThreadTrace& thread);
+	// names are string literals, only quotes and backslashes need escaping
+	void writeEscaped(std::ofstream& out, const char* string);
+}  // namespace
+
+void Trace::beginCapture() {
+	std::lock_guard<std::mutex> lock(s_Trace.mutex);
+	s_Trace.generation++;
+	s_Trace.captureBegin = getTimestamp();
+	s_Trace.captureBeginTime = std::chrono::steady_clock::now();
+
+	s_Generation.store(s_Trace.generation, std::memory_order_release);
+}
+
+bool Trace::endCapture(const std::filesystem::path& path) {
+	s_Generation.store(0, std::memory_order_release);
+
+	std::lock_guard<std::mutex> lock(s_Trace.mutex);
+	uint64_t captureEnd{ getTimestamp() };
+	std::chrono::duration<double, std::micro> captureTime{
+		std::chrono::steady_clock::now() - s_Trace.captureBeginTime
+	};
+	double captureMicroseconds{ captureTime.count() };
+	double ticksPerMicrosecond{
+		(double)(captureEnd - s_Trace.captureBegin) /
+		std::max(captureMicroseconds, 1.)
+	};
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out.is_open()) {
+		PYX_ENGINE_ERROR("[Trace] could not open {0}", path.string());
+		return false;
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	bool first{ true };
+	size_t eventCount{};
+	size_t droppedCount{};
+	for (const auto& thread : s_Trace.threads) {
+		if (!thread->name.empty()) {
+			out << (first ? "\n" : ",\n")
+				<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+				<< thread->id << ",\"args\":{\"name\":\"";
+			writeEscaped(out, thread->name.c_str());
+			out << "\"}}";
+			first = false;
+		}
+
+		// events below the published count are never written again
+		uint64_t published{ thread->published.load(std::memory_order_acquire
+		) };
+		if (published >> 32 != s_Trace.generation) {
+			continue;
+		}
+		uint32_t count{ (uint32_t)published };
+		uint32_t recorded{
+			std::min(count, c_EVENTS_PER_CHUNK * c_CHUNKS_PER_THREAD)
+		};
+		droppedCount += count - recorded;
+		for (uint32_t i{}; i < recorded; i++) {
+			const TraceChunk& chunk{ *thread->chunks[i / c_EVENTS_PER_CHUNK] };
+			const TraceEvent& event{ chunk[i % c_EVENTS_PER_CHUNK] };
+			// timestamps of different cores can be a few ticks apart
+			uint64_t eventBegin{ std::max(event.begin, s_Trace.captureBegin) };
+			uint64_t eventEnd{ std::max(event.end, eventBegin) };
+
+			out << (first ? "\n" : ",\n") << "{\"name\":\"";
+			writeEscaped(out, event.name);
+			out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+				<< ",\"ts\":"
+				<< (double)(eventBegin - s_Trace.captureBegin) /
+					ticksPerMicrosecond
+				<< ",\"dur\":"
+				<< (double)(eventEnd - eventBegin) / ticksPerMicrosecond
+				<< "}";
+			first = false;
+			eventCount++;
+		}
+	}
+	out << "\n]}\n";
+
+	if (!out.good()) {
+		PYX_ENGINE_ERROR("[Trace] could not write {0}", path.string());
+		return false;
+	}
+	PYX_ENGINE_INFO(
+		"[Trace] wrote {0} events of {1} threads to {2}",
+		eventCount,
+		s_Trace.threads.size(),
+		path.string()
+	);
+	if (droppedCount > 0) {
+		PYX_ENGINE_WARNING(
+			"[Trace] dropped {0} zones of threads that filled their chunks",
+			droppedCount
+		);
+	}
+
+	return true;
+}
+
+bool Trace::isCapturing() {
+	return s_Generation.load(std::memory_order_relaxed) != 0;
+}
+
+void Trace::setThreadName(const char* name) {
+	ThreadTrace& thread{ getThreadTrace() };
+
+	std::lock_guard<std::mutex> lock(s_Trace.mutex);
+	thread.name = name;
+}
+
+Trace::Zone::Zone(const char* name)
+	: m_Name{ nullptr }
+	, m_Begin{}
+	, m_Generation{} {
+	// acquire so the chunks are only written again after the last capture
+	// was read
+	uint32_t generation{ s_Generation.load(std::memory_order_acquire) };
+	if (generation == 0) {
+		return;
+	}
+
+	m_Name = name;
+	m_Generation = generation;
+	m_Begin = getTimestamp();
+}
+
+Trace::Zone::~Zone() {
+	if (m_Name == nullptr) {
+		return;
+	}
+	uint64_t end{ getTimestamp() };
+
+	ThreadTrace& thread{ getThreadTrace() };
+	if (m_Generation != thread.generation) {
+		// began in a capture this thread has already recorded past
+		if (m_Generation < thread.generation) {
+			return;
+		}
+		thread.generation = m_Generation;
+		thread.count = 0;
+		thread.next = nullptr;
+		thread.chunkEnd = nullptr;
+	}
+
+	if (thread.next != thread.chunkEnd || openChunk(thread)) {
+		*thread.next++ = TraceEvent{ m_Name, m_Begin, end };
+	}
+	thread.count++;
+	thread.published.store(
+		(uint64_t)thread.generation << 32 | thread.count,
+		std::memory_order_release
+	);
+}
+
+namespace {
+	uint64_t getTimestamp() {
+#if defined(_M_X64) || defined(__x86_64__)
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::steady_clock::now()
+			.time_since_epoch()
+			.count();
+#endif
+	}
+
+	ThreadTrace& getThreadTrace() {
+		if (t_Thread != nullptr) {
+			return *t_Thread;
+		}
+
+		// the first chunk up front, the zeroing faults its pages in before
+		// the thread records into it
+		std::unique_ptr<ThreadTrace> thread{ std::make_unique<ThreadTrace>() };
+		thread->chunks[0] = std::make_unique<TraceChunk>();
+		std::lock_guard<std::mutex> lock(s_Trace.mutex);
+		thread->id = (uint32_t)s_Trace.threads.size() + 1;
+		t_Thread = s_Trace.threads.emplace_back(std::move(thread)).get();
+
+		return *t_Thread;
+	}
+
+	bool openChunk(ThreadTrace& thread) {
+		uint32_t chunk{ thread.count / c_EVENTS_PER_CHUNK };
+		if (chunk >= c_CHUNKS_PER_THREAD) {
+			return false;
+		}
+
+		if (thread.chunks[chunk] == nullptr) {
+			thread.chunks[chunk] = std::make_unique<TraceChunk>();
+		}
+		thread.next = thread.chunks[chunk]->data();
+		thread.chunkEnd = thread.next + c_EVENTS_PER_CHUNK;
+
+		return true;
+	}
+
+	void writeEscaped(std::ofstream& out, const char* string) {
+		for (const char* c{ string }; *c != '\0'; c++) {
+			if (*c == '"' || *c == '\\') {
+				out << '\\';
+			}
+			out << *c;
+		}
+	}
+}  // namespace
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <filesystem>
+
+// cpu trace zones, captured to chrome trace event json that opens in
+// chrome://tracing and ui.perfetto.dev. every thread records raw timestamps
+// into preallocated chunks of its own, so a zone takes no locks and no read
+// modify writes, only two timestamps and the stores of the event. ticks are
+// converted when the capture is written. the macros compile out without
+// INTERNAL_BUILD, and Release links the stub, which never records
+namespace Trace {
+	// zones are recorded from now on, a running capture starts over
+	void beginCapture();
+	// stops recording and writes the capture. threads that ran out of chunks
+	// keep their first events
+	bool endCapture(const std::filesystem::path& path);
+	bool isCapturing();
+
+	// shown in place of the thread id, copied
+	void setThreadName(const char* name);
+
+	// name has to outlive the capture, string literals and __func__ do
+	class Zone {
+	   public:
+		explicit Zone(const char* name);
+		~Zone();
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	   private:
+		// null when no capture was running at construction
+		const char* m_Name;
+		uint64_t m_Begin;
+		uint32_t m_Generation;
+	};
+}  // namespace Trace
+
+#define PYX_TRACE_CONCAT_INNER(a, b) a##b
+#define PYX_TRACE_CONCAT(a, b) PYX_TRACE_CONCAT_INNER(a, b)
+
+#ifdef INTERNAL_BUILD
+	#define PYX_TRACE_ZONE(name) \
+		Trace::Zone PYX_TRACE_CONCAT(traceZone, __LINE__) { name }
+	#define PYX_TRACE_FUNCTION() PYX_TRACE_ZONE(__func__)
+	#define PYX_TRACE_THREAD(name) Trace::setThreadName(name)
+#else
+	#define PYX_TRACE_ZONE(name)
+	#define PYX_TRACE_FUNCTION()
+	#define PYX_TRACE_THREAD(name)
+#endif
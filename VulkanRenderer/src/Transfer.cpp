@@ -0,0 +1,330 @@
+#include "Transfer.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <vulkan/vulkan_core.h>
+
+namespace {
+	VkCommandBuffer acquireCommandBuffer(TransferEngine& engine);
+	void recycleCommandBuffers(TransferEngine& engine);
+
+	void recordCopies(
+		const VkCommandBuffer cmdBuffer,
+		std::vector<PendingBufferCopy>& copies
+	);
+	std::vector<VkBufferMemoryBarrier2> getOwnershipBarriers(
+		const TransferEngine& engine,
+		const std::vector<PendingBufferCopy>& copies,
+		const bool release
+	);
+}  // namespace
+
+TransferEngine createTransferEngine(
+	const VkDevice device,
+	const uint32_t queueFamily,
+	const VkQueue queue,
+	const uint32_t dstQueueFamily
+) {
+	VkCommandPoolCreateInfo cmdPoolCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+			VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+		.queueFamilyIndex = queueFamily,
+	};
+
+	VkCommandPool cmdPool{};
+	VK_CHECK(vkCreateCommandPool(device, &cmdPoolCreateInfo, nullptr, &cmdPool)
+	);
+
+	VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0,
+	};
+	VkSemaphoreCreateInfo semaphoreCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &semaphoreTypeCreateInfo,
+	};
+
+	VkSemaphore timeline{};
+	VK_CHECK(
+		vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &timeline)
+	);
+
+	TransferEngine engine{
+		.device = device,
+		.queue = queue,
+		.queueFamily = queueFamily,
+		.dstQueueFamily = dstQueueFamily,
+		.cmdPool = cmdPool,
+		.timeline = timeline,
+	};
+
+	return engine;
+}
+
+void destroyTransferEngine(const TransferEngine& engine) {
+	vkDestroySemaphore(engine.device, engine.timeline, nullptr);
+	vkDestroyCommandPool(engine.device, engine.cmdPool, nullptr);
+}
+
+void enqueueBufferCopy(
+	TransferEngine& engine,
+	const VkBuffer srcBuffer,
+	const VkBuffer dstBuffer,
+	const VkBufferCopy& region,
+	const VkPipelineStageFlags2 dstStageMask,
+	const VkAccessFlags2 dstAccessMask
+) {
+	engine.pendingCopies.emplace_back(PendingBufferCopy{
+		.srcBuffer = srcBuffer,
+		.dstBuffer = dstBuffer,
+		.region = region,
+		.dstStageMask = dstStageMask,
+		.dstAccessMask = dstAccessMask,
+	});
+}
+
+TransferTicket submitTransfers(TransferEngine& engine) {
+	if (engine.pendingCopies.empty()) {
+		return TransferTicket{ .value = engine.submittedValue };
+	}
+
+	recycleCommandBuffers(engine);
+
+	VkCommandBuffer cmdBuffer{ acquireCommandBuffer(engine) };
+
+	VkCommandBufferBeginInfo beginInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+
+	recordCopies(cmdBuffer, engine.pendingCopies);
+
+	for (const auto& copy : engine.pendingCopies) {
+		engine.pendingWaitStageMask |= copy.dstStageMask;
+	}
+
+	if (engine.queueFamily != engine.dstQueueFamily) {
+		std::vector<VkBufferMemoryBarrier2> releases{
+			getOwnershipBarriers(engine, engine.pendingCopies, true)
+		};
+		std::vector<VkBufferMemoryBarrier2> acquires{
+			getOwnershipBarriers(engine, engine.pendingCopies, false)
+		};
+
+		VkDependencyInfo dependencyInfo{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount = (uint32_t)releases.size(),
+			.pBufferMemoryBarriers = releases.data(),
+		};
+		vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+
+		engine.pendingAcquires.insert(
+			engine.pendingAcquires.end(), acquires.begin(), acquires.end()
+		);
+	}
+
+	vkEndCommandBuffer(cmdBuffer);
+
+	uint64_t signalValue{ engine.submittedValue + 1 };
+
+	VkCommandBufferSubmitInfo cmdBufferSubmitInfo{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+		.commandBuffer = cmdBuffer,
+	};
+	VkSemaphoreSubmitInfo signalInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore = engine.timeline,
+		.value = signalValue,
+		.stageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+	};
+	VkSubmitInfo2 submitInfo{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		.commandBufferInfoCount = 1,
+		.pCommandBufferInfos = &cmdBufferSubmitInfo,
+		.signalSemaphoreInfoCount = 1,
+		.pSignalSemaphoreInfos = &signalInfo,
+	};
+	VkResult res{ vkQueueSubmit2(engine.queue, 1, &submitInfo, 0) };
+	if (res != VK_SUCCESS) {
+		PYX_ENGINE_ERROR("could not submit transfers: {0}", (int)res);
+	}
+
+	engine.submittedValue = signalValue;
+	engine.pendingWaitValue = signalValue;
+	engine.pendingCopies.clear();
+	engine.inFlight.emplace_back(
+		InFlightTransfer{ .value = signalValue, .cmdBuffer = cmdBuffer }
+	);
+
+	return TransferTicket{ .value = signalValue };
+}
+
+bool isTransferComplete(
+	const TransferEngine& engine, const TransferTicket ticket
+) {
+	uint64_t completedValue{};
+	vkGetSemaphoreCounterValue(
+		engine.device, engine.timeline, &completedValue
+	);
+
+	return completedValue >= ticket.value;
+}
+
+bool isTransferIdle(const TransferEngine& engine) {
+	return engine.pendingCopies.empty() && engine.pendingAcquires.empty() &&
+		isTransferComplete(
+			engine, TransferTicket{ .value = engine.submittedValue }
+		);
+}
+
+void waitForTransfer(const TransferEngine& engine, const TransferTicket ticket) {
+	VkSemaphoreWaitInfo waitInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &engine.timeline,
+		.pValues = &ticket.value,
+	};
+	VK_CHECK(vkWaitSemaphores(engine.device, &waitInfo, UINT64_MAX));
+}
+
+std::optional<VkSemaphoreSubmitInfo> recordTransferAcquires(
+	TransferEngine& engine, const VkCommandBuffer cmdBuffer
+) {
+	if (engine.pendingWaitValue == 0) {
+		return {};
+	}
+
+	if (!engine.pendingAcquires.empty()) {
+		VkDependencyInfo dependencyInfo{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount =
+				(uint32_t)engine.pendingAcquires.size(),
+			.pBufferMemoryBarriers = engine.pendingAcquires.data(),
+		};
+		vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+	}
+
+	VkSemaphoreSubmitInfo waitInfo{
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+		.semaphore = engine.timeline,
+		.value = engine.pendingWaitValue,
+		.stageMask = engine.pendingWaitStageMask != 0
+			? engine.pendingWaitStageMask
+			: VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+	};
+
+	engine.pendingAcquires.clear();
+	engine.pendingWaitValue = 0;
+	engine.pendingWaitStageMask = 0;
+
+	return waitInfo;
+}
+
+namespace {
+	VkCommandBuffer acquireCommandBuffer(TransferEngine& engine) {
+		if (!engine.freeCmdBuffers.empty()) {
+			VkCommandBuffer cmdBuffer{ engine.freeCmdBuffers.back() };
+			engine.freeCmdBuffers.pop_back();
+			vkResetCommandBuffer(cmdBuffer, 0);
+
+			return cmdBuffer;
+		}
+
+		VkCommandBufferAllocateInfo cmdBufferAllocInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.commandPool = engine.cmdPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+		VkCommandBuffer cmdBuffer{};
+		VK_CHECK(vkAllocateCommandBuffers(
+			engine.device, &cmdBufferAllocInfo, &cmdBuffer
+		));
+
+		return cmdBuffer;
+	}
+
+	void recycleCommandBuffers(TransferEngine& engine) {
+		uint64_t completedValue{};
+		vkGetSemaphoreCounterValue(
+			engine.device, engine.timeline, &completedValue
+		);
+
+		std::erase_if(engine.inFlight, [&](const InFlightTransfer& transfer) {
+			if (transfer.value > completedValue) {
+				return false;
+			}
+			engine.freeCmdBuffers.emplace_back(transfer.cmdBuffer);
+			return true;
+		});
+	}
+
+	void recordCopies(
+		const VkCommandBuffer cmdBuffer,
+		std::vector<PendingBufferCopy>& copies
+	) {
+		std::ranges::stable_sort(
+			copies,
+			[](const PendingBufferCopy& a, const PendingBufferCopy& b) {
+				if (a.srcBuffer != b.srcBuffer) {
+					return a.srcBuffer < b.srcBuffer;
+				}
+				return a.dstBuffer < b.dstBuffer;
+			}
+		);
+
+		// one vkCmdCopyBuffer per src/dst pair with all of its regions
+		std::vector<VkBufferCopy> regions;
+		for (size_t i{}; i < copies.size();) {
+			const PendingBufferCopy& first{ copies[i] };
+
+			regions.clear();
+			for (; i < copies.size() && copies[i].srcBuffer == first.srcBuffer &&
+				 copies[i].dstBuffer == first.dstBuffer;
+				 i++) {
+				regions.emplace_back(copies[i].region);
+			}
+
+			vkCmdCopyBuffer(
+				cmdBuffer,
+				first.srcBuffer,
+				first.dstBuffer,
+				(uint32_t)regions.size(),
+				regions.data()
+			);
+		}
+	}
+
+	std::vector<VkBufferMemoryBarrier2> getOwnershipBarriers(
+		const TransferEngine& engine,
+		const std::vector<PendingBufferCopy>& copies,
+		const bool release
+	) {
+		std::vector<VkBufferMemoryBarrier2> barriers;
+		barriers.reserve(copies.size());
+
+		for (const auto& copy : copies) {
+			VkBufferMemoryBarrier2 barrier{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcQueueFamilyIndex = engine.queueFamily,
+				.dstQueueFamilyIndex = engine.dstQueueFamily,
+				.buffer = copy.dstBuffer,
+				.offset = copy.region.dstOffset,
+				.size = copy.region.size,
+			};
+			if (release) {
+				barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+				barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+			} else {
+				barrier.dstStageMask = copy.dstStageMask;
+				barrier.dstAccessMask = copy.dstAccessMask;
+			}
+			barriers.emplace_back(barrier);
+		}
+
+		return barriers;
+	}
+}  // namespace
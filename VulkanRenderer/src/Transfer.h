@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+struct TransferTicket {
+	uint64_t value;
+};
+
+struct PendingBufferCopy {
+	VkBuffer srcBuffer;
+	VkBuffer dstBuffer;
+	VkBufferCopy region;
+	VkPipelineStageFlags2 dstStageMask;
+	VkAccessFlags2 dstAccessMask;
+};
+
+struct InFlightTransfer {
+	uint64_t value;
+	VkCommandBuffer cmdBuffer;
+};
+
+// copies are batched until submitTransfers and executed on the transfer
+// queue. each submit signals the timeline semaphore with the value in its
+// ticket. when the transfer family differs from the destination family the
+// written ranges are released by the transfer queue and have to be acquired
+// by the destination queue through recordTransferAcquires.
+struct TransferEngine {
+	VkDevice device;
+	VkQueue queue;
+	uint32_t queueFamily;
+	uint32_t dstQueueFamily;
+
+	VkCommandPool cmdPool;
+	VkSemaphore timeline;
+	uint64_t submittedValue;
+
+	std::vector<PendingBufferCopy> pendingCopies;
+	std::vector<VkBufferMemoryBarrier2> pendingAcquires;
+	uint64_t pendingWaitValue;
+	VkPipelineStageFlags2 pendingWaitStageMask;
+
+	std::vector<InFlightTransfer> inFlight;
+	std::vector<VkCommandBuffer> freeCmdBuffers;
+};
+
+TransferEngine createTransferEngine(
+	const VkDevice device,
+	const uint32_t queueFamily,
+	const VkQueue queue,
+	const uint32_t dstQueueFamily
+);
+void destroyTransferEngine(const TransferEngine& engine);
+
+void enqueueBufferCopy(
+	TransferEngine& engine,
+	const VkBuffer srcBuffer,
+	const VkBuffer dstBuffer,
+	const VkBufferCopy& region,
+	const VkPipelineStageFlags2 dstStageMask,
+	const VkAccessFlags2 dstAccessMask
+);
+
+// returns the ticket of the last submit if nothing was pending
+TransferTicket submitTransfers(TransferEngine& engine);
+
+bool isTransferComplete(
+	const TransferEngine& engine, const TransferTicket ticket
+);
+void waitForTransfer(const TransferEngine& engine, const TransferTicket ticket);
+// nothing pending, in flight or waiting to be acquired
+bool isTransferIdle(const TransferEngine& engine);
+
+// records the acquire half of every ownership transfer submitted so far.
+// the returned wait has to be part of the submit that executes cmdBuffer.
+std::optional<VkSemaphoreSubmitInfo> recordTransferAcquires(
+	TransferEngine& engine, const VkCommandBuffer cmdBuffer
+);
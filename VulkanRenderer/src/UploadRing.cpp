@@ -0,0 +1,133 @@
+#include "UploadRing.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vulkan/vulkan_core.h>
+
+namespace {
+	VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment);
+}  // namespace
+
+UploadRing createUploadRing(
+	const VkPhysicalDevice pDevice,
+	const VmaAllocator allocator,
+	const VkDeviceSize regionSize,
+	const uint32_t regionCount
+) {
+	VkPhysicalDeviceProperties props{};
+	vkGetPhysicalDeviceProperties(pDevice, &props);
+
+	VkDeviceSize minAlignment{ std::max({
+		props.limits.minUniformBufferOffsetAlignment,
+		props.limits.minStorageBufferOffsetAlignment,
+		props.limits.nonCoherentAtomSize,
+		(VkDeviceSize)16,
+	}) };
+	VkDeviceSize alignedRegionSize{ alignUp(regionSize, minAlignment) };
+
+	MappedBufferInfo mappedBuffer{ createMappedBuffer(
+		allocator,
+		alignedRegionSize * regionCount,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT |
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+	) };
+
+	bool deviceLocal{
+		(mappedBuffer.memProps & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0
+	};
+	PYX_ENGINE_INFO(
+		"[UploadRing] {0} x {1} bytes in {2} memory",
+		regionCount,
+		alignedRegionSize,
+		deviceLocal ? "device local" : "host"
+	);
+
+	UploadRing ring{
+		.mappedBuffer = mappedBuffer,
+		.regionSize = alignedRegionSize,
+		.regionCount = regionCount,
+		.minAlignment = minAlignment,
+		.deviceLocal = deviceLocal,
+	};
+
+	return ring;
+}
+
+void destroyUploadRing(const VmaAllocator allocator, const UploadRing& ring) {
+	destroyBuffer(allocator, ring.mappedBuffer.buffer);
+}
+
+void beginUploadRegion(UploadRing& ring, const uint32_t regionIndex) {
+	PYX_ENGINE_ASSERT_WARNING(regionIndex < ring.regionCount);
+
+	ring.regionIndex = regionIndex;
+	ring.head = 0;
+}
+
+std::optional<UploadAllocation> allocateUpload(
+	UploadRing& ring, const VkDeviceSize size, const VkDeviceSize alignment
+) {
+	VkDeviceSize offset{
+		alignUp(ring.head, std::max(alignment, ring.minAlignment))
+	};
+	if (offset + size > ring.regionSize) {
+		PYX_ENGINE_WARNING(
+			"[UploadRing] region out of space: {0} bytes requested, {1} "
+			"free",
+			size,
+			ring.regionSize - std::min(ring.regionSize, offset)
+		);
+		return {};
+	}
+	ring.head = offset + size;
+
+	VkDeviceSize bufferOffset{ ring.regionIndex * ring.regionSize + offset };
+	UploadAllocation allocation{
+		.buffer = ring.mappedBuffer.buffer.handle,
+		.offset = bufferOffset,
+		.data = (uint8_t*)ring.mappedBuffer.data + bufferOffset,
+	};
+
+	return allocation;
+}
+
+std::optional<UploadAllocation> writeUpload(
+	UploadRing& ring,
+	const void* data,
+	const VkDeviceSize size,
+	const VkDeviceSize alignment
+) {
+	std::optional<UploadAllocation> allocation{
+		allocateUpload(ring, size, alignment)
+	};
+	if (allocation.has_value()) {
+		memcpy(allocation->data, data, size);
+	}
+
+	return allocation;
+}
+
+void flushUploadRegion(const VmaAllocator allocator, const UploadRing& ring) {
+	if (ring.head == 0 ||
+		(ring.mappedBuffer.memProps & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+		return;
+	}
+
+	vmaFlushAllocation(
+		allocator,
+		ring.mappedBuffer.buffer.allocation,
+		ring.regionIndex * ring.regionSize,
+		alignUp(ring.head, ring.minAlignment)
+	);
+}
+
+namespace {
+	VkDeviceSize alignUp(const VkDeviceSize value, const VkDeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}  // namespace
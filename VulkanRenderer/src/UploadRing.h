@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+#include <optional>
+#include <vulkan/vulkan.h>
+
+#include "Memory.h"
+
+// persistently mapped ring split into one region per frame in flight. a
+// region is only reused after the fence of the frame that last used it has
+// signalled, so allocations are a bump of the region head and never touch
+// vkAllocateMemory or vkMapMemory.
+struct UploadRing {
+	MappedBufferInfo mappedBuffer;
+
+	VkDeviceSize regionSize;
+	uint32_t regionCount;
+	VkDeviceSize minAlignment;
+
+	uint32_t regionIndex;
+	VkDeviceSize head;
+
+	// the gpu can read allocations in place without a staging copy
+	bool deviceLocal;
+};
+
+struct UploadAllocation {
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	void* data;
+};
+
+UploadRing createUploadRing(
+	const VkPhysicalDevice pDevice,
+	const VmaAllocator allocator,
+	const VkDeviceSize regionSize,
+	const uint32_t regionCount
+);
+void destroyUploadRing(const VmaAllocator allocator, const UploadRing& ring);
+
+// the fence guarding regionIndex must have been waited on
+void beginUploadRegion(UploadRing& ring, const uint32_t regionIndex);
+
+std::optional<UploadAllocation> allocateUpload(
+	UploadRing& ring, const VkDeviceSize size, const VkDeviceSize alignment
+);
+
+std::optional<UploadAllocation> writeUpload(
+	UploadRing& ring,
+	const void* data,
+	const VkDeviceSize size,
+	const VkDeviceSize alignment
+);
+
+// no-op on host coherent memory
+void flushUploadRegion(const VmaAllocator allocator, const UploadRing& ring);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include "PipelineManager.h"
+
+// authoring format, what importers produce
+struct Vertex {
+	glm::vec3 pos;
+	glm::vec3 color;
+};
+
+// what the gpu reads. positions are unorm within the mesh bounds and
+// dequantized with the mesh's VertexQuantization, pos[3] is padding
+struct PackedVertex {
+	uint16_t pos[4];
+	uint8_t color[4];
+};
+
+struct VertexQuantization {
+	glm::vec3 scale;
+	glm::vec3 offset;
+};
+
+// PackedVertex for pipelines that use fixed vertex input instead of pulling
+inline constexpr VertexLayout c_PACKED_VERTEX_LAYOUT{
+	.stride = sizeof(PackedVertex),
+	.attributeCount = 2,
+	.attributes = {
+		{ .location = 0,
+		  .format = VK_FORMAT_R16G16B16A16_UNORM,
+		  .offset = offsetof(PackedVertex, pos) },
+		{ .location = 1,
+		  .format = VK_FORMAT_R8G8B8A8_UNORM,
+		  .offset = offsetof(PackedVertex, color) },
+	},
+};
+
+// push constants of the vertex pulling shaders, scalar layout
+struct VertexPullConstants {
+	VkDeviceAddress vertices;
+	// 0 when indices come from a bound index buffer
+	VkDeviceAddress indices;
+	uint32_t vertexOffset;
+	glm::vec3 positionScale;
+	glm::vec3 positionOffset;
+};
@@ -0,0 +1,42 @@
+#version 460
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_scalar_block_layout : require
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+// vertices are fetched through device addresses instead of vertex input
+// state, so one pipeline draws from any buffer the addresses point into
+
+// PackedVertex in Vertex.h: 4 x unorm16 position, 4 x unorm8 color
+layout (buffer_reference, scalar) readonly buffer Vertices {
+	uvec3 vertices[];
+};
+
+layout (buffer_reference, scalar) readonly buffer Indices {
+	uint indices[];
+};
+
+// matches VertexPullConstants in Vertex.h
+layout (push_constant, scalar) uniform Constants {
+	uint64_t vertices;
+	// 0 for draws that index through a bound index buffer, which keeps the
+	// post transform vertex cache working
+	uint64_t indices;
+	uint vertexOffset;
+	vec3 positionScale;
+	vec3 positionOffset;
+} pc;
+
+layout (location = 0) out vec3 outColor;
+
+void main() {
+	uint index = gl_VertexIndex;
+	if (pc.indices != 0) {
+		index = Indices(pc.indices).indices[gl_VertexIndex] + pc.vertexOffset;
+	}
+
+	uvec3 packed = Vertices(pc.vertices).vertices[index];
+	vec3 pos = vec3(unpackUnorm2x16(packed.x), unpackUnorm2x16(packed.y).x);
+
+	gl_Position = vec4(pos * pc.positionScale + pc.positionOffset, 1.0);
+	outColor = unpackUnorm4x8(packed.z).rgb;
+}
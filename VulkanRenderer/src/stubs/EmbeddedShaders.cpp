@@ -0,0 +1,5 @@
+#include "../EmbeddedShaders.h"
+
+std::span<const uint32_t> findEmbeddedShader(const std::string_view name) {
+	return {};
+}
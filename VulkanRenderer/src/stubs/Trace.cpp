@@ -0,0 +1,20 @@
+#include "../Trace.h"
+
+void Trace::beginCapture() {}
+
+bool Trace::endCapture(const std::filesystem::path& path) {
+	return false;
+}
+
+bool Trace::isCapturing() {
+	return false;
+}
+
+void Trace::setThreadName(const char* name) {}
+
+Trace::Zone::Zone(const char* name)
+	: m_Name{ nullptr }
+	, m_Begin{}
+	, m_Generation{} {}
+
+Trace::Zone::~Zone() {}
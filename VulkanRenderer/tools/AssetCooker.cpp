@@ -0,0 +1,1186 @@
+// turns source assets into a cooked asset archive, and measures loading
+// the archive against loading the sources.
+//
+//   AssetCooker cook <archive> <inputs...>
+//   AssetCooker bench <archive> <inputs...>
+//   AssetCooker codec [meshes...]
+//   AssetCooker texcodec [images...]
+//
+// codec checks that every mesh survives the mesh codec on every decode path
+// and reports the compression ratio and decode speed, generated grids stand
+// in when no meshes are given. texcodec reports the speed and error of every
+// block format at every quality and fails when the error is above a floor, a
+// generated gradient with noise stands in when no images are given.
+//
+// .obj meshes go through the same import as the renderer and are
+// compressed. .png/.jpg/.tga/.bmp images get a mip chain and are block
+// compressed, bc5 for normal maps (_n, _normal or _nrm before the
+// extension), bc7 otherwise or bc1/bc3 at fast quality. PYX_TEXTURE_QUALITY
+// picks fast, normal or high and compressed chains are cached by content
+// in PYX_TEXTURE_CACHE, or the temp directory. .spv binaries are stored as
+// is and glsl sources are compiled with glslc (PYX_GLSLC overrides its
+// path). assets are named after their file, meshes of a multi shape file get
+// their index appended.
+
+#include "AssetArchive.h"
+#include "Hash.h"
+#include "Logger.h"
+#include "MeshCodec.h"
+#include "MeshImport.h"
+#include "TextureCodec.h"
+#include "ThreadPool.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stb_image.h>
+
+namespace {
+	constexpr uint32_t c_BENCH_ITERATIONS{ 5 };
+
+	struct CookedAsset {
+		std::string name;
+		// offset, size and name fields are filled in when writing
+		AssetEntry entry;
+		std::vector<uint8_t> payload;
+	};
+
+	struct MipLevel {
+		std::vector<uint8_t> rgba;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// everything the compressed chain depends on
+	struct TextureCacheKey {
+		uint64_t contentHash;
+		uint32_t width;
+		uint32_t height;
+		BlockFormat format;
+		BlockQuality quality;
+		uint32_t srgb;
+		uint32_t version;
+	};
+
+	int cook(const std::filesystem::path& output, std::span<char*> inputs);
+	int bench(const std::filesystem::path& archive, std::span<char*> inputs);
+	int codec(std::span<char*> inputs);
+	int texcodec(std::span<char*> inputs);
+
+	bool cookFile(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	);
+	bool cookMeshes(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	);
+	bool cookTexture(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	);
+	bool cookShader(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	);
+	bool writeArchive(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	);
+
+	std::optional<MipLevel> loadImage(const std::filesystem::path& path);
+	// side * side texels, a gradient per channel with noise on top so no
+	// block is flat
+	MipLevel generateFixtureImage(const uint32_t side);
+	// box filtered down to 1x1, srgb levels are averaged in linear space
+	std::vector<MipLevel> buildMipChain(MipLevel base, const bool srgb);
+	BlockQuality getTextureQuality();
+	bool isNormalMap(const std::filesystem::path& path);
+	bool hasAlpha(const MipLevel& level);
+	std::filesystem::path getTextureCachePath(const TextureCacheKey& key);
+
+	std::vector<ImportedMesh> importMeshes(const std::filesystem::path& path);
+	// side * side vertices of a rolling height field, uint32 indices past
+	// 256 a side
+	ImportedMesh generateGridMesh(const uint32_t side);
+	std::vector<uint32_t> widenIndices(const ImportedMesh& mesh);
+	const char* getPathName(const MeshCodecPath path);
+	const char* getBlockFormatName(const BlockFormat format);
+	const char* getQualityName(const BlockQuality quality);
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start);
+
+	// the path every asset took before archives
+	uint64_t loadSource(const std::filesystem::path& path);
+	// what the renderer does with an archive, payloads are copied into
+	// memory standing in for the upload ring
+	uint64_t loadArchive(const std::filesystem::path& path);
+
+	std::optional<std::vector<uint8_t>> readFile(
+		const std::filesystem::path& path
+	);
+	bool isGlslSource(const std::filesystem::path& path);
+	bool isImage(const std::filesystem::path& path);
+	uint64_t alignUp(const uint64_t value, const uint64_t alignment);
+}  // namespace
+
+int main(int argc, char* argv[]) {
+	Logger::init();
+
+	std::string_view command{ argc > 1 ? argv[1] : "" };
+	bool needsArchive{ command == "cook" || command == "bench" };
+	bool needsInputs{ command != "codec" && command != "texcodec" };
+	if (argc < (needsArchive ? 4 : needsInputs ? 3 : 2)) {
+		PYX_ENGINE_ERROR(
+			"usage: {0} cook|bench <archive> <inputs...>, {0} codec "
+			"[meshes...] or {0} texcodec [images...]",
+			argv[0]
+		);
+		Logger::shutdown();
+		return 1;
+	}
+
+	ThreadPool::init(0);
+	int result{ 1 };
+	if (command == "cook") {
+		result = cook(argv[2], std::span<char*>{ argv + 3, (size_t)argc - 3 });
+	} else if (command == "bench") {
+		result = bench(argv[2], std::span<char*>{ argv + 3, (size_t)argc - 3 });
+	} else if (command == "codec") {
+		result = codec(std::span<char*>{ argv + 2, (size_t)argc - 2 });
+	} else if (command == "texcodec") {
+		result = texcodec(std::span<char*>{ argv + 2, (size_t)argc - 2 });
+	} else {
+		PYX_ENGINE_ERROR("unknown command {0}", command);
+	}
+	ThreadPool::shutdown();
+	Logger::shutdown();
+
+	return result;
+}
+
+namespace {
+	int cook(const std::filesystem::path& output, std::span<char*> inputs) {
+		std::vector<CookedAsset> assets;
+		for (const char* input : inputs) {
+			if (!cookFile(input, assets)) {
+				return 1;
+			}
+		}
+
+		return writeArchive(output, assets) ? 0 : 1;
+	}
+
+	int bench(const std::filesystem::path& archive, std::span<char*> inputs) {
+		uint64_t bestSourceNs{ UINT64_MAX };
+		uint64_t bestArchiveNs{ UINT64_MAX };
+		uint64_t sourceBytes{};
+		uint64_t archiveBytes{};
+
+		// the first iteration warms the page cache for both, so the best
+		// times compare decoding against copying rather than disk reads
+		for (uint32_t i{}; i < c_BENCH_ITERATIONS; i++) {
+			auto start{ std::chrono::steady_clock::now() };
+			sourceBytes = 0;
+			for (const char* input : inputs) {
+				sourceBytes += loadSource(input);
+			}
+			auto sourceEnd{ std::chrono::steady_clock::now() };
+			archiveBytes = loadArchive(archive);
+			auto archiveEnd{ std::chrono::steady_clock::now() };
+
+			bestSourceNs = std::min<uint64_t>(
+				bestSourceNs,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					sourceEnd - start
+				)
+					.count()
+			);
+			bestArchiveNs = std::min<uint64_t>(
+				bestArchiveNs,
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					archiveEnd - sourceEnd
+				)
+					.count()
+			);
+		}
+
+		PYX_ENGINE_INFO(
+			"[Bench] sources: {0} bytes in {1:.2f}ms",
+			sourceBytes,
+			bestSourceNs / 1e6
+		);
+		PYX_ENGINE_INFO(
+			"[Bench] archive: {0} bytes in {1:.2f}ms, {2:.2f}GB/s, {3:.1f}x "
+			"faster",
+			archiveBytes,
+			bestArchiveNs / 1e6,
+			(double)archiveBytes / std::max<uint64_t>(bestArchiveNs, 1),
+			(double)bestSourceNs / std::max<uint64_t>(bestArchiveNs, 1)
+		);
+
+		return 0;
+	}
+
+	int codec(std::span<char*> inputs) {
+		constexpr MeshCodecPath c_PATHS[]{
+			MeshCodecPath::scalar,
+			MeshCodecPath::sse2,
+			MeshCodecPath::avx2,
+		};
+
+		uint64_t vertexBytes{};
+		uint64_t indexBytes{};
+		uint64_t encodedVertexBytes{};
+		uint64_t encodedIndexBytes{};
+		uint64_t bestVertexNs[std::size(c_PATHS)]{};
+		uint64_t bestIndexNs[std::size(c_PATHS)]{};
+		bool matches{ true };
+
+		std::vector<ImportedMesh> meshes;
+		for (const char* input : inputs) {
+			std::vector<ImportedMesh> imported{ importMeshes(input) };
+			meshes.insert(
+				meshes.end(),
+				std::make_move_iterator(imported.begin()),
+				std::make_move_iterator(imported.end())
+			);
+		}
+		// without inputs the paths are still checked against each other, one
+		// grid for each index type
+		if (inputs.empty()) {
+			meshes.emplace_back(generateGridMesh(256));
+			meshes.emplace_back(generateGridMesh(320));
+		}
+
+		for (const auto& mesh : meshes) {
+			std::vector<uint32_t> indices{ widenIndices(mesh) };
+			std::vector<uint8_t> vertexStream{
+				encodeVertexStream(mesh.vertexData, mesh.vertexStride)
+			};
+			std::vector<uint8_t> indexStream{ encodeIndexStream(indices) };
+
+			vertexBytes += mesh.vertexData.size();
+			indexBytes += mesh.indices.size();
+			encodedVertexBytes += vertexStream.size();
+			encodedIndexBytes += indexStream.size();
+
+			std::vector<uint8_t> vertices(mesh.vertexData.size());
+			std::vector<uint8_t> decodedIndices(mesh.indices.size());
+			for (size_t path{}; path < std::size(c_PATHS); path++) {
+				if (c_PATHS[path] > getBestMeshCodecPath()) {
+					continue;
+				}
+
+				uint64_t vertexNs{ UINT64_MAX };
+				uint64_t indexNs{ UINT64_MAX };
+				for (uint32_t i{}; i < c_BENCH_ITERATIONS; i++) {
+					auto start{ std::chrono::steady_clock::now() };
+					matches &= decodeVertexStream(
+						vertices.data(),
+						mesh.vertexCount,
+						mesh.vertexStride,
+						vertexStream,
+						c_PATHS[path]
+					);
+					vertexNs = std::min(vertexNs, getElapsedNs(start));
+
+					start = std::chrono::steady_clock::now();
+					matches &= decodeIndexStream(
+						decodedIndices.data(),
+						mesh.indexCount,
+						mesh.indexType,
+						indexStream,
+						c_PATHS[path]
+					);
+					indexNs = std::min(indexNs, getElapsedNs(start));
+				}
+				bestVertexNs[path] += vertexNs;
+				bestIndexNs[path] += indexNs;
+
+				matches &= vertices == mesh.vertexData &&
+					decodedIndices == mesh.indices;
+			}
+		}
+
+		PYX_ENGINE_INFO(
+			"[Codec] vertices {0} -> {1} bytes ({2:.2f}x), indices {3} -> {4} "
+			"bytes ({5:.2f}x)",
+			vertexBytes,
+			encodedVertexBytes,
+			(double)vertexBytes / std::max<uint64_t>(encodedVertexBytes, 1),
+			indexBytes,
+			encodedIndexBytes,
+			(double)indexBytes / std::max<uint64_t>(encodedIndexBytes, 1)
+		);
+		for (size_t path{}; path < std::size(c_PATHS); path++) {
+			if (c_PATHS[path] > getBestMeshCodecPath()) {
+				continue;
+			}
+			PYX_ENGINE_INFO(
+				"[Codec] {0}: vertices {1:.2f}GB/s, indices {2:.2f}GB/s",
+				getPathName(c_PATHS[path]),
+				(double)vertexBytes / std::max<uint64_t>(bestVertexNs[path], 1),
+				(double)indexBytes / std::max<uint64_t>(bestIndexNs[path], 1)
+			);
+		}
+
+		if (!matches) {
+			PYX_ENGINE_ERROR("[Codec] decoded meshes do not match");
+			return 1;
+		}
+
+		return 0;
+	}
+
+	int texcodec(std::span<char*> inputs) {
+		constexpr BlockFormat c_FORMATS[]{
+			BlockFormat::bc1,
+			BlockFormat::bc3,
+			BlockFormat::bc5,
+			BlockFormat::bc7,
+		};
+		constexpr BlockQuality c_QUALITIES[]{
+			BlockQuality::fast,
+			BlockQuality::normal,
+			BlockQuality::high,
+		};
+		// psnr floors in dB per format and quality, well below what photos
+		// and the generated fixture reach, a broken encoder falls far short
+		constexpr double c_MIN_PSNR[][std::size(c_QUALITIES)]{
+			{ 30.0, 31.0, 31.0 },
+			{ 30.0, 31.0, 31.0 },
+			{ 36.0, 37.0, 37.0 },
+			{ 32.0, 32.0, 33.0 },
+		};
+		static_assert(std::size(c_MIN_PSNR) == std::size(c_FORMATS));
+
+		std::vector<MipLevel> images;
+		for (const char* input : inputs) {
+			std::optional<MipLevel> image{ loadImage(input) };
+			if (!image.has_value()) {
+				return 1;
+			}
+			images.emplace_back(std::move(*image));
+		}
+		if (inputs.empty()) {
+			images.emplace_back(generateFixtureImage(256));
+		}
+
+		uint64_t texels{};
+		uint64_t encodeNs[std::size(c_FORMATS)][std::size(c_QUALITIES)]{};
+		double squaredError[std::size(c_FORMATS)][std::size(c_QUALITIES)]{};
+
+		for (const MipLevel& image : images) {
+			texels += (uint64_t)image.width * image.height;
+
+			for (size_t format{}; format < std::size(c_FORMATS); format++) {
+				// only the channels the format stores
+				uint32_t channels{ c_FORMATS[format] == BlockFormat::bc1 ? 3u
+								   : c_FORMATS[format] == BlockFormat::bc5
+									   ? 2u
+									   : 4u };
+				for (size_t quality{}; quality < std::size(c_QUALITIES);
+					 quality++) {
+					auto start{ std::chrono::steady_clock::now() };
+					std::vector<uint8_t> blocks{ compressTexture(
+						image.rgba,
+						image.width,
+						image.height,
+						c_FORMATS[format],
+						c_QUALITIES[quality]
+					) };
+					encodeNs[format][quality] += getElapsedNs(start);
+
+					std::vector<uint8_t> decoded{ decompressTexture(
+						blocks, image.width, image.height, c_FORMATS[format]
+					) };
+					for (size_t i{}; i < decoded.size(); i++) {
+						if (i % 4 < channels) {
+							double delta{ (double)decoded[i] - image.rgba[i] };
+							squaredError[format][quality] += delta * delta;
+						}
+					}
+				}
+			}
+		}
+
+		bool passed{ true };
+		for (size_t format{}; format < std::size(c_FORMATS); format++) {
+			uint32_t channels{ c_FORMATS[format] == BlockFormat::bc1 ? 3u
+							   : c_FORMATS[format] == BlockFormat::bc5
+								   ? 2u
+								   : 4u };
+			for (size_t quality{}; quality < std::size(c_QUALITIES);
+				 quality++) {
+				double meanError{ squaredError[format][quality] /
+								  std::max<double>(texels * channels, 1) };
+				double psnr{
+					10 * std::log10(255.0 * 255.0 / std::max(meanError, 1e-9))
+				};
+				PYX_ENGINE_INFO(
+					"[TexCodec] {0} {1}: {2:.2f}MTexels/s, {3:.2f}dB",
+					getBlockFormatName(c_FORMATS[format]),
+					getQualityName(c_QUALITIES[quality]),
+					texels * 1e3 /
+						std::max<uint64_t>(encodeNs[format][quality], 1),
+					psnr
+				);
+
+				if (psnr < c_MIN_PSNR[format][quality]) {
+					PYX_ENGINE_ERROR(
+						"[TexCodec] {0} {1} is below {2:.1f}dB",
+						getBlockFormatName(c_FORMATS[format]),
+						getQualityName(c_QUALITIES[quality]),
+						c_MIN_PSNR[format][quality]
+					);
+					passed = false;
+				}
+			}
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	bool cookFile(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	) {
+		if (path.extension() == ".obj") {
+			return cookMeshes(path, assets);
+		}
+		if (isImage(path)) {
+			return cookTexture(path, assets);
+		}
+		if (path.extension() == ".spv" || isGlslSource(path)) {
+			return cookShader(path, assets);
+		}
+
+		PYX_ENGINE_ERROR("[Cooker] no cooker for {0}", path.string());
+		return false;
+	}
+
+	bool cookMeshes(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	) {
+		std::vector<ImportedMesh> meshes{ importMeshes(path) };
+		if (meshes.empty()) {
+			return false;
+		}
+
+		for (size_t i{}; i < meshes.size(); i++) {
+			const ImportedMesh& mesh{ meshes[i] };
+			std::vector<uint8_t> vertexStream{
+				encodeVertexStream(mesh.vertexData, mesh.vertexStride)
+			};
+			std::vector<uint8_t> indexStream{
+				encodeIndexStream(widenIndices(mesh))
+			};
+
+			CookedAsset asset{
+				.name = path.filename().string(),
+				.entry = AssetEntry{
+					.type = AssetType::mesh,
+					.flags = c_ASSET_FLAG_COMPRESSED,
+					.mesh = MeshAssetInfo{
+						.vertexCount = mesh.vertexCount,
+						.vertexStride = mesh.vertexStride,
+						.indexCount = mesh.indexCount,
+						.indexType = mesh.indexType,
+						.positionScale = { mesh.quantization.scale.x,
+										   mesh.quantization.scale.y,
+										   mesh.quantization.scale.z },
+						.positionOffset = { mesh.quantization.offset.x,
+											mesh.quantization.offset.y,
+											mesh.quantization.offset.z },
+						.vertexBytes = vertexStream.size(),
+						.indexOffset = alignUp(vertexStream.size(), 16),
+						.indexBytes = indexStream.size(),
+					},
+				},
+			};
+			if (meshes.size() > 1) {
+				asset.name += "#" + std::to_string(i);
+			}
+
+			asset.payload = std::move(vertexStream);
+			asset.payload.resize(asset.entry.mesh.indexOffset);
+			asset.payload.insert(
+				asset.payload.end(), indexStream.begin(), indexStream.end()
+			);
+			assets.emplace_back(std::move(asset));
+		}
+
+		return true;
+	}
+
+	bool cookTexture(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	) {
+		auto start{ std::chrono::steady_clock::now() };
+
+		std::optional<MipLevel> image{ loadImage(path) };
+		if (!image.has_value()) {
+			return false;
+		}
+
+		bool normalMap{ isNormalMap(path) };
+		BlockQuality quality{ getTextureQuality() };
+		BlockFormat format{ BlockFormat::bc7 };
+		if (normalMap) {
+			format = BlockFormat::bc5;
+		} else if (quality == BlockQuality::fast) {
+			format = hasAlpha(image.value()) ? BlockFormat::bc3
+											 : BlockFormat::bc1;
+		}
+
+		uint32_t width{ image->width };
+		uint32_t height{ image->height };
+		uint32_t mipCount{ (uint32_t)std::bit_width(std::max(width, height)) };
+		size_t compressedSize{};
+		for (uint32_t level{}; level < mipCount; level++) {
+			compressedSize += getCompressedSize(
+				format,
+				std::max(width >> level, 1u),
+				std::max(height >> level, 1u)
+			);
+		}
+
+		TextureCacheKey key{
+			.contentHash = hashBytes(image->rgba.data(), image->rgba.size()),
+			.width = width,
+			.height = height,
+			.format = format,
+			.quality = quality,
+			.srgb = !normalMap,
+			.version = c_TEXTURE_CODEC_VERSION,
+		};
+		std::filesystem::path cachePath{ getTextureCachePath(key) };
+
+		std::optional<std::vector<uint8_t>> payload{ readFile(cachePath) };
+		bool cached{ payload.has_value() && payload->size() == compressedSize };
+		if (!cached) {
+			payload.emplace();
+			payload->reserve(compressedSize);
+			for (const auto& level :
+				 buildMipChain(std::move(image.value()), !normalMap)) {
+				std::vector<uint8_t> blocks{ compressTexture(
+					level.rgba, level.width, level.height, format, quality
+				) };
+				payload->insert(payload->end(), blocks.begin(), blocks.end());
+			}
+
+			std::error_code error{};
+			std::filesystem::create_directories(cachePath.parent_path(), error);
+			std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+			file.write((const char*)payload->data(), payload->size());
+			if (error || !file) {
+				PYX_ENGINE_WARNING(
+					"[Cooker] could not cache {0} in {1}",
+					path.string(),
+					cachePath.string()
+				);
+			}
+		}
+
+		PYX_ENGINE_INFO(
+			"[Cooker] {0}: {1}x{2}, {3} levels of {4}, {5} bytes{6} in "
+			"{7:.2f}ms",
+			path.string(),
+			width,
+			height,
+			mipCount,
+			getBlockFormatName(format),
+			payload->size(),
+			cached ? " from the cache" : "",
+			getElapsedNs(start) / 1e6
+		);
+
+		assets.emplace_back(CookedAsset{
+			.name = path.filename().string(),
+			.entry = AssetEntry{
+				.type = AssetType::texture,
+				.texture = TextureAssetInfo{
+					.width = width,
+					.height = height,
+					.mipCount = mipCount,
+					.format = getBlockVkFormat(format, !normalMap),
+				},
+			},
+			.payload = std::move(payload.value()),
+		});
+
+		return true;
+	}
+
+	bool cookShader(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	) {
+		std::filesystem::path binaryPath{ path };
+		std::string name{ path.filename().string() };
+
+		// named like the binaries the build produces
+		if (isGlslSource(path)) {
+			const char* glslc{ std::getenv("PYX_GLSLC") };
+			binaryPath = std::filesystem::temp_directory_path() /
+				(name + ".spv");
+			name += ".spv";
+
+			std::string command{
+				std::string{ glslc != nullptr ? glslc : "glslc" } + " \"" +
+				path.string() + "\" -o \"" + binaryPath.string() + "\""
+			};
+			if (std::system(command.c_str()) != 0) {
+				PYX_ENGINE_ERROR(
+					"[Cooker] could not compile {0}", path.string()
+				);
+				return false;
+			}
+		}
+
+		std::optional<std::vector<uint8_t>> code{ readFile(binaryPath) };
+		if (!code.has_value() || code->empty() ||
+			code->size() % sizeof(uint32_t) != 0) {
+			PYX_ENGINE_ERROR("[Cooker] {0} is not spir-v", path.string());
+			return false;
+		}
+
+		assets.emplace_back(CookedAsset{
+			.name = name,
+			.entry = AssetEntry{ .type = AssetType::shader },
+			.payload = std::move(code.value()),
+		});
+
+		return true;
+	}
+
+	bool writeArchive(
+		const std::filesystem::path& path, std::vector<CookedAsset>& assets
+	) {
+		for (auto& asset : assets) {
+			asset.entry.nameHash =
+				hashBytes(asset.name.data(), asset.name.size());
+		}
+		std::ranges::sort(assets, {}, [](const CookedAsset& asset) {
+			return asset.entry.nameHash;
+		});
+		for (size_t i{ 1 }; i < assets.size(); i++) {
+			if (assets[i].entry.nameHash == assets[i - 1].entry.nameHash) {
+				PYX_ENGINE_ERROR(
+					"[Cooker] {0} and {1} have the same name hash",
+					assets[i - 1].name,
+					assets[i].name
+				);
+				return false;
+			}
+		}
+
+		// header, table of contents, names, then the aligned payloads
+		std::string strings;
+		std::vector<AssetEntry> entries;
+		entries.reserve(assets.size());
+
+		uint64_t tocOffset{ sizeof(AssetArchiveHeader) };
+		uint64_t stringTableOffset{
+			tocOffset + assets.size() * sizeof(AssetEntry)
+		};
+		for (const auto& asset : assets) {
+			strings += asset.name;
+		}
+
+		uint64_t payloadOffset{ alignUp(
+			stringTableOffset + strings.size(), c_ASSET_PAYLOAD_ALIGNMENT
+		) };
+		uint32_t nameOffset{};
+		for (const auto& asset : assets) {
+			AssetEntry entry{ asset.entry };
+			entry.nameOffset = nameOffset;
+			entry.nameLength = (uint32_t)asset.name.size();
+			entry.offset = payloadOffset;
+			entry.size = asset.payload.size();
+			entries.emplace_back(entry);
+
+			nameOffset += entry.nameLength;
+			payloadOffset = alignUp(
+				payloadOffset + entry.size, c_ASSET_PAYLOAD_ALIGNMENT
+			);
+		}
+
+		AssetArchiveHeader header{
+			.magic = c_ASSET_ARCHIVE_MAGIC,
+			.version = c_ASSET_ARCHIVE_VERSION,
+			.entryCount = (uint32_t)entries.size(),
+			.stringTableSize = (uint32_t)strings.size(),
+			.tocOffset = tocOffset,
+			.stringTableOffset = stringTableOffset,
+		};
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			PYX_ENGINE_ERROR("[Cooker] could not create {0}", path.string());
+			return false;
+		}
+
+		file.write((const char*)&header, sizeof(header));
+		file.write(
+			(const char*)entries.data(), entries.size() * sizeof(AssetEntry)
+		);
+		file.write(strings.data(), strings.size());
+
+		const char padding[c_ASSET_PAYLOAD_ALIGNMENT]{};
+		for (size_t i{}; i < assets.size(); i++) {
+			uint64_t position{ (uint64_t)file.tellp() };
+			file.write(padding, entries[i].offset - position);
+			file.write(
+				(const char*)assets[i].payload.data(),
+				assets[i].payload.size()
+			);
+		}
+		file.close();
+
+		if (!file) {
+			PYX_ENGINE_ERROR("[Cooker] could not write {0}", path.string());
+			return false;
+		}
+
+		PYX_ENGINE_INFO(
+			"[Cooker] wrote {0} assets to {1}, {2} bytes",
+			assets.size(),
+			path.string(),
+			payloadOffset
+		);
+
+		return true;
+	}
+
+	uint64_t loadSource(const std::filesystem::path& path) {
+		if (path.extension() == ".obj") {
+			uint64_t bytes{};
+			for (const auto& mesh : importMeshes(path)) {
+				bytes += mesh.vertexData.size() + mesh.indices.size();
+			}
+			return bytes;
+		}
+
+		std::optional<std::vector<uint8_t>> data{ readFile(path) };
+		if (!data.has_value()) {
+			return 0;
+		}
+		if (!isImage(path)) {
+			return data->size();
+		}
+
+		int width{};
+		int height{};
+		int channels{};
+		stbi_uc* pixels{ stbi_load_from_memory(
+			data->data(), (int)data->size(), &width, &height, &channels, 4
+		) };
+		stbi_image_free(pixels);
+
+		return (uint64_t)width * height * 4;
+	}
+
+	uint64_t loadArchive(const std::filesystem::path& path) {
+		AssetArchive archive;
+		if (!archive.open(path)) {
+			return 0;
+		}
+
+		// compressed meshes decode straight into it
+		uint64_t largest{};
+		for (const auto& entry : archive.getEntries()) {
+			largest = std::max(largest, entry.size);
+			if (entry.type == AssetType::mesh) {
+				largest = std::max<uint64_t>(
+					largest,
+					(uint64_t)entry.mesh.vertexCount * entry.mesh.vertexStride
+				);
+				largest = std::max<uint64_t>(
+					largest, (uint64_t)entry.mesh.indexCount * sizeof(uint32_t)
+				);
+			}
+		}
+		std::vector<uint8_t> upload(largest);
+
+		uint64_t bytes{};
+		for (const auto& entry : archive.getEntries()) {
+			if (entry.type == AssetType::mesh &&
+				(entry.flags & c_ASSET_FLAG_COMPRESSED) != 0) {
+				decodeVertexStream(
+					upload.data(),
+					entry.mesh.vertexCount,
+					entry.mesh.vertexStride,
+					archive.getMeshVertices(entry)
+				);
+				decodeIndexStream(
+					upload.data(),
+					entry.mesh.indexCount,
+					entry.mesh.indexType,
+					archive.getMeshIndices(entry)
+				);
+				bytes += (uint64_t)entry.mesh.vertexCount *
+						entry.mesh.vertexStride +
+					(uint64_t)entry.mesh.indexCount *
+						(entry.mesh.indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4);
+				continue;
+			}
+
+			std::span<const uint8_t> payload{ archive.getPayload(entry) };
+			memcpy(upload.data(), payload.data(), payload.size());
+			bytes += payload.size();
+		}
+		archive.close();
+
+		return bytes;
+	}
+
+	std::optional<MipLevel> loadImage(const std::filesystem::path& path) {
+		int width{};
+		int height{};
+		int channels{};
+		stbi_uc* pixels{
+			stbi_load(path.string().c_str(), &width, &height, &channels, 4)
+		};
+		if (pixels == nullptr) {
+			PYX_ENGINE_ERROR(
+				"[Cooker] could not decode {0}: {1}",
+				path.string(),
+				stbi_failure_reason()
+			);
+			return {};
+		}
+
+		MipLevel image{
+			.rgba = std::vector<uint8_t>(
+				pixels, pixels + (size_t)width * height * 4
+			),
+			.width = (uint32_t)width,
+			.height = (uint32_t)height,
+		};
+		stbi_image_free(pixels);
+
+		return image;
+	}
+
+	MipLevel generateFixtureImage(const uint32_t side) {
+		MipLevel image{
+			.rgba = std::vector<uint8_t>((size_t)side * side * 4),
+			.width = side,
+			.height = side,
+		};
+		for (uint32_t y{}; y < side; y++) {
+			for (uint32_t x{}; x < side; x++) {
+				uint32_t texel{ y * side + x };
+				uint64_t noise{ hashBytes(&texel, sizeof(texel)) };
+				uint32_t gradients[4]{
+					x,
+					y,
+					side - 1 - (x + y) / 2,
+					x * y / side,
+				};
+				for (uint32_t channel{}; channel < 4; channel++) {
+					int32_t value{
+						(int32_t)(gradients[channel] * 255 / (side - 1)) +
+						(int32_t)((noise >> (channel * 8)) & 15) - 8
+					};
+					image.rgba[(size_t)texel * 4 + channel] =
+						(uint8_t)std::clamp(value, 0, 255);
+				}
+			}
+		}
+
+		return image;
+	}
+
+	std::vector<MipLevel> buildMipChain(MipLevel base, const bool srgb) {
+		static const std::array<float, 256> c_TO_LINEAR{ []() {
+			std::array<float, 256> table{};
+			for (size_t i{}; i < table.size(); i++) {
+				float value{ i / 255.0f };
+				table[i] = value <= 0.04045f
+					? value / 12.92f
+					: std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+			return table;
+		}() };
+		auto toSrgb{ [](const float linear) {
+			float value{ linear <= 0.0031308f
+							 ? linear * 12.92f
+							 : 1.055f * std::pow(linear, 1 / 2.4f) - 0.055f };
+			return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255);
+		} };
+
+		std::vector<MipLevel> levels;
+		levels.emplace_back(std::move(base));
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			const MipLevel& source{ levels.back() };
+			MipLevel level{
+				.width = std::max(source.width / 2, 1u),
+				.height = std::max(source.height / 2, 1u),
+			};
+			level.rgba.resize((size_t)level.width * level.height * 4);
+
+			for (uint32_t y{}; y < level.height; y++) {
+				uint32_t y0{ std::min(y * 2, source.height - 1) };
+				uint32_t y1{ std::min(y * 2 + 1, source.height - 1) };
+				for (uint32_t x{}; x < level.width; x++) {
+					uint32_t x0{ std::min(x * 2, source.width - 1) };
+					uint32_t x1{ std::min(x * 2 + 1, source.width - 1) };
+					const uint8_t* texels[4]{
+						&source.rgba[((size_t)y0 * source.width + x0) * 4],
+						&source.rgba[((size_t)y0 * source.width + x1) * 4],
+						&source.rgba[((size_t)y1 * source.width + x0) * 4],
+						&source.rgba[((size_t)y1 * source.width + x1) * 4],
+					};
+					uint8_t* out{
+						&level.rgba[((size_t)y * level.width + x) * 4]
+					};
+
+					for (uint32_t channel{}; channel < 4; channel++) {
+						bool linear{ srgb && channel < 3 };
+						float sum{};
+						for (const uint8_t* texel : texels) {
+							sum += linear ? c_TO_LINEAR[texel[channel]]
+										  : texel[channel];
+						}
+						out[channel] = linear ? toSrgb(sum / 4)
+											  : (uint8_t)std::lround(sum / 4);
+					}
+				}
+			}
+
+			levels.emplace_back(std::move(level));
+		}
+
+		return levels;
+	}
+
+	BlockQuality getTextureQuality() {
+		const char* quality{ std::getenv("PYX_TEXTURE_QUALITY") };
+		std::string_view name{ quality != nullptr ? quality : "normal" };
+		if (name == "fast") {
+			return BlockQuality::fast;
+		}
+		if (name == "high") {
+			return BlockQuality::high;
+		}
+		if (name != "normal") {
+			PYX_ENGINE_WARNING(
+				"[Cooker] unknown texture quality {0}, using normal", name
+			);
+		}
+
+		return BlockQuality::normal;
+	}
+
+	bool isNormalMap(const std::filesystem::path& path) {
+		constexpr std::string_view c_SUFFIXES[]{ "_n", "_normal", "_nrm" };
+		std::string stem{ path.stem().string() };
+		return std::ranges::any_of(c_SUFFIXES, [&](const std::string_view end) {
+			return stem.ends_with(end);
+		});
+	}
+
+	bool hasAlpha(const MipLevel& level) {
+		for (size_t i{ 3 }; i < level.rgba.size(); i += 4) {
+			if (level.rgba[i] != 255) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	std::filesystem::path getTextureCachePath(const TextureCacheKey& key) {
+		const char* directory{ std::getenv("PYX_TEXTURE_CACHE") };
+		std::filesystem::path cacheDirectory{
+			directory != nullptr
+				? std::filesystem::path{ directory }
+				: std::filesystem::temp_directory_path() / "pyx_texture_cache"
+		};
+
+		char name[16]{};
+		std::to_chars_result result{ std::to_chars(
+			name, name + sizeof(name), hashBytes(&key, sizeof(key)), 16
+		) };
+
+		return cacheDirectory / (std::string{ name, result.ptr } + ".bcn");
+	}
+
+	std::vector<ImportedMesh> importMeshes(const std::filesystem::path& path) {
+		MeshImporter importer;
+		importer.requestImport(path);
+		// waits for the import
+		importer.shutdown();
+
+		std::vector<MeshImportResult> results{ importer.pollCompleted() };
+		if (results.empty() || !results[0].success) {
+			return {};
+		}
+
+		return std::move(results[0].meshes);
+	}
+
+	ImportedMesh generateGridMesh(const uint32_t side) {
+		ImportedMesh mesh{
+			.name = "grid" + std::to_string(side),
+			.vertexStride = sizeof(PackedVertex),
+			.vertexCount = side * side,
+			.quantization = VertexQuantization{
+				.scale = glm::vec3{ 1.0f / 65535.0f },
+				.offset = glm::vec3{ 0.0f },
+			},
+			.indexType = side * side > 65536 ? VK_INDEX_TYPE_UINT32
+											 : VK_INDEX_TYPE_UINT16,
+			.indexCount = (side - 1) * (side - 1) * 6,
+		};
+
+		std::vector<PackedVertex> vertices(mesh.vertexCount);
+		for (uint32_t z{}; z < side; z++) {
+			for (uint32_t x{}; x < side; x++) {
+				double height{ std::sin(x * 0.05) * std::cos(z * 0.07) };
+				vertices[z * side + x] = PackedVertex{
+					.pos = { (uint16_t)(x * 65535 / (side - 1)),
+							 (uint16_t)(32767.5 + height * 16384),
+							 (uint16_t)(z * 65535 / (side - 1)),
+							 0 },
+					.color = { (uint8_t)(x * 255 / (side - 1)),
+							   (uint8_t)(z * 255 / (side - 1)),
+							   (uint8_t)(127.5 + height * 127),
+							   255 },
+				};
+			}
+		}
+		mesh.vertexData.resize(vertices.size() * sizeof(PackedVertex));
+		memcpy(mesh.vertexData.data(), vertices.data(), mesh.vertexData.size());
+
+		uint32_t indexSize{ mesh.indexType == VK_INDEX_TYPE_UINT16 ? 2u : 4u };
+		mesh.indices.resize((size_t)mesh.indexCount * indexSize);
+		uint32_t written{};
+		auto writeIndex{ [&](const uint32_t index) {
+			memcpy(
+				mesh.indices.data() + (size_t)written++ * indexSize,
+				&index,
+				indexSize
+			);
+		} };
+		for (uint32_t z{}; z + 1 < side; z++) {
+			for (uint32_t x{}; x + 1 < side; x++) {
+				uint32_t corner{ z * side + x };
+				for (uint32_t index : { corner,
+										corner + side,
+										corner + 1,
+										corner + 1,
+										corner + side,
+										corner + side + 1 }) {
+					writeIndex(index);
+				}
+			}
+		}
+
+		return mesh;
+	}
+
+	std::vector<uint32_t> widenIndices(const ImportedMesh& mesh) {
+		std::vector<uint32_t> indices(mesh.indexCount);
+		for (uint32_t i{}; i < mesh.indexCount; i++) {
+			if (mesh.indexType == VK_INDEX_TYPE_UINT16) {
+				uint16_t index{};
+				memcpy(&index, mesh.indices.data() + i * 2, sizeof(index));
+				indices[i] = index;
+			} else {
+				memcpy(
+					&indices[i], mesh.indices.data() + i * 4, sizeof(uint32_t)
+				);
+			}
+		}
+
+		return indices;
+	}
+
+	const char* getPathName(const MeshCodecPath path) {
+		switch (path) {
+			case MeshCodecPath::scalar:
+				return "scalar";
+			case MeshCodecPath::sse2:
+				return "sse2";
+			case MeshCodecPath::avx2:
+				return "avx2";
+		}
+
+		return "unknown";
+	}
+
+	const char* getBlockFormatName(const BlockFormat format) {
+		switch (format) {
+			case BlockFormat::bc1:
+				return "bc1";
+			case BlockFormat::bc3:
+				return "bc3";
+			case BlockFormat::bc5:
+				return "bc5";
+			case BlockFormat::bc7:
+				return "bc7";
+		}
+
+		return "unknown";
+	}
+
+	const char* getQualityName(const BlockQuality quality) {
+		switch (quality) {
+			case BlockQuality::fast:
+				return "fast";
+			case BlockQuality::normal:
+				return "normal";
+			case BlockQuality::high:
+				return "high";
+		}
+
+		return "unknown";
+	}
+
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				   std::chrono::steady_clock::now() - start
+		)
+			.count();
+	}
+
+	std::optional<std::vector<uint8_t>> readFile(
+		const std::filesystem::path& path
+	) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) {
+			return {};
+		}
+
+		std::vector<uint8_t> data((size_t)file.tellg());
+		file.seekg(0, std::ios::beg);
+		file.read((char*)data.data(), data.size());
+
+		return data;
+	}
+
+	bool isGlslSource(const std::filesystem::path& path) {
+		constexpr std::string_view c_STAGES[]{ ".vert", ".frag", ".comp",
+											   ".geom", ".tesc", ".tese" };
+		return std::ranges::find(c_STAGES, path.extension().string()) !=
+			std::end(c_STAGES);
+	}
+
+	bool isImage(const std::filesystem::path& path) {
+		constexpr std::string_view c_IMAGES[]{ ".png", ".jpg", ".jpeg",
+											   ".tga", ".bmp" };
+		return std::ranges::find(c_IMAGES, path.extension().string()) !=
+			std::end(c_IMAGES);
+	}
+
+	uint64_t alignUp(const uint64_t value, const uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}  // namespace
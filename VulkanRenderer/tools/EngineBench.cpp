@@ -0,0 +1,249 @@
+// checks and measures engine runtime systems outside the renderer.
+//
+//   EngineBench jobs <threads>
+//   EngineBench trace
+//
+// jobs checks the thread pool with nested fan outs and dependency chains,
+// then reports how a parallel for scales from 1 to <threads> threads. trace
+// reports what a trace zone costs with and without a capture running and
+// checks that the capture can be written. the exit code is non zero when a
+// check failed, so both run as tests as well.
+
+#include "Hash.h"
+#include "Logger.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string_view>
+
+namespace {
+	constexpr uint32_t c_BENCH_ITERATIONS{ 5 };
+	// jobs per level of the fan out and per stage of the chains
+	constexpr uint32_t c_STRESS_FAN_OUT{ 64 };
+	constexpr uint32_t c_STRESS_STAGES{ 16 };
+	constexpr uint32_t c_STRESS_ROUNDS{ 8 };
+	constexpr uint32_t c_SCALING_ITEMS{ 1 << 20 };
+	// hashes per item, enough that batches outweigh scheduling
+	constexpr uint32_t c_SCALING_ROUNDS{ 32 };
+	// per capture, within what a thread records before dropping zones
+	constexpr uint32_t c_TRACE_ZONES{ 1 << 16 };
+
+	int jobs(const uint32_t maxThreads);
+	int trace();
+
+	// false if a job ran out of order or went missing
+	bool stressThreadPool();
+	uint64_t hashRange(const uint32_t begin, const uint32_t end);
+	// best of c_BENCH_ITERATIONS runs of c_TRACE_ZONES zones
+	uint64_t timeTraceZones(const bool capture);
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start);
+}  // namespace
+
+int main(int argc, char* argv[]) {
+	Logger::init();
+
+	std::string_view command{ argc > 1 ? argv[1] : "" };
+	if (argc < (command == "trace" ? 2 : 3)) {
+		PYX_ENGINE_ERROR("usage: {0} jobs <threads> or {0} trace", argv[0]);
+		Logger::shutdown();
+		return 1;
+	}
+
+	int result{ 1 };
+	if (command == "jobs") {
+		result = jobs((uint32_t)std::max(std::atoi(argv[2]), 1));
+	} else if (command == "trace") {
+		result = trace();
+	} else {
+		PYX_ENGINE_ERROR("unknown command {0}", command);
+	}
+	Logger::shutdown();
+
+	return result;
+}
+
+namespace {
+	int jobs(const uint32_t maxThreads) {
+		bool passed{ true };
+		uint64_t expected{ hashRange(0, c_SCALING_ITEMS) };
+		uint64_t serialNs{};
+		// the pool is built for every thread count
+		for (uint32_t threads{ 1 }; threads <= maxThreads; threads++) {
+			// a single thread is the plain loop, the pool always has a worker
+			if (threads > 1) {
+				ThreadPool::init(threads - 1);
+				if (!stressThreadPool()) {
+					PYX_ENGINE_ERROR(
+						"[Jobs] stress failed with {0} threads", threads
+					);
+					passed = false;
+				}
+			}
+
+			uint64_t bestNs{ UINT64_MAX };
+			for (uint32_t i{}; i < c_BENCH_ITERATIONS; i++) {
+				std::atomic<uint64_t> sum{};
+				auto start{ std::chrono::steady_clock::now() };
+				if (threads > 1) {
+					ThreadPool::parallelFor(
+						c_SCALING_ITEMS,
+						0,
+						[&](uint32_t begin, uint32_t end, uint32_t) {
+							sum += hashRange(begin, end);
+						}
+					);
+				} else {
+					// keeps the loop from being computed once and hoisted out
+					// of the timing
+					volatile uint32_t items{ c_SCALING_ITEMS };
+					sum = hashRange(0, items);
+				}
+				bestNs = std::min(bestNs, getElapsedNs(start));
+
+				if (sum != expected) {
+					PYX_ENGINE_ERROR(
+						"[Jobs] parallel for lost items with {0} threads",
+						threads
+					);
+					passed = false;
+				}
+			}
+			if (threads == 1) {
+				serialNs = bestNs;
+			} else {
+				ThreadPool::shutdown();
+			}
+
+			PYX_ENGINE_INFO(
+				"[Jobs] {0} threads: {1:.2f}ms, {2:.2f}x",
+				threads,
+				bestNs / 1e6,
+				(double)serialNs / std::max<uint64_t>(bestNs, 1)
+			);
+		}
+
+		return passed ? 0 : 1;
+	}
+
+	int trace() {
+		uint64_t idleNs{ timeTraceZones(false) };
+		uint64_t captureNs{ timeTraceZones(true) };
+		PYX_ENGINE_INFO(
+			"[Trace] {0:.2f}ns/zone idle, {1:.2f}ns/zone capturing",
+			(double)idleNs / c_TRACE_ZONES,
+			(double)captureNs / c_TRACE_ZONES
+		);
+
+		// the capture is written outside the timing, once to check it
+		std::filesystem::path path{ std::filesystem::temp_directory_path() /
+									"EngineBenchTrace.json" };
+		Trace::beginCapture();
+		for (uint32_t i{}; i < c_TRACE_ZONES; i++) {
+			Trace::Zone zone{ "zone" };
+		}
+		bool written{ Trace::endCapture(path) };
+		std::error_code error{};
+		std::filesystem::remove(path, error);
+
+		return written ? 0 : 1;
+	}
+
+	bool stressThreadPool() {
+		bool passed{ true };
+		for (uint32_t round{}; round < c_STRESS_ROUNDS; round++) {
+			// every job fans out again and waits on its children, which puts
+			// them on the worker's own deque for the others to steal
+			std::atomic<uint32_t> leaves{};
+			ThreadPool::JobCounter fanOut{};
+			for (uint32_t i{}; i < c_STRESS_FAN_OUT; i++) {
+				ThreadPool::submit(
+					[&](uint32_t) {
+						ThreadPool::JobCounter children{};
+						for (uint32_t j{}; j < c_STRESS_FAN_OUT; j++) {
+							ThreadPool::submit(
+								[&](uint32_t) { leaves++; }, &children
+							);
+						}
+						ThreadPool::wait(children);
+					},
+					&fanOut
+				);
+			}
+			ThreadPool::wait(fanOut);
+			passed &= leaves == c_STRESS_FAN_OUT * c_STRESS_FAN_OUT;
+
+			// stages of jobs that only start after the previous stage, each
+			// stage ends with a job moving the stage on
+			std::atomic<uint32_t> stage{};
+			std::atomic<bool> ordered{ true };
+			std::array<ThreadPool::JobCounter, c_STRESS_STAGES> stageJobs{};
+			std::array<ThreadPool::JobCounter, c_STRESS_STAGES> stageEnds{};
+			for (uint32_t s{}; s < c_STRESS_STAGES; s++) {
+				for (uint32_t i{}; i < c_STRESS_FAN_OUT; i++) {
+					auto job{ [&, s](uint32_t) {
+						if (stage != s) {
+							ordered = false;
+						}
+					} };
+					if (s == 0) {
+						ThreadPool::submit(job, &stageJobs[s]);
+					} else {
+						ThreadPool::submitAfter(
+							stageEnds[s - 1], job, &stageJobs[s]
+						);
+					}
+				}
+				ThreadPool::submitAfter(
+					stageJobs[s], [&](uint32_t) { stage++; }, &stageEnds[s]
+				);
+			}
+			ThreadPool::wait(stageEnds.back());
+			passed &= ordered && stage == c_STRESS_STAGES;
+		}
+
+		return passed;
+	}
+
+	uint64_t hashRange(const uint32_t begin, const uint32_t end) {
+		uint64_t sum{};
+		for (uint32_t i{ begin }; i < end; i++) {
+			uint64_t value{ i };
+			for (uint32_t round{}; round < c_SCALING_ROUNDS; round++) {
+				value = hashBytes(&value, sizeof(value));
+			}
+			sum += value;
+		}
+
+		return sum;
+	}
+
+	uint64_t timeTraceZones(const bool capture) {
+		uint64_t bestNs{ UINT64_MAX };
+		for (uint32_t i{}; i < c_BENCH_ITERATIONS; i++) {
+			if (capture) {
+				Trace::beginCapture();
+			}
+			auto start{ std::chrono::steady_clock::now() };
+			for (uint32_t zone{}; zone < c_TRACE_ZONES; zone++) {
+				Trace::Zone traceZone{ "zone" };
+			}
+			bestNs = std::min(bestNs, getElapsedNs(start));
+		}
+
+		return bestNs;
+	}
+
+	uint64_t getElapsedNs(const std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				   std::chrono::steady_clock::now() - start
+		)
+			.count();
+	}
+}  // namespace
@@ -0,0 +1,57 @@
+# usage: cmake -DSPV_FILES="a.spv|b.spv" -DOUTPUT=EmbeddedShaders.cpp -P EmbedSpirv.cmake
+#
+# writes every spir-v binary as a constexpr uint32_t array plus a name lookup
+# table, so shaders need no file i/o at startup
+
+string(REPLACE "|" ";" SPV_FILES "${SPV_FILES}")
+
+set(ARRAYS "")
+set(TABLE "")
+foreach(SPV_FILE ${SPV_FILES})
+	get_filename_component(SPV_NAME "${SPV_FILE}" NAME)
+	string(MAKE_C_IDENTIFIER "c_${SPV_NAME}" ARRAY_NAME)
+
+	file(READ "${SPV_FILE}" SPV_HEX HEX)
+	# spir-v words are little endian
+	string(REGEX REPLACE
+		"([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])"
+		"0x\\4\\3\\2\\1,"
+		SPV_WORDS
+		"${SPV_HEX}")
+
+	string(APPEND ARRAYS "\tconstexpr uint32_t ${ARRAY_NAME}[]{ ${SPV_WORDS} };\n")
+	string(APPEND TABLE "\t\t{ \"${SPV_NAME}\", ${ARRAY_NAME} },\n")
+endforeach()
+
+set(SOURCE "// generated by scripts/EmbedSpirv.cmake, do not edit
+#include \"EmbeddedShaders.h\"
+
+namespace {
+${ARRAYS}
+	struct EmbeddedShader {
+		std::string_view name;
+		std::span<const uint32_t> code;
+	};
+
+	constexpr EmbeddedShader c_EMBEDDED_SHADERS[]{
+${TABLE}	};
+}  // namespace
+
+std::span<const uint32_t> findEmbeddedShader(const std::string_view name) {
+	for (const auto& shader : c_EMBEDDED_SHADERS) {
+		if (shader.name == name) {
+			return shader.code;
+		}
+	}
+
+	return {};
+}
+")
+
+# only touch the file when it changed so dependents do not rebuild
+if (EXISTS "${OUTPUT}")
+	file(READ "${OUTPUT}" OLD_SOURCE)
+endif()
+if (NOT "${OLD_SOURCE}" STREQUAL "${SOURCE}")
+	file(WRITE "${OUTPUT}" "${SOURCE}")
+endif()